@@ -1,202 +1,76 @@
+#include <algorithm>
+
 #include "buffer/buffer_pool_manager.h"
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
-// #define ENABLE_BPM_DEBUG
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager) {
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
-  for (size_t i = 0; i < pool_size_; i++) {
-    free_list_.emplace_back(i);
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_instances,
+                                     ReplacerType replacer_type)
+    : pool_size_(pool_size), disk_manager_(disk_manager), max_dirty_pages_(pool_size / 2) {
+  ASSERT(num_instances > 0 && num_instances <= pool_size, "Invalid number of buffer pool instances.");
+  // spread the frames as evenly as possible
+  for (size_t i = 0; i < num_instances; i++) {
+    size_t instance_size = pool_size / num_instances + (i < pool_size % num_instances ? 1 : 0);
+    instances_.emplace_back(new BufferPoolManagerInstance(instance_size, disk_manager_, replacer_type));
   }
 }
 
 BufferPoolManager::~BufferPoolManager() {
-  // assert(false);
-  for (auto page : page_table_) {
-    FlushPage(page.first);
+  StopPrefetcher();
+  StopBackgroundWriter();
+  for (auto instance : instances_) {
+    delete instance;
   }
-  delete[] pages_;
-  delete replacer_;
 }
 
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
-  // 1.     Search the page table for the requested page (P).
-  // 1.1    If P exists, pin it and return it immediately.
-  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
-  //        Note that pages are always found from the free list first.
-  // 2.     If R is dirty, write it back to the disk.
-  // 3.     Delete R from the page table and insert P.
-  // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  std::unordered_map<page_id_t, frame_id_t>::iterator it = page_table_.find(page_id);
-  if (it == page_table_.end()) {
-    // the page is not in buffer, need to fetch from disk
-    // first to check if there is free frame
-    frame_id_t victim;
-    if (free_list_.empty()) {
-      // need to replace a page
-
-      if (!replacer_->Victim(&victim)) {
-        assert(false);
-        return nullptr;
-      }
-      if (pages_[victim].IsDirty()) {
-        // dirty page, write back
-        disk_manager_->WritePage(pages_[victim].page_id_, pages_[victim].data_);
-      }
-      // erase from page table
-      page_table_.erase(pages_[victim].page_id_);
-
-    } else {
-      // just use free page()
-      victim = free_list_.back();
-      free_list_.pop_back();
-      // register in map
-      page_table_.insert(std::pair<page_id_t, frame_id_t>(page_id, victim));
-      // insert to replacer
-      if (!replacer_->insert(victim)) {
-        // replacer is full , replace instead
-        frame_id_t local_temp;
-        if(!replacer_->Victim(&local_temp)) return nullptr;
-        // write back if necessary
-        if (pages_[local_temp].IsDirty()) {
-          // dirty page, write back
-          disk_manager_->WritePage(pages_[local_temp].page_id_, pages_[local_temp].data_);
-        }
-        replacer_->insert(victim);
-      }
+  return GetInstance(page_id)->FetchPage(page_id);
+}
+
+Page *BufferPoolManager::FetchPage(page_id_t page_id, BufferRing *ring) {
+  if (ring == nullptr) {
+    return FetchPage(page_id);
+  }
+  bool loaded;
+  Page *page = GetInstance(page_id)->FetchPage(page_id, &loaded);
+  if (page != nullptr && loaded) {
+    page_id_t evict_page_id = ring->Push(page_id);
+    if (evict_page_id != INVALID_PAGE_ID && evict_page_id != page_id) {
+      GetInstance(evict_page_id)->EvictPage(evict_page_id);
     }
-    // reset metadata
-    pages_[victim].is_dirty_ = false;
-    pages_[victim].page_id_ = page_id;
-    pages_[victim].pin_count_ = 1;
-    // read in from disk
-    disk_manager_->ReadPage(page_id, pages_[victim].data_);
-    // register in map
-    page_table_.insert(std::pair<page_id_t, frame_id_t>(page_id, victim));
-    // return
-    replacer_->Pin(victim);
-    // pages_[victim].pin_count_++;
-    return pages_ + victim;
-  } else {
-    replacer_->Pin(it->second);
-    pages_[it->second].pin_count_ = 1;
-    return pages_ + it->second;
   }
+  return page;
 }
 
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {
-  // 0.   Make sure you call AllocatePage!
-  // 1.   If all the pages in the buffer pool are pinned, return nullptr.
-  // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
-  // 3.   Update P's metadata, zero out memory and add P to the page table.
-  // 4.   Set the page ID output parameter. Return a pointer to P.
-#ifdef ENABLE_BPM_DEBUG
-      LOG(WARNING) <<"IN FUNCTION bufferpool.NewPage\n";
-#endif
-#ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) <<"disk allocate page successfully\n";
-#endif
-  frame_id_t victim;
-  if (!free_list_.empty()) {
-#ifdef ENABLE_BPM_DEBUG
-  LOG(INFO)<<"the free list is not empty\n";
-#endif
-    victim = free_list_.front();
-    free_list_.pop_front();
-    //
-  } else {
-
-    if (!replacer_->Victim(&victim)) {
-      return nullptr;
-    }
-    // check if write back
-    if(pages_[victim].IsDirty())
-    {
-      disk_manager_->WritePage(pages_[victim].page_id_,pages_[victim].data_);
-    }
-    // erase 
-    page_table_.erase(pages_[victim].page_id_);
-  }
-#ifdef ENABLE_BPM_DEBUG
-  LOG(INFO)<<"victim: "<<victim<<"\n";
-#endif
-  
-  page_id = disk_manager_->AllocatePage();
-
-  if(page_id==INVALID_PAGE_ID) return nullptr;
-  // replacer_->Unpin(victim);
-  replacer_->Pin(victim);
-  page_table_.insert(std::pair<page_id_t,frame_id_t>(page_id,victim));
-  pages_[victim].ResetMemory();
-  pages_[victim].is_dirty_ = false;
-  pages_[victim].page_id_ = page_id;
-  pages_[victim].pin_count_ = 1;
-  return pages_+victim;
+  // the page id decides which shard holds the page, so allocate it first
+  // and give it back if that shard has no frame left
+  page_id = AllocatePage();
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = GetInstance(page_id)->NewPage(page_id);
+  if (page == nullptr) {
+    DeallocatePage(page_id);
+  }
+  return page;
 }
 
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
-  // 0.   Make sure you call DeallocatePage!
-  // 1.   Search the page table for the requested page (P).
-  // 1.   If P does not exist, return true.
-  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
-  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  // delete page
-  disk_manager_->DeAllocatePage(page_id);
-  // search
-  std::unordered_map<page_id_t,frame_id_t>::iterator it = page_table_.find(page_id);
-  if(it==page_table_.end()) return 1;
-  frame_id_t frame_id = it->second;
-  if(pages_[frame_id].pin_count_) return 0;
-  // remove
-  page_table_.erase(page_id);
-  // reset
-  pages_[frame_id].ResetMemory();
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-  pages_[frame_id].pin_count_ = 0;
-  // add to free list
-  free_list_.push_back(frame_id);
+  // a page still in use keeps its disk page
+  if (!GetInstance(page_id)->DeletePage(page_id)) {
+    return false;
+  }
+  DeallocatePage(page_id);
   return true;
 }
 
-bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) { 
-#ifdef ENABLE_BPM_DEBUG
-      LOG(WARNING) << "IN FUNCTION unpinpage:" << std::endl;
-#endif
-  // is_dirty = true;
-  std::unordered_map<page_id_t,frame_id_t>::iterator it = page_table_.find(page_id);
-  if(it==page_table_.end()) {
-#ifdef ENABLE_BPM_DEBUG
-      LOG(WARNING) << "break function UNPINPAGE: NOT FOUND THIS PAGE IN BUFFER" << std::endl;
-#endif
-    return 0;
-  }
-  pages_[it->second].is_dirty_ = is_dirty;
-  replacer_->Unpin(it->second);
-  pages_[it->second].pin_count_ = 0;
-#ifdef ENABLE_BPM_DEBUG
-      LOG(WARNING) << "break function UNPINPAGE: unpin successfully" << std::endl;
-#endif
-  return 1;
+bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
 }
 
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-#ifdef ENABLE_BPM_DEBUG
-      LOG(WARNING) << "IN FUNCTION BufferPoolManager.FlushPage" << std::endl;
-#endif
-  std::unordered_map<page_id_t,frame_id_t>::iterator it = page_table_.find(page_id);
-  if(it==page_table_.end()) {
-#ifdef ENABLE_BPM_DEBUG
-      LOG(WARNING) << "page not exist , break funtion" << std::endl;
-#endif
-    return 0;
-  }
-  disk_manager_->WritePage(page_id,pages_[it->second].data_);
-#ifdef ENABLE_BPM_DEBUG
-      LOG(WARNING) << "flush successfully , break funtion" << std::endl;
-#endif
-  return 1;
+  return GetInstance(page_id)->FlushPage(page_id);
 }
 
 page_id_t BufferPoolManager::AllocatePage() {
@@ -210,5 +84,188 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) { return disk_manager_->Is
 
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
-  return replacer_->GetPinCount() == 0;
-}
\ No newline at end of file
+  bool res = true;
+  for (auto instance : instances_) {
+    res = instance->CheckAllUnpinned() && res;
+  }
+  return res;
+}
+
+void BufferPoolManager::StartBackgroundWriter(uint32_t interval_ms, size_t pages_per_round) {
+  std::lock_guard<std::mutex> guard(bg_latch_);
+  if (bg_writer_.joinable()) {
+    return;
+  }
+  bg_stop_ = false;
+  bg_interval_ms_ = interval_ms;
+  bg_pages_per_round_ = pages_per_round;
+  bg_writer_ = std::thread([this]() {
+    std::unique_lock<std::mutex> lock(bg_latch_);
+    while (!bg_cv_.wait_for(lock, std::chrono::milliseconds(bg_interval_ms_), [this]() { return bg_stop_; })) {
+      lock.unlock();
+      BackgroundWriterRound();
+      lock.lock();
+    }
+  });
+}
+
+void BufferPoolManager::StopBackgroundWriter() {
+  {
+    std::lock_guard<std::mutex> guard(bg_latch_);
+    if (!bg_writer_.joinable()) {
+      return;
+    }
+    bg_stop_ = true;
+  }
+  bg_cv_.notify_all();
+  bg_writer_.join();
+}
+
+void BufferPoolManager::BackgroundWriterRound() {
+  size_t budget = bg_pages_per_round_;
+  size_t dirty = GetNumDirtyPages();
+  if (dirty > max_dirty_pages_) {
+    budget = std::max(budget, dirty - max_dirty_pages_);
+  }
+  FlushDirtyPages(budget);
+}
+
+size_t BufferPoolManager::FlushDirtyPages(size_t max_pages) {
+  size_t written = 0;
+  // start each round at a different shard so no shard is starved by a small budget
+  size_t start = instances_.size() > 1 ? next_flush_instance_++ % instances_.size() : 0;
+  for (size_t i = 0; i < instances_.size() && written < max_pages; i++) {
+    written += instances_[(start + i) % instances_.size()]->FlushDirtyPages(max_pages - written);
+  }
+  return written;
+}
+
+size_t BufferPoolManager::Checkpoint(size_t max_dirty_pages) {
+  size_t dirty = GetNumDirtyPages();
+  if (dirty <= max_dirty_pages) {
+    return 0;
+  }
+  size_t written = FlushDirtyPages(dirty - max_dirty_pages);
+  disk_manager_->Sync();
+  return written;
+}
+
+size_t BufferPoolManager::GetNumDirtyPages() {
+  size_t dirty = 0;
+  for (auto instance : instances_) {
+    dirty += instance->GetNumDirtyPages();
+  }
+  return dirty;
+}
+
+void BufferPoolManager::Prefetch(page_id_t page_id, NextPageFunc next_page) {
+  if (prefetch_depth_ == 0 || page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(prefetch_latch_);
+    if (prefetch_stop_ || prefetch_queue_.size() >= MAX_PENDING_PREFETCHES) {
+      return;
+    }
+    if (!prefetcher_.joinable()) {
+      prefetcher_ = std::thread(&BufferPoolManager::PrefetchWorker, this);
+    }
+    // a pending request of the same kind of chain is stale once the scan has moved on, replace it
+    for (auto &request : prefetch_queue_) {
+      if (request.second == next_page) {
+        request.first = page_id;
+        return;
+      }
+    }
+    prefetch_queue_.emplace_back(page_id, next_page);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::PrefetchWorker() {
+  std::unique_lock<std::mutex> lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this]() { return prefetch_stop_ || !prefetch_queue_.empty(); });
+    if (prefetch_stop_) {
+      return;
+    }
+    auto request = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    prefetch_busy_ = true;
+    lock.unlock();
+    // the first page is the one the scan is on, the following ones are read ahead
+    page_id_t page_id = request.first;
+    for (size_t i = 0; i <= prefetch_depth_ && page_id != INVALID_PAGE_ID; i++) {
+      if (HasPendingPrefetch(request.second)) {
+        // the scan has already moved on, follow the newer request instead
+        break;
+      }
+      // the next page id is read from a page nobody latched, a torn or stale id must not reach the disk manager
+      if (page_id < 0 || IsPageFree(page_id)) {
+        break;
+      }
+      page_id_t next_page_id;
+      if (!GetInstance(page_id)->PrefetchPage(page_id, request.second, &next_page_id)) {
+        break;
+      }
+      page_id = next_page_id;
+    }
+    lock.lock();
+    prefetch_busy_ = false;
+    if (prefetch_queue_.empty()) {
+      prefetch_idle_cv_.notify_all();
+    }
+  }
+}
+
+void BufferPoolManager::WaitForPrefetches() {
+  std::unique_lock<std::mutex> lock(prefetch_latch_);
+  prefetch_idle_cv_.wait(lock, [this]() { return prefetch_stop_ || (prefetch_queue_.empty() && !prefetch_busy_); });
+}
+
+bool BufferPoolManager::HasPendingPrefetch(NextPageFunc next_page) {
+  std::lock_guard<std::mutex> guard(prefetch_latch_);
+  for (auto &request : prefetch_queue_) {
+    if (request.second == next_page) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void BufferPoolManager::StopPrefetcher() {
+  {
+    std::lock_guard<std::mutex> guard(prefetch_latch_);
+    prefetch_stop_ = true;
+    if (!prefetcher_.joinable()) {
+      return;
+    }
+  }
+  prefetch_cv_.notify_all();
+  prefetch_idle_cv_.notify_all();
+  prefetcher_.join();
+}
+
+size_t BufferPoolManager::GetNumPrefetchedPages() {
+  size_t res = 0;
+  for (auto instance : instances_) {
+    res += instance->GetNumPrefetchedPages();
+  }
+  return res;
+}
+
+size_t BufferPoolManager::GetNumPrefetchHits() {
+  size_t res = 0;
+  for (auto instance : instances_) {
+    res += instance->GetNumPrefetchHits();
+  }
+  return res;
+}
+
+size_t BufferPoolManager::GetNumWastedPrefetches() {
+  size_t res = 0;
+  for (auto instance : instances_) {
+    res += instance->GetNumWastedPrefetches();
+  }
+  return res;
+}
@@ -0,0 +1,324 @@
+#include <algorithm>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "glog/logging.h"
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     ReplacerType replacer_type)
+    : pool_size_(pool_size), disk_manager_(disk_manager), prefetched_(pool_size, false) {
+  pages_ = new Page[pool_size_];
+  switch (replacer_type) {
+    case ReplacerType::kLRUK:
+      replacer_ = new LRUKReplacer(pool_size_);
+      break;
+    case ReplacerType::kClock:
+      replacer_ = new ClockReplacer(pool_size_);
+      break;
+    case ReplacerType::kLRU:
+    default:
+      replacer_ = new LRUReplacer(pool_size_);
+      break;
+  }
+  for (size_t i = 0; i < pool_size_; i++) {
+    free_list_.emplace_back(i);
+  }
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  FlushAllPages();
+  delete[] pages_;
+  delete replacer_;
+}
+
+bool BufferPoolManagerInstance::FindFrame(frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    pages_[*frame_id].WLatch();
+    return true;
+  }
+  if (!replacer_->Victim(frame_id)) {
+    return false;
+  }
+  // nobody holds a pin on the victim, so nobody holds its latch either
+  pages_[*frame_id].WLatch();
+  Page &victim = pages_[*frame_id];
+  if (victim.IsDirty()) {
+    // dirty page, write back
+    WriteBack(victim.page_id_, victim.data_);
+  }
+  ClearPrefetched(*frame_id);
+  // erase from page table
+  page_table_.erase(victim.page_id_);
+  victim.page_id_ = INVALID_PAGE_ID;
+  return true;
+}
+
+Page *BufferPoolManagerInstance::FetchPage(page_id_t page_id, bool *loaded) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = page_table_.find(page_id);
+  if (loaded != nullptr) {
+    *loaded = it == page_table_.end();
+  }
+  if (it != page_table_.end()) {
+    replacer_->Pin(it->second);
+    pages_[it->second].pin_count_++;
+    if (prefetched_[it->second]) {
+      // read-ahead did the I/O for us, the page still counts as loaded by this fetch
+      prefetched_[it->second] = false;
+      num_prefetch_hits_++;
+      if (loaded != nullptr) {
+        *loaded = true;
+      }
+    }
+    return pages_ + it->second;
+  }
+  // the page is not in buffer, need to fetch from disk
+  frame_id_t victim;
+  if (!FindFrame(&victim)) {
+    return nullptr;
+  }
+  // reset metadata
+  pages_[victim].is_dirty_ = false;
+  pages_[victim].page_id_ = page_id;
+  pages_[victim].pin_count_ = 1;
+  // read in from disk
+  disk_manager_->ReadPage(page_id, pages_[victim].data_);
+  pages_[victim].WUnlatch();
+  // register in map
+  page_table_.emplace(page_id, victim);
+  replacer_->Pin(victim);
+  return pages_ + victim;
+}
+
+Page *BufferPoolManagerInstance::NewPage(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  frame_id_t victim;
+  if (!FindFrame(&victim)) {
+    return nullptr;
+  }
+  replacer_->Pin(victim);
+  page_table_.emplace(page_id, victim);
+  pages_[victim].ResetMemory();
+  pages_[victim].is_dirty_ = false;
+  pages_[victim].page_id_ = page_id;
+  pages_[victim].pin_count_ = 1;
+  pages_[victim].WUnlatch();
+  return pages_ + victim;
+}
+
+bool BufferPoolManagerInstance::DeletePage(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return true;
+  }
+  frame_id_t frame_id = it->second;
+  if (pages_[frame_id].pin_count_ > 0) {
+    return false;
+  }
+  pages_[frame_id].WLatch();
+  // remove
+  replacer_->Remove(frame_id);
+  page_table_.erase(it);
+  prefetch_in_flight_.erase(page_id);
+  ClearPrefetched(frame_id);
+  // reset
+  pages_[frame_id].ResetMemory();
+  pages_[frame_id].is_dirty_ = false;
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  pages_[frame_id].pin_count_ = 0;
+  pages_[frame_id].WUnlatch();
+  // add to free list
+  free_list_.push_back(frame_id);
+  return true;
+}
+
+bool BufferPoolManagerInstance::EvictPage(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return false;
+  }
+  frame_id_t frame_id = it->second;
+  Page &page = pages_[frame_id];
+  if (page.pin_count_ > 0) {
+    return false;
+  }
+  page.WLatch();
+  if (page.IsDirty()) {
+    WriteBack(page_id, page.data_);
+  }
+  ClearPrefetched(frame_id);
+  replacer_->Remove(frame_id);
+  page_table_.erase(it);
+  page.is_dirty_ = false;
+  page.page_id_ = INVALID_PAGE_ID;
+  page.WUnlatch();
+  free_list_.push_back(frame_id);
+  return true;
+}
+
+bool BufferPoolManagerInstance::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end() || pages_[it->second].pin_count_ <= 0) {
+    return false;
+  }
+  // a clean unpin must not hide earlier modifications
+  pages_[it->second].is_dirty_ |= is_dirty;
+  if (--pages_[it->second].pin_count_ == 0) {
+    replacer_->Unpin(it->second);
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::FlushPage(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = page_table_.find(page_id);
+  if (it == page_table_.end()) {
+    return false;
+  }
+  WriteBack(page_id, pages_[it->second].data_);
+  return true;
+}
+
+void BufferPoolManagerInstance::FlushAllPages() {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<PageIORequest> requests;
+  requests.reserve(page_table_.size());
+  for (auto &page : page_table_) {
+    requests.push_back({page.first, pages_[page.second].data_, true});
+  }
+  WriteBackBatch(requests);
+}
+
+size_t BufferPoolManagerInstance::FlushDirtyPages(size_t max_pages) {
+  // the pages of a batch stay pinned until it is written, foreground fetches still need frames meanwhile
+  size_t batch_size = std::max<size_t>(1, std::min<size_t>(DEFAULT_IO_QUEUE_DEPTH, pool_size_ / 4));
+  size_t written = 0;
+  while (written < max_pages) {
+    size_t batch = FlushDirtyBatch(std::min(batch_size, max_pages - written));
+    written += batch;
+    if (batch < batch_size) {
+      break;
+    }
+  }
+  return written;
+}
+
+size_t BufferPoolManagerInstance::FlushDirtyBatch(size_t max_pages) {
+  std::vector<PageIORequest> requests;
+  std::vector<frame_id_t> frames;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    for (auto &page : page_table_) {
+      if (requests.size() >= max_pages) {
+        break;
+      }
+      Page &frame = pages_[page.second];
+      if (!frame.is_dirty_ || frame.pin_count_ > 0) {
+        continue;
+      }
+      // somebody may still be writing the page, it is cleaned by a later round
+      if (!frame.TryRLatch()) {
+        continue;
+      }
+      // the pin keeps the frame from being evicted while the shard is unlocked, a modification after the write marks
+      // the page dirty again
+      frame.pin_count_++;
+      replacer_->Pin(page.second);
+      frame.is_dirty_ = false;
+      prefetch_in_flight_.erase(page.first);
+      frames.push_back(page.second);
+      requests.push_back({page.first, frame.data_, true});
+    }
+  }
+  if (requests.empty()) {
+    return 0;
+  }
+  // foreground fetches go on while the pages are written
+  disk_manager_->BatchPageIO(requests);
+  for (auto frame_id : frames) {
+    pages_[frame_id].RUnlatch();
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  for (auto frame_id : frames) {
+    if (--pages_[frame_id].pin_count_ == 0) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+  return requests.size();
+}
+
+size_t BufferPoolManagerInstance::GetNumDirtyPages() {
+  std::lock_guard<std::mutex> guard(latch_);
+  size_t dirty = 0;
+  for (auto &page : page_table_) {
+    dirty += pages_[page.second].is_dirty_ ? 1 : 0;
+  }
+  return dirty;
+}
+
+void BufferPoolManagerInstance::WriteBack(page_id_t page_id, const char *page_data) {
+  // a read-ahead of this page which started before the write would install stale data
+  prefetch_in_flight_.erase(page_id);
+  disk_manager_->WritePage(page_id, page_data);
+}
+
+void BufferPoolManagerInstance::WriteBackBatch(std::vector<PageIORequest> &requests) {
+  if (requests.empty()) {
+    return;
+  }
+  for (auto &request : requests) {
+    prefetch_in_flight_.erase(request.page_id_);
+  }
+  disk_manager_->BatchPageIO(requests);
+}
+
+bool BufferPoolManagerInstance::PrefetchPage(page_id_t page_id, NextPageFunc next_page, page_id_t *next_page_id) {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto it = page_table_.find(page_id);
+    if (it != page_table_.end()) {
+      *next_page_id = next_page(pages_[it->second].data_);
+      return true;
+    }
+    prefetch_in_flight_.insert(page_id);
+  }
+  char data[PAGE_SIZE];
+  // the id of the next page of the chain is only known once this one is read, so there is nothing to batch with
+  disk_manager_->ReadPage(page_id, data);
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = page_table_.find(page_id);
+  if (it != page_table_.end()) {
+    // loaded by a foreground fetch meanwhile
+    prefetch_in_flight_.erase(page_id);
+    *next_page_id = next_page(pages_[it->second].data_);
+    return true;
+  }
+  if (prefetch_in_flight_.erase(page_id) == 0) {
+    // the page was written or deleted meanwhile, what we read may be stale
+    return false;
+  }
+  *next_page_id = next_page(data);
+  frame_id_t frame_id;
+  if (!FindFrame(&frame_id)) {
+    return false;
+  }
+  memcpy(pages_[frame_id].data_, data, PAGE_SIZE);
+  pages_[frame_id].is_dirty_ = false;
+  pages_[frame_id].page_id_ = page_id;
+  pages_[frame_id].pin_count_ = 0;
+  pages_[frame_id].WUnlatch();
+  page_table_.emplace(page_id, frame_id);
+  replacer_->Unpin(frame_id);
+  prefetched_[frame_id] = true;
+  num_prefetched_++;
+  return true;
+}
+
+bool BufferPoolManagerInstance::CheckAllUnpinned() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return replacer_->GetPinCount() == 0;
+}
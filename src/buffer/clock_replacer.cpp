@@ -0,0 +1,78 @@
+#include "buffer/clock_replacer.h"
+
+ClockReplacer::ClockReplacer(size_t num_pages) : capacity_(num_pages), states_(new std::atomic<uint8_t>[num_pages]) {
+  for (size_t i = 0; i < capacity_; i++) {
+    states_[i].store(0);
+  }
+}
+
+bool ClockReplacer::insert(frame_id_t frame_id) {
+  uint8_t old_state = 0;
+  if (!states_[frame_id].compare_exchange_strong(old_state, TRACKED | REFERENCED)) {
+    return false;
+  }
+  size_++;
+  return true;
+}
+
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> guard(hand_latch_);
+  while (size_.load() > 0) {
+    size_t frame = hand_;
+    hand_ = (hand_ + 1) % capacity_;
+    uint8_t state = states_[frame].load();
+    if ((state & TRACKED) == 0 || (state & PINNED) != 0) {
+      continue;
+    }
+    if (state & REFERENCED) {
+      // second chance
+      states_[frame].compare_exchange_strong(state, state & ~REFERENCED);
+      continue;
+    }
+    if (states_[frame].compare_exchange_strong(state, 0)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(frame);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  uint8_t old_state = states_[frame_id].fetch_or(TRACKED | PINNED | REFERENCED);
+  if ((old_state & TRACKED) == 0) {
+    pin_count_++;
+  } else if ((old_state & PINNED) == 0) {
+    size_--;
+    pin_count_++;
+  }
+}
+
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  uint8_t old_state = states_[frame_id].load();
+  while (!states_[frame_id].compare_exchange_weak(old_state,
+                                                 static_cast<uint8_t>((old_state | TRACKED | REFERENCED) & ~PINNED))) {
+  }
+  if ((old_state & TRACKED) == 0) {
+    size_++;
+  } else if (old_state & PINNED) {
+    pin_count_--;
+    size_++;
+  }
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  uint8_t old_state = states_[frame_id].exchange(0);
+  if ((old_state & TRACKED) == 0) {
+    return;
+  }
+  if (old_state & PINNED) {
+    pin_count_--;
+  } else {
+    size_--;
+  }
+}
+
+int ClockReplacer::GetPinCount() { return pin_count_.load(); }
+
+size_t ClockReplacer::Size() { return size_.load(); }
@@ -0,0 +1,83 @@
+#include "buffer/lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_period)
+    : capacity_(num_pages), k_(k), correlated_period_(correlated_period) {}
+
+void LRUKReplacer::RecordAccess(FrameInfo &info) {
+  current_timestamp_++;
+  if (!info.history_.empty() && current_timestamp_ - info.history_.back() <= correlated_period_) {
+    // correlated reference, only extend the last access
+    info.history_.back() = current_timestamp_;
+    return;
+  }
+  info.history_.push_back(current_timestamp_);
+  if (info.history_.size() > k_) {
+    info.history_.pop_front();
+  }
+}
+
+bool LRUKReplacer::insert(frame_id_t frame_id) {
+  if (Size() == capacity_ || frames_.count(frame_id)) return false;
+  FrameInfo &info = frames_[frame_id];
+  RecordAccess(info);
+  info.evictable_ = true;
+  evictable_.emplace(EvictKey(info), frame_id);
+  return true;
+}
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  if (evictable_.empty()) return false;
+  auto it = evictable_.begin();
+  *frame_id = it->second;
+  evictable_.erase(it);
+  frames_.erase(*frame_id);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    RecordAccess(frames_[frame_id]);
+    pin_count_++;
+    return;
+  }
+  FrameInfo &info = it->second;
+  if (info.evictable_) {
+    evictable_.erase({EvictKey(info), frame_id});
+    info.evictable_ = false;
+    pin_count_++;
+  }
+  // every fetch of the page is an access
+  RecordAccess(info);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    FrameInfo &info = frames_[frame_id];
+    RecordAccess(info);
+    info.evictable_ = true;
+    evictable_.emplace(EvictKey(info), frame_id);
+    return;
+  }
+  FrameInfo &info = it->second;
+  if (info.evictable_) return;
+  info.evictable_ = true;
+  pin_count_--;
+  evictable_.emplace(EvictKey(info), frame_id);
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) return;
+  if (it->second.evictable_) {
+    evictable_.erase({EvictKey(it->second), frame_id});
+  } else {
+    pin_count_--;
+  }
+  frames_.erase(it);
+}
+
+int LRUKReplacer::GetPinCount() { return pin_count_; }
+
+size_t LRUKReplacer::Size() { return evictable_.size(); }
@@ -154,6 +154,16 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
 #endif
 }
 
+void LRUReplacer::Remove(frame_id_t frame_id) {
+    std::unordered_map<frame_id_t,list_node<frame_id_t>*>::iterator it = lru_hash.find(frame_id);
+    if(it==lru_hash.end()) return;
+    list_node<frame_id_t>* temptr=it->second;
+    if(temptr->isPined==1) pin_list.dequeue(*temptr);
+    else lru_list.dequeue(*temptr);
+    lru_hash.erase(it);
+    delete temptr;
+}
+
 size_t LRUReplacer::Size() {
 
   return lru_list.getCount();
@@ -97,7 +97,13 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
     if(it.first>=next_table_id_) next_index_id_  = it.first+1;
     table_names_.insert(std::pair<std::string,table_id_t>(table_meta->GetTableName(),it.first));
     TableInfo* table_info = TableInfo::Create(this->heap_);
-    TableHeap* table_heap = TableHeap::Create(this->buffer_pool_manager_,table_meta->GetFirstPageId(),table_meta->GetSchema(),this->log_manager_,this->lock_manager_,this->heap_);
+    TableHeap* table_heap = TableHeap::Create(this->buffer_pool_manager_,table_meta->GetFirstPageId(),table_meta->GetSchema(),this->log_manager_,this->lock_manager_,this->heap_,table_meta->GetFreeSpaceMapPageId());
+    if (table_meta->GetFreeSpaceMapPageId() == INVALID_PAGE_ID) {
+      // metadata written before free space maps existed, keep the map the heap has just built
+      table_meta->SetFreeSpaceMapPageId(table_heap->GetFreeSpaceMapPageId());
+      table_meta->SerializeTo(this->buffer_pool_manager_->FetchPage(it.second)->GetData());
+      this->buffer_pool_manager_->UnpinPage(it.second, true);
+    }
     table_info->Init(table_meta,table_heap);
     this->tables_.insert(std::pair<table_id_t,TableInfo*>(it.first,table_info));
     this->index_names_.insert(std::pair<std::string, std::unordered_map<std::string, index_id_t>>(table_meta->GetTableName(),std::unordered_map<std::string,index_id_t>()));
@@ -141,21 +147,18 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   if(next_index_id_==0) return DB_FAILED;
   auto it = this->table_names_.find(table_name);
   if(it!=this->table_names_.end()) return DB_TABLE_ALREADY_EXIST;
-  page_id_t root_page;
   page_id_t meta_page_id_;
   
-  // allocate page for the table meta page and table first page 
+  // allocate page for the table meta page, the table heap allocates its first page and free space map
   this->buffer_pool_manager_->NewPage(meta_page_id_)->GetData();
   this->buffer_pool_manager_->UnpinPage(meta_page_id_);
-  this->buffer_pool_manager_->NewPage(root_page);
-  this->buffer_pool_manager_->UnpinPage(root_page);
+  TableHeap* table_heap = TableHeap::Create(this->buffer_pool_manager_,schema,txn,this->log_manager_,this->lock_manager_,this->heap_);
   this->table_names_.insert(std::pair<std::string,table_id_t>(table_name,table_id));
-  TableMetadata* table_meta = TableMetadata::Create(table_id,table_name,root_page,schema,this->heap_);
+  TableMetadata* table_meta = TableMetadata::Create(table_id,table_name,table_heap->GetFirstPageId(),table_heap->GetFreeSpaceMapPageId(),schema,this->heap_);
   char* buf = this->buffer_pool_manager_->FetchPage(meta_page_id_)->GetData();
   table_meta->SerializeTo(buf);
   buffer_pool_manager_->UnpinPage(meta_page_id_);
   table_info = TableInfo::Create(this->heap_);
-  TableHeap* table_heap = TableHeap::Create(this->buffer_pool_manager_,table_meta->GetFirstPageId(),table_meta->GetSchema(),this->log_manager_,this->lock_manager_,this->heap_);
   
   table_info->Init(table_meta,table_heap);
   this->index_names_.insert(std::pair<std::string,std::unordered_map<std::string,index_id_t>>(table_name,std::unordered_map<std::string,index_id_t>()));
@@ -182,9 +185,11 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
 
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Transaction *txn,
-                                    IndexInfo *&index_info) {
+                                    IndexInfo *&index_info, IndexType index_type, bool unique) {
   auto it = this->table_names_.find(table_name);
   if(it==this->table_names_.end()) return DB_TABLE_NOT_EXIST;
+  // hash buckets hold unique keys only
+  if(index_type==IndexType::kHash && !unique) return DB_FAILED;
   auto it_index = this->index_names_.find(table_name);
   auto it_index_name_id = it_index->second.find(index_name);
   if(it_index_name_id != it_index->second.end())
@@ -195,7 +200,6 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   index_id_t index_id = next_index_id_++;
   if(next_index_id_==0) return DB_FAILED;
   
-  index_info = IndexInfo::Create(this->heap_);
   // fetch table info
   auto it_table = this->table_names_.find(table_name);
   if(it_table==this->table_names_.end()) return DB_FAILED;
@@ -208,7 +212,7 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
     if(schema->GetColumnIndex(t,key_index)==DB_COLUMN_NAME_NOT_EXIST) return DB_COLUMN_NAME_NOT_EXIST;
     key_map.push_back(key_index);
   }
-  IndexMetadata* index_meta =IndexMetadata::Create(index_id,index_name,table_id,key_map,this->heap_);
+  IndexMetadata* index_meta =IndexMetadata::Create(index_id,index_name,table_id,key_map,this->heap_,index_type,unique);
   
   index_info = IndexInfo::Create(this->heap_);
   index_info->Init(index_meta,table_info,this->buffer_pool_manager_);
@@ -218,8 +222,8 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   page_id_t index_meta_page_id;
   // new page for the meta page and the index root page
   char* buf = this->buffer_pool_manager_->NewPage(index_meta_page_id)->GetData();
-  buffer_pool_manager_->UnpinPage(index_meta_page_id);
   index_meta->SerializeTo(buf);
+  buffer_pool_manager_->UnpinPage(index_meta_page_id, true);
   this->catalog_meta_->index_meta_pages_.insert(std::pair<index_id_t,page_id_t>(index_id,index_meta_page_id));
   return DB_SUCCESS;
 }
@@ -254,22 +258,31 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
     return DB_TABLE_NOT_EXIST;
   }
   table_id_t table_id = it->second;
-  this->table_names_.erase(table_name);
-  this->tables_.erase(table_id);
-  vector<index_id_t> index_id;
-  auto &it_index = this->index_names_.find(table_name)->second;
-  for(auto t:it_index){
-    index_id.push_back(it->second);
+  // the indexes refer to the table, drop them first
+  vector<string> index_names;
+  for(auto &index : this->index_names_.find(table_name)->second){
+    index_names.push_back(index.first);
   }
-  this->index_names_.erase(table_name);
-  for(auto m:index_id){
-    this->indexes_.erase(m);
-    this->catalog_meta_->index_meta_pages_.erase(m);
+  for(auto &index_name : index_names){
+    DropIndex(table_name, index_name);
   }
+  this->index_names_.erase(table_name);
+  this->table_names_.erase(it);
+  TableInfo *table_info = this->tables_.find(table_id)->second;
+  this->tables_.erase(table_id);
   page_id_t meta_page_id_ = this->catalog_meta_->table_meta_pages_.find(table_id)->second;
   buffer_pool_manager_->UnpinPage(meta_page_id_);
   buffer_pool_manager_->DeletePage(meta_page_id_);
   this->catalog_meta_->table_meta_pages_.erase(table_id);
+  // give back what the table took from the catalog heap, the table heap frees its pages
+  TableHeap *table_heap = table_info->table_heap_;
+  TableMetadata *table_meta = table_info->table_meta_;
+  table_info->~TableInfo();
+  heap_->Free(table_info);
+  table_heap->~TableHeap();
+  heap_->Free(table_heap);
+  table_meta->~TableMetadata();
+  heap_->Free(table_meta);
   return DB_SUCCESS;
 }
 
@@ -284,11 +297,18 @@ dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_
   }
   index_id_t index_id = it_index->second;
   it->second.erase(index_name);
+  IndexInfo *index_info = this->indexes_.find(index_id)->second;
   this->indexes_.erase(index_id);
   page_id_t meta_page_id_ = this->catalog_meta_->index_meta_pages_.find(index_id)->second;
   buffer_pool_manager_->UnpinPage(meta_page_id_);
   buffer_pool_manager_->DeletePage(meta_page_id_);
   this->catalog_meta_->index_meta_pages_.erase(index_id);
+  // give back what the index took from the catalog heap, the index info destroys the index and frees its own heap
+  IndexMetadata *index_meta = index_info->meta_data_;
+  index_info->~IndexInfo();
+  heap_->Free(index_info);
+  index_meta->~IndexMetadata();
+  heap_->Free(index_meta);
   return DB_SUCCESS;
 }
 
@@ -1,10 +1,24 @@
+#include <strings.h>
+
 #include "catalog/indexes.h"
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name,
                                      const table_id_t table_id, const vector<uint32_t> &key_map,
-                                     MemHeap *heap) {
+                                     MemHeap *heap, IndexType index_type, bool unique) {
   void *buf = heap->Allocate(sizeof(IndexMetadata));
-  return new(buf)IndexMetadata(index_id, index_name, table_id, key_map);
+  return new(buf)IndexMetadata(index_id, index_name, table_id, key_map, index_type, unique);
+}
+
+bool IndexMetadata::ParseIndexType(const std::string &name, IndexType &index_type) {
+  if (strcasecmp(name.c_str(), "bptree") == 0 || strcasecmp(name.c_str(), "btree") == 0) {
+    index_type = IndexType::kBPlusTree;
+    return true;
+  }
+  if (strcasecmp(name.c_str(), "hash") == 0) {
+    index_type = IndexType::kHash;
+    return true;
+  }
+  return false;
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
@@ -27,11 +41,16 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
     MACH_WRITE_TO(uint32_t,buf+offset,it);
     offset += sizeof(uint32_t);
   }
+  MACH_WRITE_TO(uint32_t,buf+offset,static_cast<uint32_t>(index_type_));
+  offset += sizeof(uint32_t);
+  // stored as "allows duplicates", so that the zeros after older metadata read back as unique
+  MACH_WRITE_TO(uint32_t,buf+offset,static_cast<uint32_t>(!unique_));
+  offset += sizeof(uint32_t);
   return offset;
 }
 
 uint32_t IndexMetadata::GetSerializedSize() const {
-  return sizeof(uint32_t)*(6+key_map_.size()+index_name_.length());
+  return sizeof(uint32_t)*(8+key_map_.size()+index_name_.length());
 }
 
 uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta, MemHeap *heap) {
@@ -53,5 +72,10 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta, M
     index_meta->key_map_.push_back(MACH_READ_UINT32(buf+offset));
     offset += sizeof(uint32_t);
   }
+  // metadata written before index types existed is followed by the zeroed rest of its page, i.e. a B+ tree
+  index_meta->index_type_ = static_cast<IndexType>(MACH_READ_UINT32(buf+offset));
+  offset += sizeof(uint32_t);
+  index_meta->unique_ = MACH_READ_UINT32(buf+offset) == 0;
+  offset += sizeof(uint32_t);
   return offset;
 }
\ No newline at end of file
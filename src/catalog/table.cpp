@@ -15,11 +15,14 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
   MACH_WRITE_TO(uint32_t,buf+offset,root_page_id_);
   offset += sizeof(uint32_t);
   offset+=schema_->SerializeTo(buf+offset);
+  // stored plus one, so that the zeros after older metadata read back as INVALID_PAGE_ID, a heap without a map
+  MACH_WRITE_TO(uint32_t,buf+offset,static_cast<uint32_t>(fsm_page_id_ + 1));
+  offset += sizeof(uint32_t);
   return offset;
 }
 
 uint32_t TableMetadata::GetSerializedSize() const {
-  return sizeof(uint32_t)*(5+table_name_.length())+schema_->GetSerializedSize();
+  return sizeof(uint32_t)*(6+table_name_.length())+schema_->GetSerializedSize();
 }
 
 /**
@@ -43,6 +46,8 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
   table_meta -> root_page_id_ = MACH_READ_UINT32(buf+offset);
   offset += sizeof(uint32_t);
   offset += Schema::DeserializeFrom(buf+offset,table_meta->schema_,heap);
+  table_meta -> fsm_page_id_ = static_cast<page_id_t>(MACH_READ_UINT32(buf+offset)) - 1;
+  offset += sizeof(uint32_t);
   return offset;
 }
 
@@ -52,11 +57,14 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
  * @param heap Memory heap passed by TableInfo
  */
 TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name,
-                                     page_id_t root_page_id, TableSchema *schema, MemHeap *heap) {
+                                     page_id_t root_page_id, page_id_t fsm_page_id, TableSchema *schema,
+                                     MemHeap *heap) {
   // allocate space for table metadata
   void *buf = heap->Allocate(sizeof(TableMetadata));
-  return new(buf)TableMetadata(table_id, table_name, root_page_id, schema);
+  return new(buf)TableMetadata(table_id, table_name, root_page_id, fsm_page_id, schema);
 }
 
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
-        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema) {}
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id,
+                             page_id_t fsm_page_id, TableSchema *schema)
+        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), fsm_page_id_(fsm_page_id),
+          schema_(schema) {}
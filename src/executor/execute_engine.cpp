@@ -1,6 +1,10 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <cstdio>
 #include <chrono>
 #include <fstream>
+#include <thread>
 #include "executor/execute_engine.h"
 #include "glog/logging.h"
 
@@ -184,6 +188,13 @@ dberr_t ExecuteEngine::ExecuteSaveDatabase(ExecuteContext *context) {
 }
 
 dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
+  dberr_t result = ExecuteStatement(ast, context);
+  // everything the statement allocated goes at once
+  query_heap_.Reset();
+  return result;
+}
+
+dberr_t ExecuteEngine::ExecuteStatement(pSyntaxNode ast, ExecuteContext *context) {
   if (ast == nullptr) {
     return DB_FAILED;
   }
@@ -629,49 +640,92 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
   }
 
   // Para 4: Index type (optional)
-  //astIden = ast->next_;
-  //if (astIden) Change index type;
-  
+  IndexType NewIndexType = IndexType::kBPlusTree;
+  astIden = astIden->next_;
+  if (astIden && astIden->type_ == kNodeIndexType && astIden->child_) {
+    if (!IndexMetadata::ParseIndexType(std::string(astIden->child_->val_), NewIndexType)) {
+      printf("Unknown index type %s, expected bptree or hash.\n", astIden->child_->val_);
+      return DB_FAILED;
+    }
+  }
+
   IndexInfo *NewIndexInfo;
   if (dbs_[current_db_]->catalog_mgr_->GetIndex(TableName, NewIndexName, NewIndexInfo) == DB_SUCCESS) {
     printf("There is already an index which named %s on table %s!\n", NewIndexName.c_str(), TableName.c_str());
     return DB_FAILED;
   }
+
+  // The key is unique if it covers the primary key or a unique column, whose unique indexes are made with the table
+  bool NewIndexUnique = false;
+  std::vector<IndexInfo *> TableIndexes;
+  dbs_[current_db_]->catalog_mgr_->GetTableIndexes(TableName, TableIndexes);
+  for (auto __Index : TableIndexes) {
+    if (!__Index->IsUnique()) continue;
+    bool Covered = true;
+    for (auto __Col : __Index->GetIndexKeySchema()->GetColumns()) {
+      if (std::find(KeyMap.begin(), KeyMap.end(), __Col->GetTableInd()) == KeyMap.end()) {
+        Covered = false;
+        break;
+      }
+    }
+    if (Covered) {
+      NewIndexUnique = true;
+      break;
+    }
+  }
+  if (NewIndexType == IndexType::kHash && !NewIndexUnique) {
+    printf("A hash index holds unique keys only, but the column(s) of %s are not a primary or unique key.\n",
+           NewIndexName.c_str());
+    return DB_FAILED;
+  }
+
   NewIndexInfo = nullptr;
   dberr_t CreateReturn = 
     dbs_[current_db_]->catalog_mgr_->
-      CreateIndex(TableName, NewIndexName, NewIndexColumns, nullptr, NewIndexInfo);
+      CreateIndex(TableName, NewIndexName, NewIndexColumns, nullptr, NewIndexInfo, NewIndexType, NewIndexUnique);
   if (CreateReturn != DB_SUCCESS || NewIndexInfo == nullptr) {
     printf("Failed to create index on table %s.\n", TableName.c_str());
     return DB_FAILED;
   }
 
-  // Full table insert!
-  dberr_t InsertEntryReturn;
-  std::vector<Field> IndexFields;
-  auto CurrentIterator = __Ti->GetTableHeap()->Begin(nullptr);
-  auto TableEnd = __Ti->GetTableHeap()->End();
-
-  uint32_t SelectedRow = 0;
-  for (; CurrentIterator != TableEnd; ++CurrentIterator) {
-
-    // Select this row:
-    IndexFields.clear();
-    for (auto i : KeyMap)
-      IndexFields.push_back(Field(*(CurrentIterator->GetField(i))));
-    InsertEntryReturn = NewIndexInfo->GetIndex()->InsertEntry(Row(IndexFields), CurrentIterator->GetRowId(), nullptr);
-
-    if (InsertEntryReturn != DB_SUCCESS) {
-      printf("Construct index error. There may be duplicate value in index column(s).\n");
-      dberr_t DropReturn = dbs_[current_db_]->catalog_mgr_->DropIndex(TableName, NewIndexName);
-      if (DropReturn != DB_SUCCESS) {
-        printf("Failed to rollback creation of index %s.\n", NewIndexName.c_str());
-      }
-      return DB_FAILED;
+  // Full table load: the heap pages are split among threads which extract and sort the keys of their part, the
+  // index merges them and builds itself bottom-up
+  auto BuildStart = std::chrono::steady_clock::now();
+  TableHeap *Heap = __Ti->GetTableHeap();
+  std::vector<page_id_t> PageIds = Heap->GetPageIds();
+  size_t NumThreads = std::max<size_t>(1, std::min<size_t>({std::thread::hardware_concurrency(),
+                                                            MAX_INDEX_BUILD_THREADS, PageIds.size()}));
+  std::atomic<uint32_t> SelectedRow{0};
+  std::vector<Index::EntrySource> Sources;
+  for (size_t t = 0; t < NumThreads; t++) {
+    Sources.push_back([&, t](const Index::EntrySink &Sink) {
+      std::vector<Field> IndexFields;
+      uint32_t Rows = 0;
+      Heap->ScanPages(PageIds, PageIds.size() * t / NumThreads, PageIds.size() * (t + 1) / NumThreads,
+                      [&](const RowView &CurrentRow) {
+        // Select this row:
+        IndexFields.clear();
+        for (auto i : KeyMap)
+          IndexFields.push_back(CurrentRow.GetField(i));
+        Sink(IndexFields, CurrentRow.GetRowId());
+        ++Rows;
+      });
+      SelectedRow += Rows;
+    });
+  }
+  dberr_t LoadReturn = NewIndexInfo->GetIndex()->BulkLoad(Sources, nullptr);
+  std::chrono::duration<double> BuildTime = std::chrono::steady_clock::now() - BuildStart;
+
+  if (LoadReturn != DB_SUCCESS) {
+    printf("Construct index error. There may be duplicate value in index column(s).\n");
+    dberr_t DropReturn = dbs_[current_db_]->catalog_mgr_->DropIndex(TableName, NewIndexName);
+    if (DropReturn != DB_SUCCESS) {
+      printf("Failed to rollback creation of index %s.\n", NewIndexName.c_str());
     }
-    ++SelectedRow;
+    return DB_FAILED;
   }
-  printf("Successfully create %s with %u row(s).\n", NewIndexName.c_str(), SelectedRow);
+  printf("Successfully create %s with %u row(s).\n", NewIndexName.c_str(), SelectedRow.load());
+  printf("Time cost: %.2f ms, %zu thread(s).\n", BuildTime.count() * 1000, NumThreads);
 
   return DB_SUCCESS;
 }
@@ -727,6 +781,18 @@ dberr_t ExecuteEngine::ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context
   return DB_SUCCESS;
 }
 
+// Check that every column a condition reads is in the schema
+static bool ConditionColumnsIn(pSyntaxNode condition, Schema *schema) {
+  uint32_t Idx;
+  if (condition->type_ == kNodeIdentifier && schema->GetColumnIndex(condition->val_, Idx) != DB_SUCCESS) {
+    return false;
+  }
+  for (auto Child = condition->child_; Child; Child = Child->next_) {
+    if (!ConditionColumnsIn(Child, schema)) return false;
+  }
+  return true;
+}
+
 dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "[ExecuteSelect]" << std::endl;
@@ -757,7 +823,7 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
     printf("Table %s not found!\n", ast->child_->next_->val_);
     return DB_FAILED;
   }
-  auto CurrentIterator = __Ti->GetTableHeap()->Begin(nullptr);
+  auto CurrentIterator = __Ti->GetTableHeap()->Begin(nullptr, true);
 
   // Generate index array
   dberr_t FindColumnReturn;
@@ -789,13 +855,10 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
   // ================ < SELECT > ================
   uint32_t SelectedRow = 0;
   dberr_t LogicReturn;
-  ExecuteContext IteratorContext;
 
   IndexInfo *__IndexInfo = nullptr;
-  RowId BeginID, EndID;
-  bool BoundaryCovered;
-  dberr_t IteratorReturn =
-      SelectIterator(ConditionRoot, &IteratorContext, __Ti, __IndexInfo, BeginID, EndID, BoundaryCovered);
+  IndexRange Range;
+  dberr_t IteratorReturn = SelectIterator(ConditionRoot, __Ti, __IndexInfo, Range);
   if (IteratorReturn != DB_SUCCESS) {
     printf("Index loading error!\n");
     return DB_FAILED;
@@ -829,569 +892,118 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
   // ============= < SELECT BEGIN > =============
   auto SelectBegin = std::chrono::steady_clock::now();
 
-  if (IteratorContext.index_ind >= 0) {
-
-    // Process boundary
-    // Table Row => Fields (of Index Schema) => Index Row => Iterator
-
-    if (!__IndexInfo) {
-      printf("Iterator selector chooses a null index pointer!\n");
-      return DB_FAILED;
-    }
-
-    bool ID2RowReturn;
-    Row BeginRow = Row(BeginID), EndRow = Row(EndID);
-    std::vector<uint32_t> KeyMap;
-    std::vector<Field> BeginFields, EndFields;
-    for (auto __Col : __IndexInfo->GetIndexKeySchema()->GetColumns()) {
-      FindColumnReturn = __Ti->GetSchema()->GetColumnIndex(__Col->GetName(), __Idx);
-      if (FindColumnReturn != DB_SUCCESS) {
-        printf("Column %s in index %s not found!\n", __Col->GetName().c_str(), __IndexInfo->GetIndexName().c_str());
-        return DB_FAILED;
+  // Index-only scan: if the key of a B+ tree index holds every column the select reads, the rows are decoded from
+  // the keys in the leaves and the table is not read
+  bool IndexOnly = __IndexInfo && __IndexInfo->IsBTreeIndex();
+  std::vector<uint32_t> KeyIndexes;   // Positions of the selected columns in the key
+  if (IndexOnly) {
+    IndexSchema *KeySchema = __IndexInfo->GetIndexKeySchema();
+    for (auto &ColumnStr : SelectColumnNames) {
+      if (KeySchema->GetColumnIndex(ColumnStr, __Idx) != DB_SUCCESS) {
+        IndexOnly = false;
+        break;
       }
-      KeyMap.push_back(__Idx);
+      KeyIndexes.push_back(__Idx);
     }
+    IndexOnly = IndexOnly && (ConditionRoot == nullptr || ConditionColumnsIn(ConditionRoot, KeySchema));
+  }
 
-    if (!(BeginID == INVALID_ROWID)) {  // What? RowId does not have operator!= ?!
-      ID2RowReturn = __Ti->GetTableHeap()->GetTuple(&BeginRow, nullptr);
-      if (!ID2RowReturn) {
-        printf("Index %s provides wrong RowID when determining search range begining.\n", __IndexInfo->GetIndexName().c_str());
-        return DB_FAILED;
-      }
-      for (auto __Key : KeyMap) BeginFields.push_back(Field(*(BeginRow.GetField(__Key))));
-    }
-    if (!(EndID == INVALID_ROWID)) {
-      ID2RowReturn = __Ti->GetTableHeap()->GetTuple(&EndRow, nullptr);
-      if (!ID2RowReturn) {
-        printf("Index %s provides wrong RowID when determining search range end.\n", __IndexInfo->GetIndexName().c_str());
-        return DB_FAILED;
-      }
-      for (auto __Key : KeyMap) EndFields.push_back(Field(*(EndRow.GetField(__Key))));
+  // Check the conditions on a row an index returns and print it if it is selected
+  auto SelectIndexedRow = [&](const Row &thisRow, Schema *RowSchema, const std::vector<uint32_t> &Columns) -> dberr_t {
+    ExecuteContext SelectContext;
+    LogicReturn = LogicConditions(ConditionRoot, &SelectContext, thisRow, RowSchema);
+    if (LogicReturn != DB_SUCCESS) {
+      printf("Failed to analyze logic conditions.\n");
+      return DB_FAILED;
     }
-    
-    // Iterate by Index
 
-    uint32_t KeySize = (4U << __IndexInfo->BpTreeType());
-    switch (KeySize) {
-      // PROCESS OF INDEX INTERATE:
-      //  1. Get Iterator
-      //  2. For each loop:
-      //       Condition judge
-      //       Display this row
-      case 4: {
-
-        IndexInfo::INDEX_KEY_TYPE4 BeginIndexKey, EndIndexKey;
-        if (!(BeginID == INVALID_ROWID)) {
-          Row BeginIndexRow = Row(BeginFields);
-          BeginIndexKey.SerializeFromKey(BeginIndexRow, __IndexInfo->GetIndexKeySchema());
+    if (SelectContext.condition_) {
+      // Select this row:
+      ++SelectedRow;
+      if (SelectedRow <= MAX_DISPLAY_ROW) {
+        // Print columns
+        printf("|");
+        for (auto i : Columns) {
+          printf(" %s |",
+                 CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
+                                   DISPLAY_COLUMN_WIDTH));
         }
-        if (!(EndID == INVALID_ROWID)) {
-          Row EndIndexRow = Row(EndFields);
-          EndIndexKey.SerializeFromKey(EndIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        auto CurrentIndexIterator = (BeginID == INVALID_ROWID)
-                                        ? __IndexInfo->GetBTreeIndex4()->GetBeginIterator()
-                                        : __IndexInfo->GetBTreeIndex4()->GetBeginIterator(BeginIndexKey);
-        if (!BoundaryCovered && !(BeginID == INVALID_ROWID)) CurrentIndexIterator++;
-        auto IndexEnd = (EndID == INVALID_ROWID) ? __IndexInfo->GetBTreeIndex4()->GetEndIterator()
-                                                 : __IndexInfo->GetBTreeIndex4()->GetBeginIterator(EndIndexKey);
-        if (BoundaryCovered && !(EndID == INVALID_ROWID)) IndexEnd++;
-
-        // Main Loop
-        bool GetReturn;
-        for (; CurrentIndexIterator != IndexEnd; ++CurrentIndexIterator) {
-          ExecuteContext SelectContext;
-          Row thisRow = Row((*CurrentIndexIterator).second);
-          GetReturn =  __Ti->GetTableHeap()->GetTuple(&thisRow, nullptr);
-          if (!GetReturn) {
-            printf("Index %s provides wrong RowID when fetching data.\n", __IndexInfo->GetIndexName().c_str());
-            return DB_FAILED;
-          }
-          LogicReturn = LogicConditions(ConditionRoot, &SelectContext, thisRow, __Ti->GetSchema());
-          if (LogicReturn != DB_SUCCESS) {
-            printf("Failed to analyze logic conditions.\n");
-            return DB_FAILED;
-          }
-
-          if (SelectContext.condition_) {
-            // Select this row:
-            ++SelectedRow;
-            if (SelectedRow <= MAX_DISPLAY_ROW) {
-              // Print columns
-              printf("|");
-              for (auto i : SelectIndexes) {
-                printf(" %s |",
-                       CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                         DISPLAY_COLUMN_WIDTH));
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                       CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                         DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else if (SelectedRow == MAX_DISPLAY_ROW + 1) {
-              printf("|");
-              for (uint32_t i = 0; i < SelectColumnNames.size(); ++i) {
-                printf(" ");
-                for (uint32_t j = 0; j < DISPLAY_COLUMN_WIDTH; ++j) printf(j % 4 == 3 ? " " : ".");
-                printf(" |");
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else {
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            }
-          }
+        printf("\n");
+      } else if (SelectedRow == MAX_DISPLAY_ROW + 1) {
+        printf("|");
+        for (uint32_t i = 0; i < SelectColumnNames.size(); ++i) {
+          printf(" ");
+          for (uint32_t j = 0; j < DISPLAY_COLUMN_WIDTH; ++j) printf(j % 4 == 3 ? " " : ".");
+          printf(" |");
         }
+        printf("\n");
       }
-        break;
-      case 8: {
-
-        IndexInfo::INDEX_KEY_TYPE8 BeginIndexKey, EndIndexKey;
-        if (!(BeginID == INVALID_ROWID)) {
-          Row BeginIndexRow = Row(BeginFields);
-          BeginIndexKey.SerializeFromKey(BeginIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        if (!(EndID == INVALID_ROWID)) {
-          Row EndIndexRow = Row(EndFields);
-          EndIndexKey.SerializeFromKey(EndIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        auto CurrentIndexIterator = (BeginID == INVALID_ROWID)
-                                        ? __IndexInfo->GetBTreeIndex8()->GetBeginIterator()
-                                        : __IndexInfo->GetBTreeIndex8()->GetBeginIterator(BeginIndexKey);
-        if (!BoundaryCovered && !(BeginID == INVALID_ROWID)) CurrentIndexIterator++;
-        auto IndexEnd = (EndID == INVALID_ROWID) ? __IndexInfo->GetBTreeIndex8()->GetEndIterator()
-                                                 : __IndexInfo->GetBTreeIndex8()->GetBeginIterator(EndIndexKey);
-        if (BoundaryCovered && !(EndID == INVALID_ROWID)) IndexEnd++;
-
-        // Main Loop
-        bool GetReturn;
-        for (; CurrentIndexIterator != IndexEnd; ++CurrentIndexIterator) {
-          ExecuteContext SelectContext;
-          Row thisRow = Row((*CurrentIndexIterator).second);
-          GetReturn = __Ti->GetTableHeap()->GetTuple(&thisRow, nullptr);
-          if (!GetReturn) {
-            printf("Index %s provides wrong RowID when fetching data.\n", __IndexInfo->GetIndexName().c_str());
-            return DB_FAILED;
-          }
-          LogicReturn = LogicConditions(ConditionRoot, &SelectContext, thisRow, __Ti->GetSchema());
-          if (LogicReturn != DB_SUCCESS) {
-            printf("Failed to analyze logic conditions.\n");
-            return DB_FAILED;
-          }
-
-          if (SelectContext.condition_) {
-            // Select this row:
-            ++SelectedRow;
-            if (SelectedRow <= MAX_DISPLAY_ROW) {
-              // Print columns
-              printf("|");
-              for (auto i : SelectIndexes) {
-                printf(" %s |",
-                       CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                         DISPLAY_COLUMN_WIDTH));
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else if (SelectedRow == MAX_DISPLAY_ROW + 1) {
-              printf("|");
-              for (uint32_t i = 0; i < SelectColumnNames.size(); ++i) {
-                printf(" ");
-                for (uint32_t j = 0; j < DISPLAY_COLUMN_WIDTH; ++j) printf(j % 4 == 3 ? " " : ".");
-                printf(" |");
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else {
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            }
-          }
-        }
+      // Print columns to file
+      fprintf(ResultFile, "|");
+      for (auto i : Columns) {
+        fprintf(ResultFile, " %s |",
+                CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
+                                  DISPLAY_COLUMN_WIDTH));
       }
-        break;
-      case 16: {
-
-        IndexInfo::INDEX_KEY_TYPE16 BeginIndexKey, EndIndexKey;
-        if (!(BeginID == INVALID_ROWID)) {
-          Row BeginIndexRow = Row(BeginFields);
-          BeginIndexKey.SerializeFromKey(BeginIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        if (!(EndID == INVALID_ROWID)) {
-          Row EndIndexRow = Row(EndFields);
-          EndIndexKey.SerializeFromKey(EndIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        auto CurrentIndexIterator = (BeginID == INVALID_ROWID)
-                                        ? __IndexInfo->GetBTreeIndex16()->GetBeginIterator()
-                                        : __IndexInfo->GetBTreeIndex16()->GetBeginIterator(BeginIndexKey);
-        if (!BoundaryCovered && !(BeginID == INVALID_ROWID)) CurrentIndexIterator++;
-        auto IndexEnd = (EndID == INVALID_ROWID) ? __IndexInfo->GetBTreeIndex16()->GetEndIterator()
-                                                 : __IndexInfo->GetBTreeIndex16()->GetBeginIterator(EndIndexKey);
-        if (BoundaryCovered && !(EndID == INVALID_ROWID)) IndexEnd++;
-
-        // Main Loop
-        bool GetReturn;
-        for (; CurrentIndexIterator != IndexEnd; ++CurrentIndexIterator) {
-          ExecuteContext SelectContext;
-          Row thisRow = Row((*CurrentIndexIterator).second);
-          GetReturn = __Ti->GetTableHeap()->GetTuple(&thisRow, nullptr);
-          if (!GetReturn) {
-            printf("Index %s provides wrong RowID when fetching data.\n", __IndexInfo->GetIndexName().c_str());
-            return DB_FAILED;
-          }
-          LogicReturn = LogicConditions(ConditionRoot, &SelectContext, thisRow, __Ti->GetSchema());
-          if (LogicReturn != DB_SUCCESS) {
-            printf("Failed to analyze logic conditions.\n");
-            return DB_FAILED;
-          }
+      fprintf(ResultFile, "\n");
+    }
+    return DB_SUCCESS;
+  };
 
-          if (SelectContext.condition_) {
-            // Select this row:
-            ++SelectedRow;
-            if (SelectedRow <= MAX_DISPLAY_ROW) {
-              // Print columns
-              printf("|");
-              for (auto i : SelectIndexes) {
-                printf(" %s |",
-                       CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                         DISPLAY_COLUMN_WIDTH));
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else if (SelectedRow == MAX_DISPLAY_ROW + 1) {
-              printf("|");
-              for (uint32_t i = 0; i < SelectColumnNames.size(); ++i) {
-                printf(" ");
-                for (uint32_t j = 0; j < DISPLAY_COLUMN_WIDTH; ++j) printf(j % 4 == 3 ? " " : ".");
-                printf(" |");
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else {
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            }
-          }
+  // Fetch the row of an index entry, or decode it from the key for an index-only scan
+  auto VisitIndexEntry = [&](const RowId &__Rid, const char *__Key) -> dberr_t {
+    if (IndexOnly) {
+      IndexSchema *KeySchema = __IndexInfo->GetIndexKeySchema();
+      Row KeyRow(__Rid, &query_heap_);
+      KeyEncoding::Decode(__Key, KeySchema, KeyRow);
+      // Decoded chars are not zero terminated
+      std::vector<Field> KeyFields;
+      for (auto *__F : KeyRow.GetFields()) {
+        if (__F->GetTypeId() == kTypeChar && !__F->IsNull()) {
+          std::string __Str(__F->GetData(), __F->GetLength());
+          KeyFields.emplace_back(kTypeChar, const_cast<char *>(__Str.c_str()), __Str.size() + 1, true);
+        } else {
+          KeyFields.emplace_back(*__F);
         }
       }
-        break;
-      case 32: {
+      return SelectIndexedRow(Row(KeyFields, &query_heap_), KeySchema, KeyIndexes);
+    }
+    Row thisRow(__Rid, &query_heap_);
+    if (!__Ti->GetTableHeap()->GetTuple(&thisRow, nullptr)) {
+      printf("Index %s provides wrong RowID when fetching data.\n", __IndexInfo->GetIndexName().c_str());
+      return DB_FAILED;
+    }
+    return SelectIndexedRow(thisRow, __Ti->GetSchema(), SelectIndexes);
+  };
 
-        IndexInfo::INDEX_KEY_TYPE32 BeginIndexKey, EndIndexKey;
-        if (!(BeginID == INVALID_ROWID)) {
-          Row BeginIndexRow = Row(BeginFields);
-          BeginIndexKey.SerializeFromKey(BeginIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        if (!(EndID == INVALID_ROWID)) {
-          Row EndIndexRow = Row(EndFields);
-          EndIndexKey.SerializeFromKey(EndIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        auto CurrentIndexIterator = (BeginID == INVALID_ROWID)
-                                        ? __IndexInfo->GetBTreeIndex32()->GetBeginIterator()
-                                        : __IndexInfo->GetBTreeIndex32()->GetBeginIterator(BeginIndexKey);
-        if (!BoundaryCovered && !(BeginID == INVALID_ROWID)) CurrentIndexIterator++;
-        auto IndexEnd = (EndID == INVALID_ROWID) ? __IndexInfo->GetBTreeIndex32()->GetEndIterator()
-                                                 : __IndexInfo->GetBTreeIndex32()->GetBeginIterator(EndIndexKey);
-        if (BoundaryCovered && !(EndID == INVALID_ROWID)) IndexEnd++;
-
-        // Main Loop
-        bool GetReturn;
-        for (; CurrentIndexIterator != IndexEnd; ++CurrentIndexIterator) {
-          ExecuteContext SelectContext;
-          Row thisRow = Row((*CurrentIndexIterator).second);
-          GetReturn = __Ti->GetTableHeap()->GetTuple(&thisRow, nullptr);
-          if (!GetReturn) {
-            printf("Index %s provides wrong RowID when fetching data.\n", __IndexInfo->GetIndexName().c_str());
-            return DB_FAILED;
-          }
-          LogicReturn = LogicConditions(ConditionRoot, &SelectContext, thisRow, __Ti->GetSchema());
-          if (LogicReturn != DB_SUCCESS) {
-            printf("Failed to analyze logic conditions.\n");
-            return DB_FAILED;
-          }
+  if (__IndexInfo && !__IndexInfo->IsBTreeIndex()) {
 
-          if (SelectContext.condition_) {
-            // Select this row:
-            ++SelectedRow;
-            if (SelectedRow <= MAX_DISPLAY_ROW) {
-              // Print columns
-              printf("|");
-              for (auto i : SelectIndexes) {
-                printf(" %s |",
-                       CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                         DISPLAY_COLUMN_WIDTH));
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else if (SelectedRow == MAX_DISPLAY_ROW + 1) {
-              printf("|");
-              for (uint32_t i = 0; i < SelectColumnNames.size(); ++i) {
-                printf(" ");
-                for (uint32_t j = 0; j < DISPLAY_COLUMN_WIDTH; ++j) printf(j % 4 == 3 ? " " : ".");
-                printf(" |");
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else {
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            }
-          }
-        }
-      }
-        break;
-      case 64: {
+    // A hash index finds the rows of the equality on its key
 
-        IndexInfo::INDEX_KEY_TYPE64 BeginIndexKey, EndIndexKey;
-        if (!(BeginID == INVALID_ROWID)) {
-          Row BeginIndexRow = Row(BeginFields);
-          BeginIndexKey.SerializeFromKey(BeginIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        if (!(EndID == INVALID_ROWID)) {
-          Row EndIndexRow = Row(EndFields);
-          EndIndexKey.SerializeFromKey(EndIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        auto CurrentIndexIterator = (BeginID == INVALID_ROWID)
-                                        ? __IndexInfo->GetBTreeIndex64()->GetBeginIterator()
-                                        : __IndexInfo->GetBTreeIndex64()->GetBeginIterator(BeginIndexKey);
-        if (!BoundaryCovered && !(BeginID == INVALID_ROWID)) CurrentIndexIterator++;
-        auto IndexEnd = (EndID == INVALID_ROWID) ? __IndexInfo->GetBTreeIndex64()->GetEndIterator()
-                                                 : __IndexInfo->GetBTreeIndex64()->GetBeginIterator(EndIndexKey);
-        if (BoundaryCovered && !(EndID == INVALID_ROWID)) IndexEnd++;
-
-        // Main Loop
-        bool GetReturn;
-        for (; CurrentIndexIterator != IndexEnd; ++CurrentIndexIterator) {
-          ExecuteContext SelectContext;
-          Row thisRow = Row((*CurrentIndexIterator).second);
-          GetReturn = __Ti->GetTableHeap()->GetTuple(&thisRow, nullptr);
-          if (!GetReturn) {
-            printf("Index %s provides wrong RowID when fetching data.\n", __IndexInfo->GetIndexName().c_str());
-            return DB_FAILED;
-          }
-          LogicReturn = LogicConditions(ConditionRoot, &SelectContext, thisRow, __Ti->GetSchema());
-          if (LogicReturn != DB_SUCCESS) {
-            printf("Failed to analyze logic conditions.\n");
-            return DB_FAILED;
-          }
+    std::vector<RowId> ScanKeyResult;
+    __IndexInfo->GetIndex()->ScanKey(Row(Range.lower_, &query_heap_), ScanKeyResult, nullptr);
+    for (auto &__Rid : ScanKeyResult) {
+      if (VisitIndexEntry(__Rid, nullptr) != DB_SUCCESS) return DB_FAILED;
+    }
 
-          if (SelectContext.condition_) {
-            // Select this row:
-            ++SelectedRow;
-            if (SelectedRow <= MAX_DISPLAY_ROW) {
-              // Print columns
-              printf("|");
-              for (auto i : SelectIndexes) {
-                printf(" %s |",
-                       CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                         DISPLAY_COLUMN_WIDTH));
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else if (SelectedRow == MAX_DISPLAY_ROW + 1) {
-              printf("|");
-              for (uint32_t i = 0; i < SelectColumnNames.size(); ++i) {
-                printf(" ");
-                for (uint32_t j = 0; j < DISPLAY_COLUMN_WIDTH; ++j) printf(j % 4 == 3 ? " " : ".");
-                printf(" |");
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else {
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            }
-          }
-        }
-      }
-        break;
-      case 128: {
+  } else if (__IndexInfo) {
 
-        IndexInfo::INDEX_KEY_TYPE128 BeginIndexKey, EndIndexKey;
-        if (!(BeginID == INVALID_ROWID)) {
-          Row BeginIndexRow = Row(BeginFields);
-          BeginIndexKey.SerializeFromKey(BeginIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        if (!(EndID == INVALID_ROWID)) {
-          Row EndIndexRow = Row(EndFields);
-          EndIndexKey.SerializeFromKey(EndIndexRow, __IndexInfo->GetIndexKeySchema());
-        }
-        auto CurrentIndexIterator = (BeginID == INVALID_ROWID)
-                                        ? __IndexInfo->GetBTreeIndex128()->GetBeginIterator()
-                                        : __IndexInfo->GetBTreeIndex128()->GetBeginIterator(BeginIndexKey);
-        if (!BoundaryCovered && !(BeginID == INVALID_ROWID)) CurrentIndexIterator++;
-        auto IndexEnd = (EndID == INVALID_ROWID) ? __IndexInfo->GetBTreeIndex128()->GetEndIterator()
-                                                 : __IndexInfo->GetBTreeIndex128()->GetBeginIterator(EndIndexKey);
-        if (BoundaryCovered && !(EndID == INVALID_ROWID)) IndexEnd++;
-
-        // Main Loop
-        bool GetReturn;
-        for (; CurrentIndexIterator != IndexEnd; ++CurrentIndexIterator) {
-          ExecuteContext SelectContext;
-          Row thisRow = Row((*CurrentIndexIterator).second);
-          GetReturn = __Ti->GetTableHeap()->GetTuple(&thisRow, nullptr);
-          if (!GetReturn) {
-            printf("Index %s provides wrong RowID when fetching data.\n", __IndexInfo->GetIndexName().c_str());
-            return DB_FAILED;
-          }
-          LogicReturn = LogicConditions(ConditionRoot, &SelectContext, thisRow, __Ti->GetSchema());
-          if (LogicReturn != DB_SUCCESS) {
-            printf("Failed to analyze logic conditions.\n");
-            return DB_FAILED;
-          }
+    // Iterate by Index over the key range of the conditions
 
-          if (SelectContext.condition_) {
-            // Select this row:
-            ++SelectedRow;
-            if (SelectedRow <= MAX_DISPLAY_ROW) {
-              // Print columns
-              printf("|");
-              for (auto i : SelectIndexes) {
-                printf(" %s |",
-                       CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                         DISPLAY_COLUMN_WIDTH));
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else if (SelectedRow == MAX_DISPLAY_ROW + 1) {
-              printf("|");
-              for (uint32_t i = 0; i < SelectColumnNames.size(); ++i) {
-                printf(" ");
-                for (uint32_t j = 0; j < DISPLAY_COLUMN_WIDTH; ++j) printf(j % 4 == 3 ? " " : ".");
-                printf(" |");
-              }
-              printf("\n");
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            } else {
-              // Print columns to file
-              fprintf(ResultFile, "|");
-              for (auto i : SelectIndexes) {
-                fprintf(ResultFile, " %s |",
-                        CStringComplement((thisRow.GetField(i)->IsNull()) ? "(null)" : thisRow.GetField(i)->GetData(),
-                                          DISPLAY_COLUMN_WIDTH));
-              }
-              fprintf(ResultFile, "\n");
-            }
-          }
-        }
-      }
-        break;
+    dberr_t ScanReturn;
+    uint32_t KeySize = (4U << __IndexInfo->BpTreeType());
+    switch (KeySize) {
+      case 4: ScanReturn = ScanIndexRange<4>(__IndexInfo, Range, VisitIndexEntry); break;
+      case 8: ScanReturn = ScanIndexRange<8>(__IndexInfo, Range, VisitIndexEntry); break;
+      case 16: ScanReturn = ScanIndexRange<16>(__IndexInfo, Range, VisitIndexEntry); break;
+      case 32: ScanReturn = ScanIndexRange<32>(__IndexInfo, Range, VisitIndexEntry); break;
+      case 64: ScanReturn = ScanIndexRange<64>(__IndexInfo, Range, VisitIndexEntry); break;
+      case 128: ScanReturn = ScanIndexRange<128>(__IndexInfo, Range, VisitIndexEntry); break;
       default:
         printf("Unexpected index key size (%u).\n", KeySize);
         return DB_FAILED;
     }
+    if (ScanReturn != DB_SUCCESS) return DB_FAILED;
 
   } else {
 
@@ -1400,7 +1012,11 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
     auto TableEnd = __Ti->GetTableHeap()->End();
     for (; CurrentIterator != TableEnd; ++CurrentIterator) {
       ExecuteContext SelectContext;
-      LogicReturn = LogicConditions(ConditionRoot, &SelectContext, *CurrentIterator, __Ti->GetSchema());
+      const RowView &CurrentRow = CurrentIterator.View();
+      // the tuple was deleted since the iterator reached it
+      if (!CurrentRow.IsValid()) continue;
+      // only rows which are selected are deserialized
+      LogicReturn = LogicConditions(ConditionRoot, &SelectContext, CurrentRow, __Ti->GetSchema());
       if (LogicReturn != DB_SUCCESS) {
         printf("Failed to analyze logic conditions.\n");
         return DB_FAILED;
@@ -1581,7 +1197,7 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
     return DB_FAILED;
   }
   
-  Row row = Row(__Fields);
+  Row row(__Fields, &query_heap_);
   bool InsertReturn = __Ti->GetTableHeap()->InsertTuple(row, nullptr);
   if (!InsertReturn) {
     printf("Insert error.\n");
@@ -1598,21 +1214,29 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
   // For a moment I flash a thought of checking the return of GetTableIndexes
   // But recently I realize ... the only thing you can give ... is DB_SUCCESS ...
 
-  for (auto __Idx : TableIndexes) {
-
+  auto GetIndexFields = [&](IndexInfo *__Idx) {
     // Get index columns and iterate
     IndexColumns = __Idx->GetIndexKeySchema()->GetColumns();
     IndexFields.clear();
     for (auto __Col : IndexColumns) {
       IndexFields.push_back(__Fields[__Col->GetTableInd()]);
     }
+  };
+
+  for (size_t i = 0; i < TableIndexes.size(); ++i) {
+    GetIndexFields(TableIndexes[i]);
 
     // Insert into index
-    Row NewIndexRow = Row(IndexFields);
+    Row NewIndexRow(IndexFields, &query_heap_);
     InsertEntryReturn = 
-      __Idx->GetIndex()->InsertEntry(NewIndexRow, row_id, nullptr);
+      TableIndexes[i]->GetIndex()->InsertEntry(NewIndexRow, row_id, nullptr);
     if (InsertEntryReturn != DB_SUCCESS) {
       printf("Index insert error. You may insert duplicate value into a unique column.\n");
+      // The indexes before this one have taken the row already, a non-unique one whatever its key is
+      for (size_t j = 0; j < i; ++j) {
+        GetIndexFields(TableIndexes[j]);
+        TableIndexes[j]->GetIndex()->RemoveEntry(Row(IndexFields, &query_heap_), row_id, nullptr);
+      }
       __Ti->GetTableHeap()->ApplyDelete(row_id, nullptr);
       return DB_FAILED;
     }
@@ -1644,7 +1268,7 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
     printf("Table %s not found!\n", TableName.c_str());
     return DB_FAILED;
   }
-  auto CurrentIterator = __Ti->GetTableHeap()->Begin(nullptr);
+  auto CurrentIterator = __Ti->GetTableHeap()->Begin(nullptr, true);
 
   bool DelectReturn;
   auto ConditionRoot = ast->child_->next_;
@@ -1660,28 +1284,30 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
 
   for (; CurrentIterator != TableEnd; ++CurrentIterator) {
     ExecuteContext SelectContext;
-    LogicReturn = LogicConditions(ConditionRoot, &SelectContext, *CurrentIterator, __Ti->GetSchema());
+    const RowView &__DeletedRow = CurrentIterator.View();
+    // the tuple was deleted since the iterator reached it
+    if (!__DeletedRow.IsValid()) continue;
+    LogicReturn = LogicConditions(ConditionRoot, &SelectContext, __DeletedRow, __Ti->GetSchema());
     if (LogicReturn != DB_SUCCESS) {
       printf("Failed to analyze logic conditions.\n");
       return DB_FAILED;
     }
     if (SelectContext.condition_) {
       // Select this row:
-      auto __DeletedRow = *CurrentIterator;
-      // Delete in indexes
+      // Delete in indexes, the keys refer to the tuple in its page
       for (auto __Idx : TableIndexes) {
         IndexColumns.clear();
         __FieldsToDelete.clear();
         IndexColumns = __Idx->GetIndexKeySchema()->GetColumns();
         for (auto __Col : IndexColumns) 
-          __FieldsToDelete.push_back(Field(*(__DeletedRow.GetField(__Col->GetTableInd()))));
-        Row RowToDelete = Row(__FieldsToDelete);
-        __Idx->GetIndex()->RemoveEntry(RowToDelete, __DeletedRow.GetRowId(), nullptr);      // You! You can only return SUCCESS too!
+          __FieldsToDelete.push_back(__DeletedRow.GetField(__Col->GetTableInd()));
+        Row RowToDelete(__FieldsToDelete, &query_heap_);
+        __Idx->GetIndex()->RemoveEntry(RowToDelete, CurrentIterator.GetRowId(), nullptr);      // You! You can only return SUCCESS too!
       }
       // Delete in Table Heap
-      DelectReturn = __Ti->GetTableHeap()->MarkDelete(CurrentIterator->GetRowId(), nullptr);
+      DelectReturn = __Ti->GetTableHeap()->MarkDelete(CurrentIterator.GetRowId(), nullptr);
       if (!DelectReturn) {
-        printf("Failed to delete tuple. (RowId = %ld)\n", CurrentIterator->GetRowId().Get());
+        printf("Failed to delete tuple. (RowId = %ld)\n", CurrentIterator.GetRowId().Get());
         continue;
       }
     }
@@ -1709,7 +1335,7 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext *context) {
   }
 
   auto UpdateTableName = std::string(ast->child_->val_);
-  auto CurrentIterator = __Ti->GetTableHeap()->Begin(nullptr);
+  auto CurrentIterator = __Ti->GetTableHeap()->Begin(nullptr, true);
 
   std::vector<std::string> UpdateColumnNames;
   std::vector<Field> UpdateFieldList;
@@ -1774,7 +1400,11 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext *context) {
   std::vector<Field *> OldFields;
   for (; CurrentIterator != TableEnd; ++CurrentIterator) {
     ExecuteContext SelectContext;
-    LogicReturn = LogicConditions(ConditionRoot, &SelectContext, *CurrentIterator, __Ti->GetSchema());
+    const RowView &CurrentRow = CurrentIterator.View();
+    // the tuple was deleted since the iterator reached it
+    if (!CurrentRow.IsValid()) continue;
+    // only rows which are updated are deserialized
+    LogicReturn = LogicConditions(ConditionRoot, &SelectContext, CurrentRow, __Ti->GetSchema());
     if (LogicReturn != DB_SUCCESS) {
       printf("Failed to analyze logic conditions.\n");
       return DB_FAILED;
@@ -1788,9 +1418,10 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext *context) {
       for (auto f : OldFields) UpdateFields.push_back(Field(*f));
       // Update New row
       for (long unsigned int i = 0; i < UpdateIndexes.size(); ++i) {
-        UpdateFields[UpdateIndexes[i]] = *(new Field(UpdateFieldList[i]));
+        Field NewField(UpdateFieldList[i]);
+        UpdateFields[UpdateIndexes[i]] = NewField;
       }
-      Row __newrow = Row(UpdateFields);
+      Row __newrow(UpdateFields, &query_heap_);
       // Update
       RowId __rowid = CurrentIterator->GetRowId();
       UpdateReturn = __Ti->GetTableHeap()->UpdateTuple(__newrow, __rowid, nullptr);
@@ -1918,7 +1549,17 @@ dberr_t ExecuteEngine::ExecuteQuit(pSyntaxNode ast, ExecuteContext *context) {
 *  from table interface.
 */
 
-dberr_t ExecuteEngine::LogicConditions(pSyntaxNode ast, ExecuteContext *context, const Row &row, Schema *schema) {
+// Field access shared by LogicConditions over rows and row views
+static bool FieldIsNull(const Row &row, uint32_t idx) { return row.GetField(idx)->IsNull(); }
+
+static bool FieldIsNull(const RowView &row, uint32_t idx) { return row.IsNull(idx); }
+
+static std::string FieldString(const Row &row, uint32_t idx) { return row.GetField(idx)->GetData(); }
+
+static std::string FieldString(const RowView &row, uint32_t idx) { return row.GetFieldString(idx); }
+
+template<typename RowType>
+dberr_t ExecuteEngine::LogicConditions(pSyntaxNode ast, ExecuteContext *context, const RowType &row, Schema *schema) {
   
   if (context->flag_quit_) return DB_SUCCESS;
   if (ast == nullptr) {
@@ -1985,10 +1626,10 @@ dberr_t ExecuteEngine::LogicConditions(pSyntaxNode ast, ExecuteContext *context,
           printf("Column \"%s\" does not exist!\n", ast->child_->val_);
           return DB_FAILED;
         }
-        if (row.GetField(IdentifierIndex)->IsNull())
+        if (FieldIsNull(row, IdentifierIndex))
           LeftNull = true;
         else
-          LeftValueStr = row.GetField(IdentifierIndex)->GetData(),
+          LeftValueStr = FieldString(row, IdentifierIndex),
           LeftType = schema->GetColumn(IdentifierIndex)->GetType();
       } break;
       case kNodeNumber:
@@ -2015,10 +1656,10 @@ dberr_t ExecuteEngine::LogicConditions(pSyntaxNode ast, ExecuteContext *context,
           printf("Column \"%s\" does not exist!\n", ast->child_->val_);
           return DB_FAILED;
         }
-        if (row.GetField(IdentifierIndex)->IsNull())
+        if (FieldIsNull(row, IdentifierIndex))
           RightNull = true;
         else
-          RightValueStr = row.GetField(IdentifierIndex)->GetData(),
+          RightValueStr = FieldString(row, IdentifierIndex),
           RightType = schema->GetColumn(IdentifierIndex)->GetType();
         
       } break;
@@ -2080,122 +1721,165 @@ dberr_t ExecuteEngine::LogicConditions(pSyntaxNode ast, ExecuteContext *context,
   return DB_SUCCESS;
 }
 
-dberr_t ExecuteEngine::SelectIterator(pSyntaxNode condition, ExecuteContext *context, const TableInfo *table,
-                                      IndexInfo *&index, RowId &begin_id, RowId &end_id, bool &covered) {
-  if (condition == nullptr) {
-    return DB_SUCCESS;
+// Collect the comparisons which all selected rows satisfy, i.e. those not below an "or"
+static void CollectConjuncts(pSyntaxNode condition, std::vector<pSyntaxNode> &comparisons) {
+  if (condition == nullptr) return;
+  if (condition->type_ == kNodeConditions) {
+    CollectConjuncts(condition->child_, comparisons);
+  } else if (condition->type_ == kNodeConnector && strcmp(condition->val_, "and") == 0) {
+    CollectConjuncts(condition->child_, comparisons);
+    CollectConjuncts(condition->child_->next_, comparisons);
+  } else if (condition->type_ == kNodeCompareOperator) {
+    comparisons.push_back(condition);
   }
+}
 
-  if (context->index_ind >= 0) {
-    // Have found a index
-    return DB_SUCCESS;
+// Make a key field of the column from a literal of a comparison
+// Returns false if the literal cannot be compared in the key order of the column, or set exact to false if the
+// field is rounded and a bound made of it has to be inclusive
+static bool LiteralToField(pSyntaxNode literal, const Column *column, std::vector<Field> &fields, bool &exact) {
+  exact = true;
+  switch (column->GetType()) {
+    case kTypeInt: {
+      if (literal->type_ != kNodeNumber) return false;
+      char *End;
+      errno = 0;
+      long Value = strtol(literal->val_, &End, 10);
+      if (*End != '\0' || errno != 0 || Value < INT32_MIN || Value > INT32_MAX) return false;
+      fields.emplace_back(kTypeInt, static_cast<int32_t>(Value));
+      return true;
+    }
+    case kTypeFloat:
+      if (literal->type_ != kNodeNumber) return false;
+      // conditions compare the value in double precision
+      fields.emplace_back(kTypeFloat, static_cast<float>(atof(literal->val_)));
+      exact = false;
+      return true;
+    case kTypeChar: {
+      if (literal->type_ != kNodeString) return false;
+      uint32_t Length = strlen(literal->val_);
+      // a literal longer than the column is cut in the key
+      exact = Length <= column->GetLength();
+      fields.emplace_back(kTypeChar, literal->val_, Length + 1, true);
+      return true;
+    }
+    default:
+      return false;
   }
+}
 
-  if (condition->type_ == kNodeConditions) {
-
-    SelectIterator(condition->child_, context, table, index, begin_id, end_id, covered);
-
-  } else if (condition->type_ == kNodeConnector) {
-
-    if (strcmp(condition->val_, "and") == 0) {
-      SelectIterator(condition->child_, context, table, index, begin_id, end_id, covered);
-      SelectIterator(condition->child_->next_, context, table, index, begin_id, end_id, covered);
+dberr_t ExecuteEngine::SelectIterator(pSyntaxNode condition, const TableInfo *table, IndexInfo *&index,
+                                      IndexRange &range) {
+  index = nullptr;
+  std::vector<pSyntaxNode> Comparisons;
+  CollectConjuncts(condition, Comparisons);
+
+  // Bounds of every column, from the first comparison of each kind. The conditions are still evaluated on every row
+  // the index returns, any of them narrows the scan as well.
+  struct ColumnBound {
+    pSyntaxNode eq_{nullptr};
+    pSyntaxNode lower_{nullptr};
+    pSyntaxNode upper_{nullptr};
+    bool lower_inclusive_{true};
+    bool upper_inclusive_{true};
+  };
+  std::vector<ColumnBound> Bounds(table->GetSchema()->GetColumnCount());
+  for (auto __Cmp : Comparisons) {
+    pSyntaxNode Left = __Cmp->child_, Right = Left->next_;
+    uint32_t ColumnIndex;
+    bool Flipped;
+    if (Left->type_ == kNodeIdentifier && (Right->type_ == kNodeNumber || Right->type_ == kNodeString)) {
+      Flipped = false;
+    } else if (Right->type_ == kNodeIdentifier && (Left->type_ == kNodeNumber || Left->type_ == kNodeString)) {
+      std::swap(Left, Right);
+      Flipped = true;   // 1 < a is a > 1
+    } else {
+      continue;
     }
-
-  } else if (condition->type_ == kNodeCompareOperator) {
-
-    const uint32_t NO_IDENTIFIER = 23333333;  // It is not an identifier
-    uint32_t LeftIndex = NO_IDENTIFIER, RightIndex = NO_IDENTIFIER;
-
-    if (strcmp(condition->val_, "<>") != 0 && strcmp(condition->val_, "!=") != 0) {
-      // Choose this identifier
-      if (condition->child_->next_->type_ == kNodeIdentifier)
-        table->GetSchema()->GetColumnIndex(std::string(condition->child_->next_->val_), RightIndex);
-      if (condition->child_->type_ == kNodeIdentifier)
-        table->GetSchema()->GetColumnIndex(std::string(condition->child_->val_), LeftIndex);
-      if (LeftIndex == NO_IDENTIFIER && RightIndex != NO_IDENTIFIER) context->index_ind = RightIndex;
-      if (LeftIndex != NO_IDENTIFIER && RightIndex == NO_IDENTIFIER) context->index_ind = LeftIndex;
+    if (table->GetSchema()->GetColumnIndex(std::string(Left->val_), ColumnIndex) != DB_SUCCESS) continue;
+    auto &Bound = Bounds[ColumnIndex];
+    std::string Op = __Cmp->val_;
+    if (Flipped && Op[0] == '<') Op[0] = '>';
+    else if (Flipped && Op[0] == '>') Op[0] = '<';
+    if (Op == "=") {
+      if (!Bound.eq_) Bound.eq_ = Right;
+    } else if (Op == ">" || Op == ">=") {
+      if (!Bound.lower_) Bound.lower_ = Right, Bound.lower_inclusive_ = (Op == ">=");
+    } else if (Op == "<" || Op == "<=") {
+      if (!Bound.upper_) Bound.upper_ = Right, Bound.upper_inclusive_ = (Op == "<=");
     }
+  }
 
-    if (context->index_ind >= 0) {
-      // Get IndexInfo
-      bool founded = false;
-      uint32_t IndexKeyIndex;
-      std::vector<IndexInfo *> TableIndexes;
-      dbs_[current_db_]->catalog_mgr_->GetTableIndexes(table->GetTableName(), TableIndexes);
-      for (auto __Idx : TableIndexes) {
-        table->GetSchema()->GetColumnIndex(__Idx->GetIndexKeySchema()->GetColumns()[0]->GetName(), IndexKeyIndex);
-        if (static_cast<int>(__Idx->GetIndexKeySchema()->GetColumns().size()) == 1 &&
-            static_cast<int>(IndexKeyIndex) == context->index_ind) {
-          // Choose this index!
-          index = __Idx;
-          founded = true;
-          break;
-        }
-      }
-      if (!founded) {
-        context->index_ind = -1;
-        return DB_SUCCESS;
-      }
-
-      // Find RowId of boundary condition value
-      auto BoundaryValue = (context->index_ind == static_cast<int>(LeftIndex)) ? condition->child_->next_->val_
-                                                                               : condition->child_->val_;
-      std::vector<Field> BoundaryField;
-      switch (index->GetIndexKeySchema()->GetColumns()[0]->GetType()) {
-        case kTypeInt:
-          BoundaryField.push_back(Field(kTypeInt, atoi(BoundaryValue)));
-          break;
-        case kTypeFloat:
-          BoundaryField.push_back(Field(kTypeFloat, static_cast<float>(atof(BoundaryValue))));
-          break;
-        case kTypeChar:
-          BoundaryField.push_back(
-              Field(kTypeChar, BoundaryValue, table->GetSchema()->GetColumns()[context->index_ind]->GetLength(), true));
-          break;
-        default:
-          printf("Comparation \"%s %s %s\" cannot match the schema of index %s.\n", condition->child_->val_,
-                 condition->val_, condition->child_->next_->val_, index->GetIndexName().c_str());
-          context->index_ind = -1;
-          return DB_FAILED;
+  // Score an index by the columns it narrows: two for an equality, one for the range after them. A hash index which
+  // finds the rows of its equalities without descending a tree wins over a B+ tree index with the same equalities.
+  std::vector<IndexInfo *> TableIndexes;
+  dbs_[current_db_]->catalog_mgr_->GetTableIndexes(table->GetTableName(), TableIndexes);
+  int BestScore = 0;
+  for (auto __Idx : TableIndexes) {
+    auto &KeyColumns = __Idx->GetIndexKeySchema()->GetColumns();
+    uint32_t EqCount = 0;
+    std::vector<Field> EqFields;
+    bool Usable = true;
+    for (auto __Col : KeyColumns) {
+      auto &Bound = Bounds[__Col->GetTableInd()];
+      bool Exact;
+      if (!Bound.eq_ || !LiteralToField(Bound.eq_, __Col, EqFields, Exact) || !Exact) break;
+      ++EqCount;
+    }
+    int Score = 2 * EqCount;
+    std::vector<Field> Lower(EqFields), Upper(EqFields);
+    bool LowerInclusive = true, UpperInclusive = true;
+    if (!__Idx->IsBTreeIndex()) {
+      Usable = EqCount == KeyColumns.size();
+      ++Score;
+    } else if (EqCount < KeyColumns.size()) {
+      auto *RangeColumn = KeyColumns[EqCount];
+      auto &Bound = Bounds[RangeColumn->GetTableInd()];
+      bool Exact;
+      if (Bound.lower_ && LiteralToField(Bound.lower_, RangeColumn, Lower, Exact)) {
+        LowerInclusive = Bound.lower_inclusive_ || !Exact;
+        Score |= 1;
       }
-      std::vector<RowId> ScanKeyResult;
-      dberr_t ScanReturn = index->GetIndex()->ScanKey(Row(BoundaryField), ScanKeyResult, nullptr);
-      if (ScanReturn != DB_SUCCESS) {
-        printf("Value %s does not exist in index %s.\n", BoundaryValue, index->GetIndexName().c_str());
-        context->index_ind = -1;
-        return DB_FAILED;
+      if (Bound.upper_ && LiteralToField(Bound.upper_, RangeColumn, Upper, Exact)) {
+        UpperInclusive = Bound.upper_inclusive_ || !Exact;
+        Score |= 1;
       }
+    }
+    if (Usable && Score > BestScore) {
+      BestScore = Score;
+      index = __Idx;
+      range.lower_.clear();
+      range.upper_.clear();
+      for (auto &__F : Lower) range.lower_.emplace_back(__F);
+      for (auto &__F : Upper) range.upper_.emplace_back(__F);
+      range.lower_inclusive_ = LowerInclusive;
+      range.upper_inclusive_ = UpperInclusive;
+    }
+  }
 
-      // Set index search range
-      if (strcmp(condition->val_, "=") == 0) {
-        begin_id = end_id = ScanKeyResult[0];
-        covered = true;
-      } else if (strcmp(condition->val_, "<=") == 0) {
-        begin_id = INVALID_ROWID, end_id = ScanKeyResult[0];
-        covered = true;
-      } else if (strcmp(condition->val_, ">=") == 0) {
-        begin_id = ScanKeyResult[0], end_id = INVALID_ROWID;
-        covered = true;
-      } else if (strcmp(condition->val_, "<") == 0) {
-        begin_id = INVALID_ROWID, end_id = ScanKeyResult[0];
-        covered = false;
-      } else if (strcmp(condition->val_, ">") == 0) {
-        begin_id = ScanKeyResult[0], end_id = INVALID_ROWID;
-        covered = false;
-      } else {
-        printf("Unexpected comparison operator.\n");
-        context->index_ind = -1;
-        return DB_FAILED;
-      }
+  return DB_SUCCESS;
+}
 
-      // Set condition to always true
-      strcpy(condition->val_, "TRUE");
+template<size_t KeySize>
+dberr_t ExecuteEngine::ScanIndexRange(IndexInfo *index, IndexRange &range,
+                                      const std::function<dberr_t(const RowId &, const char *)> &visit) {
+  using BP_TREE_INDEX = BPlusTreeIndex<GenericKey<KeySize>, RowId, GenericComparator<KeySize>>;
+  auto *Tree = reinterpret_cast<BP_TREE_INDEX *>(index->GetIndex());
+  GenericKey<KeySize> BeginIndexKey, EndIndexKey;
+  BeginIndexKey.SerializeFromKeyPrefix(Row(range.lower_, &query_heap_), index->GetIndexKeySchema(),
+                                       !range.lower_inclusive_);
+  EndIndexKey.SerializeFromKeyPrefix(Row(range.upper_, &query_heap_), index->GetIndexKeySchema(),
+                                     range.upper_inclusive_);
+  // The padding places the bounds before or after the keys equal to the range values. A key which fills the whole
+  // GenericKey leaves no room for it and equals its bound, so the bounds keep the inclusive flags of the range
+  auto CurrentIndexIterator = Tree->GetRangeIterator(BeginIndexKey, range.lower_inclusive_, EndIndexKey,
+                                                     range.upper_inclusive_);
+  auto IndexEnd = Tree->GetEndIterator();
+  for (; CurrentIndexIterator != IndexEnd; ++CurrentIndexIterator) {
+    auto &Entry = *CurrentIndexIterator;
+    if (visit(Entry.second, Entry.first.data) != DB_SUCCESS) {
+      return DB_FAILED;
     }
-
-  } else {
-    return DB_FAILED;
   }
-
   return DB_SUCCESS;
-}
\ No newline at end of file
+}
@@ -1,37 +1,125 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
-#include <list>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
-#include <unordered_map>
+#include <thread>
+#include <vector>
 
-#include "buffer/lru_replacer.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/buffer_ring.h"
 #include "page/page.h"
 #include "page/disk_file_meta_page.h"
 #include "storage/disk_manager.h"
 
 using namespace std;
 
+/**
+ * BufferPoolManager partitions the buffer pool into several BufferPoolManagerInstance shards. A page always lives
+ * in the shard selected by its page id, and each shard has its own latch, so threads touching different pages
+ * rarely contend with each other.
+ */
 class BufferPoolManager {
 public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_instances = 1,
+                             ReplacerType replacer_type = ReplacerType::kLRU);
 
   ~BufferPoolManager();
 
   Page *FetchPage(page_id_t page_id);
 
+  /**
+   * Fetch a page on behalf of a sequential scan, pages loaded from disk recycle the frames of the scan's ring
+   */
+  Page *FetchPage(page_id_t page_id, BufferRing *ring);
+
   bool UnpinPage(page_id_t page_id, bool is_dirty = true);
 
   bool FlushPage(page_id_t page_id);
 
   Page *NewPage(page_id_t &page_id);
 
+  /**
+   * Drop the page from the buffer pool and deallocate it on disk
+   * @return false if the page is still pinned, it is left allocated then
+   */
   bool DeletePage(page_id_t page_id);
 
   bool IsPageFree(page_id_t page_id);
 
   bool CheckAllUnpinned();
 
+  /**
+   * Start a background thread which trickles dirty unpinned pages to disk, so that victims picked by
+   * FetchPage/NewPage are usually clean and shutdown has little left to flush.
+   * @param interval_ms time between two writer rounds
+   * @param pages_per_round maximum number of pages written per round, unless the dirty page limit is exceeded
+   */
+  void StartBackgroundWriter(uint32_t interval_ms = DEFAULT_BG_WRITER_INTERVAL_MS,
+                             size_t pages_per_round = DEFAULT_BG_WRITER_PAGES_PER_ROUND);
+
+  /**
+   * Stop the background writer thread, does nothing if it is not running
+   */
+  void StopBackgroundWriter();
+
+  /**
+   * Upper bound of dirty pages the background writer keeps the pool at, it writes as many pages as needed
+   * in a round to get below it
+   */
+  void SetMaxDirtyPages(size_t max_dirty_pages) { max_dirty_pages_ = max_dirty_pages; }
+
+  /**
+   * Incremental checkpoint: write back unpinned dirty pages until at most max_dirty_pages are left dirty, and sync
+   * the db file.
+   * Must be called between statements, when no page is in use by the calling session.
+   * @return number of pages written
+   */
+  size_t Checkpoint(size_t max_dirty_pages = 0);
+
+  size_t GetNumDirtyPages();
+
+  /**
+   * Asynchronous read-ahead: a helper thread follows the page chain starting at page_id and brings the next
+   * prefetch depth pages into the buffer pool. Called by scans once they detect sequential access.
+   * @param next_page extracts the next page id of the chain from a page
+   */
+  void Prefetch(page_id_t page_id, NextPageFunc next_page);
+
+  /**
+   * Wait until the read-ahead thread has served every request made so far
+   * Note: Used for tests, which must not depend on when the thread gets to run
+   */
+  void WaitForPrefetches();
+
+  /**
+   * Number of pages read ahead of a scan, 0 disables read-ahead
+   */
+  void SetPrefetchDepth(size_t depth) { prefetch_depth_ = depth; }
+
+  size_t GetPrefetchDepth() const { return prefetch_depth_.load(); }
+
+  /**
+   * Pages brought in by read-ahead
+   */
+  size_t GetNumPrefetchedPages();
+
+  /**
+   * Prefetched pages which were fetched afterwards
+   */
+  size_t GetNumPrefetchHits();
+
+  /**
+   * Prefetched pages which left the buffer pool without being fetched
+   */
+  size_t GetNumWastedPrefetches();
+
+  size_t GetPoolSize() const { return pool_size_; }
+
+  size_t GetNumInstances() const { return instances_.size(); }
+
 private:
   /**
    * Allocate new page (operations like create index/table) For now just keep an increasing counter
@@ -43,15 +131,58 @@ private:
    */
   void DeallocatePage(page_id_t page_id);
 
+  /**
+   * One round of the background writer
+   */
+  void BackgroundWriterRound();
+
+  /**
+   * Write up to max_pages dirty pages, spread over all instances
+   */
+  size_t FlushDirtyPages(size_t max_pages);
+
+  /**
+   * Body of the read-ahead thread
+   */
+  void PrefetchWorker();
+
+  /**
+   * Whether a newer read-ahead request of the same kind of chain is waiting
+   */
+  bool HasPendingPrefetch(NextPageFunc next_page);
+
+  void StopPrefetcher();
+
+  /**
+   * Get the shard responsible for the page
+   */
+  inline BufferPoolManagerInstance *GetInstance(page_id_t page_id) {
+    return instances_[static_cast<uint32_t>(page_id) % instances_.size()];
+  }
 
 private:
   size_t pool_size_;                                        // number of pages in buffer pool
-  Page *pages_;                                             // array of pages
   DiskManager *disk_manager_;                               // pointer to the disk manager.
-  std::unordered_map<page_id_t, frame_id_t> page_table_;    // to keep track of pages
-  Replacer *replacer_;                                      // to find an unpinned page for replacement
-  std::list<frame_id_t> free_list_;                         // to find a free page for replacement
-  recursive_mutex latch_;                                   // to protect shared data structure
+  std::vector<BufferPoolManagerInstance *> instances_;      // shards of the buffer pool
+  // background writer
+  std::thread bg_writer_;
+  std::mutex bg_latch_;
+  std::condition_variable bg_cv_;
+  bool bg_stop_{false};
+  uint32_t bg_interval_ms_{DEFAULT_BG_WRITER_INTERVAL_MS};
+  size_t bg_pages_per_round_{DEFAULT_BG_WRITER_PAGES_PER_ROUND};
+  std::atomic<size_t> max_dirty_pages_;
+  std::atomic<size_t> next_flush_instance_{0};
+  // read-ahead
+  std::thread prefetcher_;
+  std::mutex prefetch_latch_;
+  std::condition_variable prefetch_cv_;
+  // signalled when the read-ahead thread becomes idle
+  std::condition_variable prefetch_idle_cv_;
+  bool prefetch_busy_{false};
+  std::deque<std::pair<page_id_t, NextPageFunc>> prefetch_queue_;
+  bool prefetch_stop_{false};
+  std::atomic<size_t> prefetch_depth_{DEFAULT_PREFETCH_DEPTH};
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -0,0 +1,155 @@
+#ifndef MINISQL_BUFFER_POOL_MANAGER_INSTANCE_H
+#define MINISQL_BUFFER_POOL_MANAGER_INSTANCE_H
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "page/page.h"
+#include "storage/disk_manager.h"
+
+/**
+ * Extracts the id of the next page in a page chain (table heap pages, B+ tree leaves) from the page data
+ */
+using NextPageFunc = page_id_t (*)(char *page_data);
+
+/**
+ * BufferPoolManagerInstance is a single shard of the buffer pool. It owns its frames, page table, free list and
+ * replacer, and protects all of them with one latch, so shards never contend with each other.
+ *
+ * Page ids are allocated by the owning BufferPoolManager, which routes every page to exactly one instance.
+ */
+class BufferPoolManagerInstance {
+public:
+  explicit BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                     ReplacerType replacer_type = ReplacerType::kLRU);
+
+  ~BufferPoolManagerInstance();
+
+  /**
+   * Pin the page once more, every fetch must be matched by an unpin
+   * @param[out] loaded set to true if the page had to be read from disk
+   */
+  Page *FetchPage(page_id_t page_id, bool *loaded = nullptr);
+
+  /**
+   * Release one pin, the page may be evicted once its last pin is released
+   * @return false if the page is not resident or not pinned
+   */
+  bool UnpinPage(page_id_t page_id, bool is_dirty);
+
+  bool FlushPage(page_id_t page_id);
+
+  /**
+   * Install an already allocated page into a free frame of this instance
+   * @return nullptr if all frames of this instance are pinned
+   */
+  Page *NewPage(page_id_t page_id);
+
+  /**
+   * Drop the page from this instance, the caller is responsible to deallocate it on disk
+   * @return false if the page is still pinned
+   */
+  bool DeletePage(page_id_t page_id);
+
+  /**
+   * Write back the page if it is dirty and return its frame to the free list
+   * @return false if the page is not resident or still pinned
+   */
+  bool EvictPage(page_id_t page_id);
+
+  /**
+   * Flush every page held by this instance
+   */
+  void FlushAllPages();
+
+  /**
+   * Write back dirty pages which are not pinned and mark them clean. Each page is pinned and read latched until its
+   * write is done, a page whose latch is held is skipped. The shard is not locked during the writes, which are done
+   * in batches of at most the I/O queue depth so that foreground fetches still find frames.
+   * @param max_pages stop after writing this many pages
+   * @return number of pages written
+   */
+  size_t FlushDirtyPages(size_t max_pages);
+
+  size_t GetNumDirtyPages();
+
+  /**
+   * Bring the page into this instance without pinning it, on behalf of the read-ahead thread. The disk read is done
+   * without holding the latch, the page is dropped if somebody else loads or writes it in the meantime.
+   * @param[out] next_page_id id of the page following this one in its chain, read without latching the page, so
+   * the caller must check that it is allocated before following it
+   * @return false if the page could not be brought in
+   */
+  bool PrefetchPage(page_id_t page_id, NextPageFunc next_page, page_id_t *next_page_id);
+
+  size_t GetNumPrefetchedPages() const { return num_prefetched_.load(); }
+
+  size_t GetNumPrefetchHits() const { return num_prefetch_hits_.load(); }
+
+  size_t GetNumWastedPrefetches() const { return num_wasted_prefetches_.load(); }
+
+  bool CheckAllUnpinned();
+
+  size_t GetPoolSize() const { return pool_size_; }
+
+private:
+  /**
+   * Find a frame for a new resident page, from the free list first and then from the replacer.
+   * Dirty victims are written back and removed from the page table. Only unpinned frames are victims, and a page
+   * is only latched while it is pinned.
+   * The frame is returned write latched, the caller unlatches it once it holds the new page, so that optimistic
+   * readers of the old page notice the change.
+   * @return false if no frame is available
+   */
+  bool FindFrame(frame_id_t *frame_id);
+
+  /**
+   * Write the page back to disk, latch must be held
+   */
+  void WriteBack(page_id_t page_id, const char *page_data);
+
+  /**
+   * Write back a batch of pages with as many writes in flight as the disk manager allows, latch must be held
+   */
+  void WriteBackBatch(std::vector<PageIORequest> &requests);
+
+  /**
+   * Write back up to max_pages dirty pages which are not pinned in a single batch, see FlushDirtyPages()
+   * @return number of pages written
+   */
+  size_t FlushDirtyBatch(size_t max_pages);
+
+  /**
+   * Forget that the frame was filled by read-ahead, a prefetched page leaving the pool unused is wasted
+   */
+  void ClearPrefetched(frame_id_t frame_id) {
+    if (prefetched_[frame_id]) {
+      prefetched_[frame_id] = false;
+      num_wasted_prefetches_++;
+    }
+  }
+
+private:
+  size_t pool_size_;                                        // number of pages in this instance
+  Page *pages_;                                             // array of pages
+  DiskManager *disk_manager_;                               // pointer to the disk manager.
+  std::unordered_map<page_id_t, frame_id_t> page_table_;    // to keep track of pages
+  Replacer *replacer_;                                      // to find an unpinned page for replacement
+  std::list<frame_id_t> free_list_;                         // to find a free page for replacement
+  std::mutex latch_;                                        // to protect shared data structure
+  // read-ahead
+  std::vector<bool> prefetched_;                            // frame was filled by read-ahead and not fetched yet
+  std::unordered_set<page_id_t> prefetch_in_flight_;        // pages being read by the read-ahead thread
+  std::atomic<size_t> num_prefetched_{0};
+  std::atomic<size_t> num_prefetch_hits_{0};
+  std::atomic<size_t> num_wasted_prefetches_{0};
+};
+
+#endif  // MINISQL_BUFFER_POOL_MANAGER_INSTANCE_H
@@ -0,0 +1,38 @@
+#ifndef MINISQL_BUFFER_RING_H
+#define MINISQL_BUFFER_RING_H
+
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * BufferRing is the buffer access strategy of a sequential scan.
+ *
+ * Pages a scan reads from disk are remembered in a small ring. Once the ring is full, the page loaded longest ago
+ * is handed back to the buffer pool's free list before the next one is remembered, so a scan keeps recycling about
+ * ring size frames instead of flushing the working set of the shared pool. Pages that were already resident when
+ * the scan reached them are never put into the ring.
+ */
+class BufferRing {
+public:
+  explicit BufferRing(size_t ring_size = SCAN_RING_SIZE) : ring_(ring_size, INVALID_PAGE_ID) {}
+
+  /**
+   * Remember a page loaded by the scan
+   * @return the page which falls out of the ring and should be evicted, INVALID_PAGE_ID if the ring is not full yet
+   */
+  page_id_t Push(page_id_t page_id) {
+    page_id_t old_page_id = ring_[cursor_];
+    ring_[cursor_] = page_id;
+    cursor_ = (cursor_ + 1) % ring_.size();
+    return old_page_id;
+  }
+
+  size_t GetRingSize() const { return ring_.size(); }
+
+private:
+  std::vector<page_id_t> ring_;
+  size_t cursor_{0};
+};
+
+#endif  // MINISQL_BUFFER_RING_H
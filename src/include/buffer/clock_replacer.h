@@ -0,0 +1,56 @@
+#ifndef MINISQL_CLOCK_REPLACER_H
+#define MINISQL_CLOCK_REPLACER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+/**
+ * ClockReplacer implements the CLOCK (second chance) replacement policy.
+ *
+ * Every frame has a small atomic state word holding a tracked bit, a pinned bit and a reference bit. Pin and Unpin
+ * only flip those bits with atomic operations, so the hot fetch path never takes a lock or touches a list. Only
+ * Victim takes the latch that protects the clock hand: it sweeps the frames, clearing reference bits, until it
+ * finds an unpinned frame which has not been referenced since the last sweep.
+ */
+class ClockReplacer : public Replacer {
+public:
+  /**
+   * Create a new ClockReplacer.
+   * @param num_pages the maximum number of pages the ClockReplacer will be required to store
+   */
+  explicit ClockReplacer(size_t num_pages);
+
+  ~ClockReplacer() override = default;
+
+  bool insert(frame_id_t frame_id) override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  int GetPinCount() override;
+
+  size_t Size() override;
+
+private:
+  static constexpr uint8_t TRACKED = 1;
+  static constexpr uint8_t PINNED = 2;
+  static constexpr uint8_t REFERENCED = 4;
+
+  size_t capacity_;
+  std::unique_ptr<std::atomic<uint8_t>[]> states_;
+  std::atomic<size_t> size_{0};
+  std::atomic<int> pin_count_{0};
+  size_t hand_{0};
+  std::mutex hand_latch_;
+};
+
+#endif  // MINISQL_CLOCK_REPLACER_H
@@ -0,0 +1,77 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame whose backward K-distance, i.e. the time since its K-th most recent access, is
+ * the largest. Frames with fewer than K recorded accesses have an infinite distance and are evicted first, in the
+ * order of their earliest access. A page touched once by a sequential scan therefore never pushes out pages that
+ * are accessed repeatedly, such as B+ tree internal pages.
+ *
+ * Accesses to a frame within the correlated reference period of its previous access are treated as one access,
+ * so a fetch/unpin/fetch burst on the same page does not make the page look hot.
+ */
+class LRUKReplacer : public Replacer {
+public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k number of accesses remembered per frame
+   * @param correlated_period accesses closer than this many ticks of the logical clock are correlated
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = 2, uint64_t correlated_period = 0);
+
+  ~LRUKReplacer() override = default;
+
+  bool insert(frame_id_t frame_id) override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  int GetPinCount() override;
+
+  size_t Size() override;
+
+private:
+  struct FrameInfo {
+    std::deque<uint64_t> history_;    // the last k access timestamps, oldest first
+    bool evictable_{false};
+  };
+
+  /**
+   * Record a new access of the frame at the current logical time
+   */
+  void RecordAccess(FrameInfo &info);
+
+  /**
+   * Eviction order key, smaller keys are evicted first
+   */
+  std::pair<uint64_t, uint64_t> EvictKey(const FrameInfo &info) const {
+    return {info.history_.size() < k_ ? 0 : 1, info.history_.front()};
+  }
+
+private:
+  size_t capacity_;
+  size_t k_;
+  uint64_t correlated_period_;
+  uint64_t current_timestamp_{0};
+  size_t pin_count_{0};
+  std::unordered_map<frame_id_t, FrameInfo> frames_;
+  std::set<std::pair<std::pair<uint64_t, uint64_t>, frame_id_t>> evictable_;
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
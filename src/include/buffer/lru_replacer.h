@@ -72,6 +72,8 @@ public:
   void Pin(frame_id_t frame_id) override;
 
   void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
   int GetPinCount() override;
   size_t Size() override;
 
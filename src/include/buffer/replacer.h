@@ -4,6 +4,11 @@
 #include <cstdio>
 #include "common/config.h"
 
+/**
+ * Replacement policies the buffer pool can be configured with.
+ */
+enum class ReplacerType { kLRU, kLRUK, kClock };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -33,6 +38,12 @@ public:
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Forget a frame whose page has been dropped from the buffer pool, whether it is pinned or not.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
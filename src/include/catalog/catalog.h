@@ -79,7 +79,7 @@ public:
 
   dberr_t CreateIndex(const std::string &table_name, const std::string &index_name,
                       const std::vector<std::string> &index_keys, Transaction *txn,
-                      IndexInfo *&index_info);
+                      IndexInfo *&index_info, IndexType index_type = IndexType::kBPlusTree, bool unique = true);
 
   dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info) const;
 
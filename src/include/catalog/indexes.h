@@ -6,15 +6,31 @@
 #include "catalog/table.h"
 #include "index/generic_key.h"
 #include "index/b_plus_tree_index.h"
+#include "index/extendible_hash_index.h"
 #include "record/schema.h"
 #include "page/index_roots_page.h"
 #include "record/row.h"
+
+/**
+ * Kind of index structure, persisted with the index metadata
+ */
+enum class IndexType : uint32_t {
+  kBPlusTree = 0,  /** ordered, serves point lookups and range scans */
+  kHash,           /** extendible hash, serves point lookups only */
+};
+
 class IndexMetadata {
   friend class IndexInfo;
 public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name,
                                const table_id_t table_id, const std::vector<uint32_t> &key_map,
-                               MemHeap *heap);
+                               MemHeap *heap, IndexType index_type = IndexType::kBPlusTree, bool unique = true);
+
+  /**
+   * Parse the index type named in CREATE INDEX ... USING, "bptree" or "hash" in any case
+   * @return false if the name is unknown
+   */
+  static bool ParseIndexType(const std::string &name, IndexType &index_type);
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -32,15 +48,22 @@ public:
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  inline IndexType GetIndexType() const { return index_type_; }
+
+  inline bool IsUnique() const { return unique_; }
+
 private:
   IndexMetadata() = default;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name,
-                         const table_id_t table_id, const std::vector<uint32_t> &key_map) {
+                         const table_id_t table_id, const std::vector<uint32_t> &key_map,
+                         IndexType index_type, bool unique) {
                            this->index_id_= index_id;
                            this->index_name_ = index_name;
                            this->table_id_ = table_id;
                            this->key_map_ = key_map;
+                           this->index_type_ = index_type;
+                           this->unique_ = unique;
                          }
 
 
@@ -50,31 +73,41 @@ private:
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_;  /** The mapping of index key to tuple key */
+  IndexType index_type_{IndexType::kBPlusTree};
+  bool unique_{true};  /** whether two rows may not share a key, a hash index is always unique */
 };
 
 /**
  * The IndexInfo class maintains metadata about a index.
  */
 class IndexInfo {
+  friend class CatalogManager;
+
 public:
   using INDEX_KEY_TYPE128 = GenericKey<128>;
   using INDEX_COMPARATOR_TYPE128 = GenericComparator<128>;
   using BP_TREE_INDEX128 = BPlusTreeIndex<INDEX_KEY_TYPE128, RowId, INDEX_COMPARATOR_TYPE128>;
+  using HASH_INDEX128 = ExtendibleHashIndex<INDEX_KEY_TYPE128, RowId, INDEX_COMPARATOR_TYPE128>;
   using INDEX_KEY_TYPE64 = GenericKey<64>;
   using INDEX_COMPARATOR_TYPE64 = GenericComparator<64>;
   using BP_TREE_INDEX64 = BPlusTreeIndex<INDEX_KEY_TYPE64, RowId, INDEX_COMPARATOR_TYPE64>;
+  using HASH_INDEX64 = ExtendibleHashIndex<INDEX_KEY_TYPE64, RowId, INDEX_COMPARATOR_TYPE64>;
   using INDEX_KEY_TYPE32 = GenericKey<32>;
   using INDEX_COMPARATOR_TYPE32 = GenericComparator<32>;
   using BP_TREE_INDEX32 = BPlusTreeIndex<INDEX_KEY_TYPE32, RowId, INDEX_COMPARATOR_TYPE32>;
+  using HASH_INDEX32 = ExtendibleHashIndex<INDEX_KEY_TYPE32, RowId, INDEX_COMPARATOR_TYPE32>;
   using INDEX_KEY_TYPE16 = GenericKey<16>;
   using INDEX_COMPARATOR_TYPE16 = GenericComparator<16>;
   using BP_TREE_INDEX16 = BPlusTreeIndex<INDEX_KEY_TYPE16, RowId, INDEX_COMPARATOR_TYPE16>;
+  using HASH_INDEX16 = ExtendibleHashIndex<INDEX_KEY_TYPE16, RowId, INDEX_COMPARATOR_TYPE16>;
   using INDEX_KEY_TYPE8 = GenericKey<8>;
   using INDEX_COMPARATOR_TYPE8 = GenericComparator<8>;
   using BP_TREE_INDEX8 = BPlusTreeIndex<INDEX_KEY_TYPE8, RowId, INDEX_COMPARATOR_TYPE8>;
+  using HASH_INDEX8 = ExtendibleHashIndex<INDEX_KEY_TYPE8, RowId, INDEX_COMPARATOR_TYPE8>;
   using INDEX_KEY_TYPE4 = GenericKey<4>;
   using INDEX_COMPARATOR_TYPE4 = GenericComparator<4>;
   using BP_TREE_INDEX4 = BPlusTreeIndex<INDEX_KEY_TYPE4, RowId, INDEX_COMPARATOR_TYPE4>;
+  using HASH_INDEX4 = ExtendibleHashIndex<INDEX_KEY_TYPE4, RowId, INDEX_COMPARATOR_TYPE4>;
   static IndexInfo *Create(MemHeap *heap) {
     void *buf = heap->Allocate(sizeof(IndexInfo));
     return new(buf)IndexInfo();
@@ -99,16 +132,16 @@ public:
   }
 
   inline Index *GetIndex() { return index_; }
+
+  inline IndexType GetIndexType() const { return meta_data_->GetIndexType(); }
+
+  // only a B+ tree index may be cast by GetBTreeIndexN and scanned in key order
+  inline bool IsBTreeIndex() const { return GetIndexType() == IndexType::kBPlusTree; }
+
+  // the entries of a non-unique index are keyed by the key and the row id
+  inline bool IsUnique() const { return meta_data_->IsUnique(); }
   inline int BpTreeType(){
-    uint32_t key_size = 4;
-    std::vector<Column*> cols = key_schema_->GetColumns();
-    uint32_t key_len = 0;
-    for(auto &it :cols){
-      key_len += it->GetSerializedSize();
-    }
-    assert(key_len<=128);
-    while(key_size<key_len) key_size<<=1;
-    switch(key_size){
+    switch(GetKeySize()){
       case 4: return 0;
       case 8: return 1;
       case 16: return 2;
@@ -145,8 +178,20 @@ public:
   inline TableInfo *GetTableInfo() const { return table_info_; }
 
 private:
+  // size of the GenericKey holding the keys of the index
+  uint32_t GetKeySize() const {
+    uint32_t key_size = 4;
+    uint32_t key_len = KeyEncoding::GetEncodedSize(key_schema_);
+    if (!meta_data_->IsUnique()) {
+      key_len += sizeof(RowId);
+    }
+    assert(key_len<=128);
+    while(key_size<key_len) key_size<<=1;
+    return key_size;
+  }
+
   explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, table_info_{nullptr},
-                         key_schema_{nullptr}, heap_(new SimpleMemHeap()) {}
+                         key_schema_{nullptr}, heap_(new ArenaMemHeap()) {}
 
   Index *CreateIndex(BufferPoolManager *buffer_pool_manager) {
     // allocate root page for the index
@@ -157,45 +202,31 @@ private:
     if(!index_root_page->GetRootId(index_id,&root_page_id)){
       index_root_page->Insert(index_id,INVALID_PAGE_ID);
     }
-    uint32_t key_size = 4;
-    std::vector<Column*> cols = key_schema_->GetColumns();
-    uint32_t key_len = 0;
-    for(auto &it :cols){
-      key_len += it->GetSerializedSize();
-    }
-    assert(key_len<=128);
+    uint32_t key_size = GetKeySize();
+    bool unique = this->meta_data_->IsUnique();
     Index* res;
-    while(key_size<key_len) key_size<<=1;
+    if (this->meta_data_->GetIndexType() == IndexType::kHash) {
+      switch(key_size){
+        case 4: res = ALLOC_P(this->heap_,HASH_INDEX4)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
+        case 8: res = ALLOC_P(this->heap_,HASH_INDEX8)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
+        case 16: res = ALLOC_P(this->heap_,HASH_INDEX16)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
+        case 32: res = ALLOC_P(this->heap_,HASH_INDEX32)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
+        case 64: res = ALLOC_P(this->heap_,HASH_INDEX64)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
+        case 128: res = ALLOC_P(this->heap_,HASH_INDEX128)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
+        default: return nullptr;break;
+      }
+      return res;
+    }
     switch(key_size){
-      case 4: res = ALLOC_P(this->heap_,BP_TREE_INDEX4)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
-      case 8: res =  ALLOC_P(this->heap_,BP_TREE_INDEX8)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
-      case 16: res = ALLOC_P(this->heap_,BP_TREE_INDEX16)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
-      case 32: res = ALLOC_P(this->heap_,BP_TREE_INDEX32)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
-      case 64: res = ALLOC_P(this->heap_,BP_TREE_INDEX64)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
-      case 128: res = ALLOC_P(this->heap_,BP_TREE_INDEX128)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager);break;
+      case 4: res = ALLOC_P(this->heap_,BP_TREE_INDEX4)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager,unique);break;
+      case 8: res =  ALLOC_P(this->heap_,BP_TREE_INDEX8)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager,unique);break;
+      case 16: res = ALLOC_P(this->heap_,BP_TREE_INDEX16)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager,unique);break;
+      case 32: res = ALLOC_P(this->heap_,BP_TREE_INDEX32)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager,unique);break;
+      case 64: res = ALLOC_P(this->heap_,BP_TREE_INDEX64)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager,unique);break;
+      case 128: res = ALLOC_P(this->heap_,BP_TREE_INDEX128)(this->meta_data_->GetIndexId(),this->key_schema_,buffer_pool_manager,unique);break;
       default: return nullptr;break;
     }
-    // syn to table heap
-  
-  // insert the table content to the index
-  
-  auto it_table_heap_ = this->table_info_->GetTableHeap()->Begin(nullptr);
-  if(it_table_heap_==this->table_info_->GetTableHeap()->End()) return res;
-  std::vector<Field> first_key_;
-  std::vector<RowId> row_id_;
-  for(auto &it:this->meta_data_->key_map_){
-      first_key_.push_back(*it_table_heap_->GetField(it));
-  }
-  if(res->ScanKey(Row(first_key_),row_id_,nullptr)) return res;
-
-  while(it_table_heap_!=this->table_info_->GetTableHeap()->End()){
-    vector<Field> key_field;
-    for(auto &it:this->meta_data_->key_map_){
-      key_field.push_back(*it_table_heap_->GetField(it));
-    }
-    res->InsertEntry(Row(key_field),it_table_heap_->GetRowId(),nullptr);
-    ++it_table_heap_;
-  }
+    // a new index is filled by its creator with Index::BulkLoad, a loaded one is in sync with its table already
   return res;
   }
 
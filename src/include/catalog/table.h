@@ -18,7 +18,7 @@ public:
   static uint32_t DeserializeFrom(char *buf, TableMetadata *&table_meta, MemHeap *heap);
 
   static TableMetadata *Create(table_id_t table_id, std::string table_name,
-                               page_id_t root_page_id, TableSchema *schema, MemHeap *heap);
+                               page_id_t root_page_id, page_id_t fsm_page_id, TableSchema *schema, MemHeap *heap);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -26,19 +26,25 @@ public:
 
   inline uint32_t GetFirstPageId() const { return root_page_id_; }
 
+  inline page_id_t GetFreeSpaceMapPageId() const { return fsm_page_id_; }
+
+  inline void SetFreeSpaceMapPageId(page_id_t fsm_page_id) { fsm_page_id_ = fsm_page_id; }
+
   inline Schema *GetSchema() const { return schema_; }
 
 TableMetadata() = default;
 private:
   
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, page_id_t fsm_page_id,
+                TableSchema *schema);
 
 private:
   static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
   table_id_t table_id_;
   std::string table_name_;
   page_id_t root_page_id_;
+  page_id_t fsm_page_id_;
   Schema *schema_;
 };
 
@@ -46,6 +52,8 @@ private:
  * The TableInfo class maintains metadata about a table.
  */
 class TableInfo {
+  friend class CatalogManager;
+
 public:
   static TableInfo *Create(MemHeap *heap) {
     void *buf = heap->Allocate(sizeof(TableInfo));
@@ -76,7 +84,7 @@ public:
   inline page_id_t GetRootPageId() const { return table_meta_->root_page_id_; }
 
 private:
-  explicit TableInfo() : heap_(new SimpleMemHeap()) {};
+  explicit TableInfo() : heap_(new ArenaMemHeap()) {};
 
 private:
   TableMetadata *table_meta_;
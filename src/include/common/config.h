@@ -15,6 +15,17 @@ static constexpr int INDEX_ROOTS_PAGE_ID = 1;        // logical page id of the i
 
 static constexpr int PAGE_SIZE = 4096;               // size of a data page in byte
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 1024;// default size of buffer pool
+static constexpr int DEFAULT_BUFFER_POOL_INSTANCES = 4;// default number of buffer pool shards
+static constexpr int SCAN_RING_SIZE = 32;            // number of frames recycled by a sequential scan
+static constexpr int DEFAULT_BG_WRITER_INTERVAL_MS = 200;      // time between two background writer rounds
+static constexpr int DEFAULT_BG_WRITER_PAGES_PER_ROUND = 64;   // pages trickled to disk per writer round
+static constexpr int DEFAULT_PREFETCH_DEPTH = 8;     // pages read ahead of a sequential scan
+static constexpr int MAX_PENDING_PREFETCHES = 16;    // read-ahead requests queued at most
+static constexpr uint32_t SEQUENTIAL_SCAN_THRESHOLD = 2;  // page boundaries a scan crosses before read-ahead starts
+static constexpr uint32_t DEFAULT_IO_QUEUE_DEPTH = 32;    // asynchronous page I/Os kept in flight
+static constexpr double DEFAULT_INDEX_FILL_FACTOR = 0.9;  // fraction of a page filled by an index bulk load
+static constexpr size_t INDEX_BUILD_SORT_MEMORY = 64 << 20;  // bytes of index entries sorted in memory at once
+static constexpr uint32_t MAX_INDEX_BUILD_THREADS = 8;      // threads scanning and sorting a table for a new index
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;    // max length of varchar
@@ -13,7 +13,9 @@
 class DBStorageEngine {
 public:
   explicit DBStorageEngine(std::string db_name, bool init = true,
-                           uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE)
+                           uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE,
+                           uint32_t buffer_pool_instances = DEFAULT_BUFFER_POOL_INSTANCES,
+                           ReplacerType replacer_type = ReplacerType::kLRU)
           : db_file_name_(std::move(db_name)), init_(init) {
     // Init database file if needed
     if (init_) {
@@ -21,7 +23,8 @@ public:
     }
     // Initialize components
     disk_mgr_ = new DiskManager(db_file_name_);
-    bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+    bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_, buffer_pool_instances, replacer_type);
+    bpm_->StartBackgroundWriter();
     catalog_mgr_ = new CatalogManager(bpm_, nullptr, nullptr, init);
     // Allocate static page for db storage engine
     if (init) {
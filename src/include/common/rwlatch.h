@@ -1,9 +1,11 @@
 #ifndef MINISQL_RWLATCH_H
 #define MINISQL_RWLATCH_H
 
+#include <atomic>
 #include <climits>
 #include <condition_variable>
 #include <mutex>
+#include <thread>
 #include "macros.h"
 
 
@@ -36,6 +38,19 @@ public:
     }
   }
 
+  /**
+   * Acquire a write latch only if nobody holds the latch.
+   * @return true if the write latch was acquired
+   */
+  bool TryWLock() {
+    std::lock_guard<mutex_t> guard(mutex_);
+    if (writer_entered_ || reader_count_ > 0) {
+      return false;
+    }
+    writer_entered_ = true;
+    return true;
+  }
+
   /**
    * Release a write latch.
    */
@@ -56,6 +71,19 @@ public:
     reader_count_++;
   }
 
+  /**
+   * Acquire a read latch only if no writer holds or waits for the latch.
+   * @return true if the read latch was acquired
+   */
+  bool TryRLock() {
+    std::lock_guard<mutex_t> guard(mutex_);
+    if (writer_entered_ || reader_count_ == MAX_READERS) {
+      return false;
+    }
+    reader_count_++;
+    return true;
+  }
+
   /**
    * Release a read latch.
    */
@@ -85,4 +113,72 @@ private:
   bool writer_entered_{false};
 };
 
+/**
+ * Hybrid latch: a reader-writer latch plus a version counter whose lowest bit is set while the latch is held
+ * exclusively. Besides taking the read latch, a reader may read optimistically: remember the version, read without
+ * latching and validate afterwards that the version is unchanged. Optimistic reads write no shared memory, but they
+ * may see data in the middle of a modification, nothing read may be acted upon before it is validated.
+ */
+class HybridLatch {
+public:
+  HybridLatch() = default;
+
+  DISALLOW_COPY(HybridLatch);
+
+  void WLock() {
+    latch_.WLock();
+    BeginWrite();
+  }
+
+  bool TryWLock() {
+    if (!latch_.TryWLock()) {
+      return false;
+    }
+    BeginWrite();
+    return true;
+  }
+
+  void WUnlock() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    latch_.WUnlock();
+  }
+
+  void RLock() { latch_.RLock(); }
+
+  bool TryRLock() { return latch_.TryRLock(); }
+
+  void RUnlock() { latch_.RUnlock(); }
+
+  /**
+   * Start an optimistic read, waiting for the writer if the latch is held exclusively.
+   * @return the version to validate against
+   */
+  uint64_t OptimisticRead() const {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    while (version & 1) {
+      std::this_thread::yield();
+      version = version_.load(std::memory_order_acquire);
+    }
+    return version;
+  }
+
+  /**
+   * @return true if nobody has write latched since the optimistic read returning version started
+   */
+  bool Validate(uint64_t version) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
+private:
+  void BeginWrite() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    // the odd version becomes visible before any write under the latch
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  ReaderWriterLatch latch_;
+  std::atomic<uint64_t> version_{0};
+};
+
 #endif  // MINISQL_RWLATCH_H
@@ -1,11 +1,14 @@
 #ifndef MINISQL_EXECUTE_ENGINE_H
 #define MINISQL_EXECUTE_ENGINE_H
 
+#include <functional>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "common/dberr.h"
 #include "common/instance.h"
 #include "transaction/transaction.h"
+#include "utils/mem_heap.h"
 
 extern "C" {
 #include "parser/parser.h"
@@ -20,10 +23,22 @@ extern "C" {
 struct ExecuteContext {
   bool flag_quit_{false};
   bool condition_{true};
-  int index_ind{-1};
   Transaction *txn_{nullptr};
 };
 
+/**
+ * Key range of an index scan, chosen by SelectIterator. Each bound holds the values of leading key columns: the scan
+ * starts at the first key beginning with the lower values, or right after the last one if the bound is exclusive,
+ * and ends the same way at the upper values. An empty bound leaves the range open on its side.
+ * A hash index is only scanned for the key given by all of its columns as lower bound.
+ */
+struct IndexRange {
+  std::vector<Field> lower_;
+  std::vector<Field> upper_;
+  bool lower_inclusive_{true};
+  bool upper_inclusive_{true};
+};
+
 /**
  * ExecuteEngine
  */
@@ -51,6 +66,8 @@ public:
   dberr_t ExecuteSaveDatabase(ExecuteContext *context);
 
 private:
+  dberr_t ExecuteStatement(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *context);
@@ -91,16 +108,27 @@ private:
 
   // Extra function: Condition judgement
   // Judge whether this data row satisfies the condition basing on the syntax tree
-  dberr_t LogicConditions(pSyntaxNode ast, ExecuteContext *context, const Row &row, Schema* schema);
+  // RowType is a deserialized Row, or a RowView which reads the tuple in place
+  template<typename RowType>
+  dberr_t LogicConditions(pSyntaxNode ast, ExecuteContext *context, const RowType &row, Schema* schema);
 
   // Extra function: Iterator selector
-  // Find the first identifier with available index among conditions
-  dberr_t SelectIterator(pSyntaxNode condition, ExecuteContext *context, const TableInfo *table, IndexInfo *&index,
-                         RowId &begin_id, RowId &end_id, bool &covered);
+  // Among the comparisons of a column with a literal which all rows must satisfy, find the index which narrows the
+  // scan most: a hash index takes equalities on all of its columns, a B+ tree index equalities on a prefix of its
+  // columns and a range on the column after them. Index is set to nullptr if no index can be used.
+  dberr_t SelectIterator(pSyntaxNode condition, const TableInfo *table, IndexInfo *&index, IndexRange &range);
+
+  // Extra function: Index range scan
+  // Visit the entries of a B+ tree index with keys of KeySize bytes in the range, in key order. Visit is given the
+  // row id and the encoded key of each entry, which is only valid during the call.
+  template<size_t KeySize>
+  dberr_t ScanIndexRange(IndexInfo *index, IndexRange &range,
+                         const std::function<dberr_t(const RowId &, const char *)> &visit);
 
 private:
   [[maybe_unused]] std::unordered_map<std::string, DBStorageEngine *> dbs_;  /** all opened databases */
   [[maybe_unused]] std::string current_db_;  /** current database */
+  ArenaMemHeap query_heap_;  /** rows and fields of the running statement, released when it finishes */
 };
 
 #endif //MINISQL_EXECUTE_ENGINE_H
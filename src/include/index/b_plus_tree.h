@@ -1,10 +1,13 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <fstream>
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_leaf_page.h"
 #include "page/b_plus_tree_page.h"
@@ -18,15 +21,26 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) We only support unique key, an index with duplicate keys makes them unique by appending the row id
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrent lookups and modifications are synchronized by latch crabbing on the page latches. Readers descend with
+ * read latches, holding a page until its child is latched. Insert and remove first descend the same way and only
+ * write latch the leaf; if the leaf may split or underflow they start over with write latches, releasing the
+ * ancestors of every page that is safe, i.e. that will not split or underflow itself. The root page id is protected
+ * by root_latch_, which is taken before the root page.
+ * Point lookups first try to descend without latching, validating page versions instead, see GetValueOptimistic().
+ * GetRange() and iterators read latch the leaf chain left to right, an iterator holds its leaf until it moves. A leaf
+ * is only try-latched while its neighbour is held, so a descending scan never waits for a leaf on its left.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  // iterators find their way back into the tree when the next leaf is busy
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
 
 public:
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
@@ -44,12 +58,36 @@ public:
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction = nullptr);
 
+  /**
+   * Append the values of all keys in [lower, upper] to result in key order
+   * @return false if there is no such key
+   */
+  bool GetRange(const KeyType &lower, const KeyType &upper, std::vector<ValueType> &result,
+                Transaction *transaction = nullptr);
+
+  /**
+   * Build the tree bottom-up from count entries in ascending key order, pulled one by one from next. Each level is
+   * written left to right with its pages filled to fill_factor of their capacity, instead of being split half full
+   * as inserts leave them. The tree must be empty and is left empty if it fails.
+   * @return false if the tree is not empty, or next runs out or returns a key not greater than the previous one
+   */
+  bool BulkLoad(size_t count, const std::function<bool(KeyType &, ValueType &)> &next,
+                double fill_factor = DEFAULT_INDEX_FILL_FACTOR);
+
   INDEXITERATOR_TYPE Begin();
 
   INDEXITERATOR_TYPE Begin(const KeyType &key);
 
   INDEXITERATOR_TYPE End();
 
+  /**
+   * Iterators of descending scans, moved with operator--: at the last key of the tree, or at the last key not greater
+   * than the input key
+   */
+  INDEXITERATOR_TYPE RBegin();
+
+  INDEXITERATOR_TYPE RBegin(const KeyType &key);
+
   // expose for test purpose
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
   // check if there is deleted page in tree
@@ -72,9 +110,90 @@ public:
   }
 
 private:
+  enum class Operation { kFind, kInsert, kRemove };
+
+  // The page a bulk load is filling on one level of the tree, and how the entries of the level are spread over pages
+  struct BulkLevel {
+    Page *page{nullptr};
+    KeyType first_key;
+    size_t entries{0};
+    size_t pages{0};
+    size_t page_count{0};
+    size_t page_entries{0};
+    size_t filled{0};
+  };
+
+  /**
+   * Return the page of a bulk loaded level which takes the next entry, whose key is key. Once the current page holds
+   * its share of the entries, a new page is started and the full one is finished.
+   */
+  Page *BulkPageFor(std::vector<BulkLevel> &levels, size_t level, const KeyType &key, double fill_factor,
+                    std::vector<page_id_t> &created);
+
+  /**
+   * Add a finished child page to an internal level of a bulk load
+   * @return the page id of the parent the child was added to
+   */
+  page_id_t BulkAppendChild(std::vector<BulkLevel> &levels, size_t level, const KeyType &key, page_id_t child,
+                            double fill_factor, std::vector<page_id_t> &created);
+
+  // Link a finished page of a bulk load to its parent and unpin it
+  void BulkFinishPage(std::vector<BulkLevel> &levels, size_t level, Page *page, const KeyType &first_key,
+                      double fill_factor, std::vector<page_id_t> &created);
+
+  // Fetch and latch a page
+  Page *FetchLatched(page_id_t page_id, bool exclusive);
+
+  /**
+   * Fetch and read latch a page only if its latch is free. A merge latches the left sibling of a page after the page
+   * itself, so a scan holding a leaf must not wait for the next one.
+   * @return nullptr if the latch is held, the page is unpinned again then
+   */
+  Page *TryFetchRLatched(page_id_t page_id);
+
+  /**
+   * Read latch the leaf holding the first key greater than key, or not less than key if inclusive. The next leaf is
+   * only try-latched while a leaf is held, the search descends again if it is busy.
+   * @param[out] index position of the key in the leaf
+   * @return the latched and pinned leaf, nullptr if there is no such key
+   */
+  Page *SeekForward(const KeyType &key, bool inclusive, int &index);
+
+  /**
+   * Read latch the leaf holding the last key less than key, or not greater than key if inclusive. The previous leaf
+   * is only try-latched while a leaf is held, the search descends again if it is busy.
+   * @param[out] index position of the key in the leaf
+   * @return the latched and pinned leaf, nullptr if there is no such key
+   */
+  Page *SeekBackward(const KeyType &key, bool inclusive, int &index);
+
+  /**
+   * Descend to the leaf page which may contain the key, latch crabbing on the way.
+   * kFind read latches every page. kInsert and kRemove read latch internal pages and write latch the leaf if
+   * optimistic is true, otherwise write latch every page and keep the ancestors of unsafe pages latched.
+   * @param latched the latched pages in top-down order, ending with the leaf. A leading nullptr stands for
+   * root_latch_, which is kept in pessimistic mode while the root may change.
+   * @return the leaf page, or nullptr if the tree is empty
+   */
+  Page *FindLeafLatched(const KeyType &key, Operation op, bool optimistic, std::vector<Page *> &latched);
+
+  /**
+   * Look the key up without latching any page: each page is read optimistically and the parent is validated after
+   * the child's version is taken, lock coupling with versions instead of latches.
+   * @return false if a concurrent modification was detected and the lookup has to be repeated
+   */
+  bool GetValueOptimistic(const KeyType &key, ValueType &value, bool &found);
+
+  // Unlatch and unpin all but the last keep pages, and root_latch_ if it is held
+  void ReleaseLatches(std::vector<Page *> &latched, bool exclusive, size_t keep = 0);
+
+  // Whether a modification of the node leaves its ancestors untouched
+  bool IsSafe(BPlusTreePage *node, Operation op) const;
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
-  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+  bool InsertIntoLeaf(LeafPage *leaf_page, const KeyType &key, const ValueType &value,
+                      Transaction *transaction = nullptr);
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
@@ -84,16 +203,27 @@ private:
   template<typename N>
   N *Split(N *node,KeyType& midder_key);
 
+  /**
+   * Siblings are write latched and added to latched. Pages emptied by a merge are added to deleted, they are only
+   * deleted once all latches are released.
+   */
   template<typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, std::vector<Page *> &latched, std::vector<page_id_t> &deleted,
+                              Transaction *transaction = nullptr);
 
   template<typename N>
   bool Coalesce(N *neighbor_node, N *node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent,
-               const int& index, Transaction *transaction = nullptr);
+               const int& index, std::vector<page_id_t> &deleted, Transaction *transaction = nullptr);
 
   template<typename N>
   void Redistribute(N *neighbor_node, N *node, int index);
 
+  /**
+   * Point the prev link of the leaf after leaf back to it, once a split or merge has changed the next link of leaf.
+   * The next leaf is write latched meanwhile, leaves are always latched left to right by modifications.
+   */
+  void LinkNextLeafBack(LeafPage *leaf);
+
   bool AdjustRoot(BPlusTreePage *node);
 
   void UpdateRootPageId();
@@ -106,6 +236,8 @@ private:
   // member variable
   index_id_t index_id_;
   page_id_t root_page_id_;
+  // protects root_page_id_
+  HybridLatch root_latch_;
   page_id_t first_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
@@ -6,10 +6,16 @@
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * A unique index rejects a second entry of a key. A non-unique index stores the row id in the tree key after the
+ * user key, see GenericKey::SerializeFromKey, so that its entries are unique in the tree and the entries of a key
+ * are scanned as a range. Its keys take sizeof(RowId) more bytes.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
 public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
@@ -19,13 +25,46 @@ public:
 
   dberr_t Destroy() override;
 
+  dberr_t BulkLoad(const std::vector<EntrySource> &sources, Transaction *) override {
+    return BulkLoad(sources, DEFAULT_INDEX_FILL_FACTOR, INDEX_BUILD_SORT_MEMORY);
+  }
+
+  /**
+   * Run every source on a thread of its own, which encodes the keys of its entries and sorts them, spilling sorted
+   * runs to disk beyond its share of sort_memory bytes. The sorted entries of all sources are then merged into the
+   * tree, which is built bottom-up with its pages filled to fill_factor.
+   */
+  dberr_t BulkLoad(const std::vector<EntrySource> &sources, double fill_factor, size_t sort_memory);
+
+  inline bool IsUnique() const { return unique_; }
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  /**
+   * Iterate over the keys between lower and upper, each bound inclusive or not. The tree is descended once to lower
+   * and the scan stops at upper by comparing the keys it passes, so the bounds need not be keys of the tree.
+   */
+  INDEXITERATOR_TYPE GetRangeIterator(const KeyType &lower, bool lower_inclusive, const KeyType &upper,
+                                      bool upper_inclusive);
+
+  /**
+   * Iterators of descending scans, moved with operator-- until they equal GetEndIterator(). A scan starts at the
+   * last key, or at the last key of a range which it walks down the same way GetRangeIterator walks up.
+   */
+  INDEXITERATOR_TYPE GetReverseBeginIterator();
+
+  INDEXITERATOR_TYPE GetReverseRangeIterator(const KeyType &lower, bool lower_inclusive, const KeyType &upper,
+                                             bool upper_inclusive);
+
 protected:
+  // serialize the tree key of an entry
+  void SerializeKey(const Row &key, const RowId &row_id, KeyType &index_key) const;
+
+  bool unique_;
   // comparator for key
   KeyComparator comparator_;
   // container
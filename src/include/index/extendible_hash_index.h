@@ -0,0 +1,32 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_INDEX_H
+#define MINISQL_EXTENDIBLE_HASH_INDEX_H
+
+#include "index/extendible_hash_table.h"
+#include "index/index.h"
+
+#define EXTENDIBLE_HASH_INDEX_TYPE ExtendibleHashIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * Index for equality lookups, see ExtendibleHashTable. It has no order, so it cannot serve range scans.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExtendibleHashIndex : public Index {
+public:
+  ExtendibleHashIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+protected:
+  // comparator for key
+  KeyComparator comparator_;
+  // container
+  EXTENDIBLE_HASH_TABLE_TYPE container_;
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_INDEX_H
@@ -0,0 +1,106 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_TABLE_H
+#define MINISQL_EXTENDIBLE_HASH_TABLE_H
+
+#include <vector>
+
+#include "page/hash_table_bucket_page.h"
+#include "page/hash_table_directory_page.h"
+#include "page/hash_table_header_page.h"
+#include "transaction/transaction.h"
+
+#define EXTENDIBLE_HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Disk based extendible hash table for point lookups on unique keys.
+ *
+ * The table has three levels of pages: a header page, whose id is kept in the index roots page, picks a directory
+ * page by the top bits of the hash of a key, the directory picks a bucket page by the low bits of the hash. A full
+ * bucket is split in two, doubling the directory if the bucket is referenced by a single slot; an emptied bucket is
+ * merged back into its split image and the directory is halved once no bucket needs all of its slots. A directory
+ * which cannot double any more is split in two by the next top bit of the hash, doubling the header if needed.
+ *
+ * Lookups and modifications latch crab from the header down: a lookup read latches every page, a modification read
+ * latches the header and write latches the directory, which it keeps until it is done since a split or merge may
+ * change it. The header is only write latched to split a directory, directories are never merged back.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExtendibleHashTable {
+  using BucketPage = HashTableBucketPage<KeyType, ValueType, KeyComparator>;
+
+public:
+  explicit ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator, uint32_t directory_max_depth = HASH_DIRECTORY_MAX_DEPTH,
+                               int bucket_max_size = HASH_BUCKET_ARRAY_SIZE);
+
+  // Insert a key-value pair, fails if the key exists or the table cannot grow any more.
+  bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove a key and its value, return false if the key does not exist.
+  bool Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // return the value associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction = nullptr);
+
+  // destroy the hash table, deleting all of its pages
+  void Destroy();
+
+  // used to check whether the header and directories are consistent and all pages are unpinned
+  bool Check();
+
+  // number of directory pages, for test purpose
+  size_t GetDirectoryCount();
+
+private:
+  enum class InsertResult { kInserted, kExists, kFull };
+
+  uint32_t Hash(const KeyType &key) const;
+
+  // Fetch and latch a page
+  Page *FetchLatched(page_id_t page_id, bool exclusive);
+
+  // Unlatch and unpin a page
+  void Release(Page *page, bool exclusive, bool is_dirty = false);
+
+  /**
+   * Read latch the header and latch the directory page which holds the hash
+   */
+  Page *FetchDirectory(uint32_t hash, bool exclusive);
+
+  /**
+   * Insert into a write latched directory, splitting buckets as needed
+   * @return kFull if the bucket of the key is full and the directory cannot double any more
+   */
+  InsertResult InsertIntoDirectory(HashTableDirectoryPage *directory, uint32_t hash, const KeyType &key,
+                                   const ValueType &value, bool &is_dirty);
+
+  /**
+   * Split the full directory which holds the hash in two, moving the entries of each of its buckets whose hash has
+   * the next header bit set to a bucket of the new directory. Holds the header write latch.
+   * @return false if the header is full
+   */
+  bool SplitDirectory(uint32_t hash);
+
+  /**
+   * Split a full bucket into itself and a new bucket, doubling the directory if needed. The bucket is released.
+   * @return false if the directory is full
+   */
+  bool SplitBucket(HashTableDirectoryPage *directory, uint32_t bucket_idx, Page *bucket_page);
+
+  /**
+   * Merge an empty bucket into its split image as long as possible and shrink the directory. The bucket is released.
+   */
+  void MergeBucket(HashTableDirectoryPage *directory, uint32_t bucket_idx, Page *bucket_page);
+
+  // Create a directory with a single empty bucket, the directory page is left pinned
+  Page *NewDirectory(page_id_t &directory_page_id);
+
+  // member variable
+  index_id_t index_id_;
+  page_id_t header_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  uint32_t directory_max_depth_;
+  int bucket_max_size_;
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_TABLE_H
@@ -6,22 +6,92 @@
 #include "record/row.h"
 #include "record/field.h"
 
+/**
+ * Order preserving binary encoding of index keys, so that keys compare with a plain memcmp.
+ *
+ * Key columns are encoded in key schema order:
+ * | NullMarker (1) | Value |
+ * where the marker is 0 for null and 1 otherwise, so nulls sort first, and the value is
+ *  - int: big endian with the sign bit flipped
+ *  - float: big endian bits, with the sign bit flipped for positive and all bits flipped for negative numbers
+ *  - char: the characters up to the first zero byte followed by a zero byte, so a string sorts before its
+ *    extensions
+ * A null int or float takes 4 zero bytes, a null char takes none. The encoding of a key prefix is a prefix of the
+ * encoding of the key, a key with fewer fields than the schema is encoded as such a prefix.
+ */
+class KeyEncoding {
+public:
+  /**
+   * @return maximum encoded size of keys of the schema
+   */
+  static uint32_t GetEncodedSize(const Schema *schema);
+
+  /**
+   * @return maximum encoded size of a single column
+   */
+  static uint32_t GetEncodedSize(const Column *column);
+
+  /**
+   * @return encoded size of the key
+   */
+  static uint32_t GetEncodedSize(const Row &key, const Schema *schema);
+
+  /**
+   * Buffer must hold GetEncodedSize(key, schema) bytes
+   * @return encoded size of the key
+   */
+  static uint32_t Encode(const Row &key, const Schema *schema, char *buf);
+
+  /**
+   * Inverse of Encode, char fields end at the first zero byte
+   */
+  static void Decode(const char *buf, const Schema *schema, Row &key);
+};
+
+// Row ids which place a key of a non-unique index before and after all entries of the key
+static const RowId KEY_MIN_ROWID = RowId(0, 0);
+static const RowId KEY_MAX_ROWID = RowId(INVALID_PAGE_ID, UINT32_MAX);
+
 template<size_t KeySize>
 class GenericKey {
 public:
   inline void SerializeFromKey(const Row &key, Schema *schema) {
-    // initialize to 0
-    uint32_t size = key.GetSerializedSize(schema);
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= KeySize, "Index key size exceed max key size.");
+    ASSERT(KeyEncoding::GetEncodedSize(key, schema) <= KeySize, "Index key size exceed max key size.");
+    // initialize to 0, bytes past the encoded key take part in comparisons
     memset(data, 0, KeySize);
-    key.SerializeTo(data, schema);
+    KeyEncoding::Encode(key, schema, data);
+  }
+
+  /**
+   * Serialize the key of a non-unique index, which is followed by the row id in the last bytes of the key, so that
+   * the entries of equal keys are unique and sorted by row id. The page id is encoded unsigned, see KEY_MIN_ROWID
+   * and KEY_MAX_ROWID.
+   */
+  inline void SerializeFromKey(const Row &key, const RowId &row_id, Schema *schema) {
+    ASSERT(KeyEncoding::GetEncodedSize(key, schema) + sizeof(uint64_t) <= KeySize,
+           "Index key size exceed max key size.");
+    SerializeFromKey(key, schema);
+    auto rid = static_cast<uint64_t>(static_cast<uint32_t>(row_id.GetPageId())) << 32 | row_id.GetSlotNum();
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+      data[KeySize - 1 - i] = static_cast<char>(rid >> (8 * i));
+    }
+  }
+
+  /**
+   * Serialize a bound for a range scan from the values of the leading columns of the schema. The bytes past them are
+   * set to 0 for a key before all keys starting with these values, or to 0xff for a key after all of them, row ids
+   * of a non-unique index included. A prefix which fills the whole key has no bytes to set and equals the key, the
+   * scan must then include or exclude the bound itself.
+   */
+  inline void SerializeFromKeyPrefix(const Row &prefix, Schema *schema, bool after) {
+    ASSERT(prefix.GetFieldCount() <= schema->GetColumnCount(), "field nums not match.");
+    memset(data, after ? 0xff : 0, KeySize);
+    KeyEncoding::Encode(prefix, schema, data);
   }
 
   inline void DeserializeToKey(Row &key, Schema *schema) const {
-    uint32_t ofs = key.DeserializeFrom(const_cast<char *>(data), schema);
-    ASSERT(ofs <= KeySize, "Index key size exceed max key size.");
-    return;
+    KeyEncoding::Decode(data, schema, key);
   }
 
   // compare
@@ -47,31 +117,15 @@ public:
 };
 
 /**
- * Function object returns true if lhs < rhs, used for trees
+ * Function object returns a negative number if lhs < rhs, 0 if they are equal and a positive number otherwise,
+ * used for trees. Keys are compared in their encoded form.
  */
 template<size_t KeySize>
 class GenericComparator {
 public:
   inline int operator()(const GenericKey<KeySize> &lhs,
                         const GenericKey<KeySize> &rhs) const {
-    int column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    lhs.DeserializeToKey(lhs_key, key_schema_);
-    rhs.DeserializeToKey(rhs_key, key_schema_);
-
-    for (int i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue)
-        return -1;
-
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue)
-        return 1;
-    }
-    // equals
-    return 0;
+    return memcmp(lhs.data, rhs.data, KeySize);
   }
 
   GenericComparator(const GenericComparator &other) {
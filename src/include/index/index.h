@@ -1,6 +1,7 @@
 #ifndef MINISQL_INDEX_H
 #define MINISQL_INDEX_H
 
+#include <functional>
 #include <memory>
 
 #include "common/dberr.h"
@@ -22,6 +23,34 @@ public:
 
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) = 0;
 
+  /**
+   * Receives the key fields and row id of an index entry, the fields only have to stay valid during the call
+   */
+  using EntrySink = std::function<void(std::vector<Field> &, const RowId &)>;
+
+  /**
+   * Produces a part of the entries of an index, passing them to the sink one by one
+   */
+  using EntrySource = std::function<void(const EntrySink &)>;
+
+  /**
+   * Fill an empty index at once, e.g. when it is created on a table which has rows. The entries are split over
+   * several sources, which an index may run on threads of their own. The default runs them one after the other and
+   * inserts the entries one by one.
+   * @return DB_FAILED if two entries have the same key
+   */
+  virtual dberr_t BulkLoad(const std::vector<EntrySource> &sources, Transaction *txn) {
+    bool failed = false;
+    for (auto &source : sources) {
+      source([&](std::vector<Field> &fields, const RowId &row_id) {
+        if (!failed && InsertEntry(Row(fields), row_id, txn) != DB_SUCCESS) {
+          failed = true;
+        }
+      });
+    }
+    return failed ? DB_FAILED : DB_SUCCESS;
+  }
+
   virtual dberr_t Destroy() = 0;
 
 protected:
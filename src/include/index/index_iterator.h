@@ -5,12 +5,25 @@
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * An iterator keeps its leaf read latched and pinned while it is positioned on it, so the leaf can not change under
+ * it, and releases it once it moves to another leaf, becomes the end iterator or is destroyed. Iterators should be
+ * short lived: a writer waits for every iterator on the leaf it modifies.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
 public:
   // you may define your own constructor based on your member variables
   explicit IndexIterator(int index = -1,B_PLUS_TREE_LEAF_PAGE_TYPE* leaf_page = nullptr,BufferPoolManager* buffer_pool_manager = nullptr);
+  // position on the entry at index of a leaf page which is read latched and pinned, the iterator releases it
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, Page *page, int index);
+  // a copy does not latch the leaf, which this thread already holds; it finds its key again when it moves
   IndexIterator(IndexIterator& other);
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator &operator=(const IndexIterator &other) = delete;
   ~IndexIterator();
 
   /** Return the key/value pair this iterator is currently pointing at. */
@@ -19,18 +32,61 @@ public:
   /** Move to the next key/value pair.*/
   IndexIterator &operator++();
   IndexIterator operator++(int);
+
+  /** Move to the previous key/value pair, the iterator becomes the end iterator before the first one. */
+  IndexIterator &operator--();
+  IndexIterator operator--(int);
   /** Return whether two iterators are equal */
   bool operator==(const IndexIterator &itr) const;
 
   /** Return whether two iterators are not equal. */
   bool operator!=(const IndexIterator &itr) const;
 
+  /**
+   * Stop at the first key greater than upper, or not less than upper if it is not inclusive: the iterator becomes
+   * the end iterator and releases its leaf. The comparator must outlive the iterator.
+   */
+  void SetUpperBound(const KeyType &upper, bool inclusive, const KeyComparator *comparator);
+
+  /**
+   * Stop a descending scan at the first key less than lower, or not greater than lower if it is not inclusive.
+   */
+  void SetLowerBound(const KeyType &lower, bool inclusive, const KeyComparator *comparator);
+
 private:
+  // become the end iterator if the current key is out of the bounds
+  void CheckBounds();
+
+  // take over the latched leaf at index
+  void Position(Page *page, int index);
+
+  // unlatch and unpin the leaf, if the iterator holds it
+  void Release();
+
+  // release the leaf and become the end iterator
+  void MakeEnd();
+
+  // latch the leaf of the key after or before the current one again, for a copy which does not hold it
+  void Reposition(bool forward);
+
   // add your own private member variables here
   int index_;
   std::pair<KeyType,ValueType> val_;
   B_PLUS_TREE_LEAF_PAGE_TYPE* leaf_page_;
   BufferPoolManager* buffer_pool_manager_;
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  // the latched leaf, nullptr for the end iterator and for copies
+  Page *page_{nullptr};
+  // number of leaves crossed, read-ahead starts once the scan is known to be sequential
+  uint32_t pages_crossed_{0};
+  // bounds of a range scan
+  const KeyComparator *comparator_{nullptr};
+  bool has_upper_{false};
+  KeyType upper_;
+  bool upper_inclusive_{false};
+  bool has_lower_{false};
+  KeyType lower_;
+  bool lower_inclusive_{false};
 };
 
 
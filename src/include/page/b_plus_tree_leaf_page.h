@@ -13,13 +13,15 @@
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
+ * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  ----------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4) |
+ *  ----------------------------------------------------------
+ *
+ * The leaves form a doubly linked list in key order, so that they can be scanned in both directions.
  */
 #include <utility>
 #include <vector>
@@ -27,7 +29,7 @@
 #include "page/b_plus_tree_page.h"
 
 #define  B_PLUS_TREE_LEAF_PAGE_TYPE  BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE 32
 #define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (sizeof(ValueType) + sizeof(KeyType)))
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -44,13 +46,32 @@ public:
   // helper methods
   page_id_t GetNextPageId() const;
 
+  /**
+   * Read the next page id from raw page data, used by read-ahead
+   */
+  static page_id_t NextPageIdOf(char *page_data) {
+    return reinterpret_cast<BPlusTreeLeafPage *>(page_data)->GetNextPageId();
+  }
+
   void SetNextPageId(page_id_t next_page_id);
+
+  page_id_t GetPrevPageId() const;
+
+  /**
+   * Read the previous page id from raw page data, used by read-ahead of descending scans
+   */
+  static page_id_t PrevPageIdOf(char *page_data) {
+    return reinterpret_cast<BPlusTreeLeafPage *>(page_data)->GetPrevPageId();
+  }
+
+  void SetPrevPageId(page_id_t prev_page_id);
   page_id_t RemoveAndReturnOnlyChild();
   KeyType KeyAt(int index) const;
 
   KeyType &operator[](int index);
 
   ValueType ValueAt(int index) const;
+  int LowerBound(const KeyType &key, const KeyComparator &comparator) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
 
   const MappingType &GetItem(int index);
@@ -84,6 +105,7 @@ private:
   void CopyFirstFrom(const MappingType &item);
 
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
   KeyType key_[LEAF_PAGE_SIZE];
   ValueType value_[LEAF_PAGE_SIZE];
 };
@@ -30,6 +30,11 @@ public:
    */
   bool IsPageFree(uint32_t page_offset) const;
 
+  /**
+   * @return number of allocated pages counted from the bitmap itself
+   */
+  uint32_t CountAllocatedPages() const;
+
 private:
   /**
    * check a bit(byte_index, bit_index) in bytes is free(value 0).
@@ -40,8 +45,15 @@ private:
    */
   bool IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const;
 
+  /**
+   * @return the 64 bits of pages word_index * 64 to word_index * 64 + 63, the first page being the highest bit
+   */
+  uint64_t LoadWord(uint32_t word_index) const;
+
   /** Note: need to update if modify page structure. */
   static constexpr size_t MAX_CHARS = PageSize - 2 * sizeof(uint32_t);
+  static constexpr size_t MAX_WORDS = MAX_CHARS / sizeof(uint64_t);
+  static_assert(MAX_CHARS % sizeof(uint64_t) == 0, "bitmap must be scanned in whole words");
 
 public:
   /** The space occupied by all members of the class should be equal to the PageSize */
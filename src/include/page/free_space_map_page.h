@@ -0,0 +1,82 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * Free space map of a table heap. Every heap page has an entry recording its free space in units of
+ * PAGE_SIZE / 256 bytes, rounded down, so one byte per page suffices. Entries follow the order of the heap page
+ * chain, the last entry of the last map page is the tail of the heap. Map pages are chained as well.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------------------------------------------------------
+ * | NextMapPageId (4) | EntryCount (4) | HeapPageId_1 (4) | ... | HeapPageId_N (4) | Free_1 (1) | ... | Free_N (1) |
+ *  ---------------------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+public:
+  static constexpr uint32_t MAX_ENTRY_COUNT = (PAGE_SIZE - 2 * sizeof(uint32_t)) / (sizeof(page_id_t) + 1);
+  static constexpr uint32_t FREE_SPACE_UNIT = PAGE_SIZE / 256;
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  /**
+   * @return free space category of a page with free_bytes available, rounded down
+   */
+  static uint8_t ToCategory(uint32_t free_bytes) {
+    uint32_t category = free_bytes / FREE_SPACE_UNIT;
+    return static_cast<uint8_t>(category > UINT8_MAX ? UINT8_MAX : category);
+  }
+
+  /**
+   * @return smallest category which guarantees needed_bytes are available
+   */
+  static uint32_t ToRequiredCategory(uint32_t needed_bytes) {
+    return (needed_bytes + FREE_SPACE_UNIT - 1) / FREE_SPACE_UNIT;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetCount() const { return count_; }
+
+  bool IsFull() const { return count_ == MAX_ENTRY_COUNT; }
+
+  page_id_t GetHeapPageId(uint32_t index) const { return heap_page_ids_[index]; }
+
+  uint8_t GetCategory(uint32_t index) const { return Categories()[index]; }
+
+  void SetCategory(uint32_t index, uint8_t category) { Categories()[index] = category; }
+
+  /**
+   * Add an entry for a newly appended heap page
+   * @return false if the map page is full
+   */
+  bool Append(page_id_t heap_page_id, uint8_t category) {
+    if (IsFull()) {
+      return false;
+    }
+    heap_page_ids_[count_] = heap_page_id;
+    Categories()[count_] = category;
+    count_++;
+    return true;
+  }
+
+private:
+  uint8_t *Categories() { return reinterpret_cast<uint8_t *>(heap_page_ids_ + MAX_ENTRY_COUNT); }
+
+  const uint8_t *Categories() const { return reinterpret_cast<const uint8_t *>(heap_page_ids_ + MAX_ENTRY_COUNT); }
+
+private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  page_id_t heap_page_ids_[0];
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
@@ -0,0 +1,67 @@
+#ifndef MINISQL_HASH_TABLE_BUCKET_PAGE_H
+#define MINISQL_HASH_TABLE_BUCKET_PAGE_H
+
+#include <utility>
+#include <vector>
+
+#include "page/b_plus_tree_page.h"
+
+/**
+ * hash_table_bucket_page.h
+ *
+ * A bucket page of an extendible hash table holds the entries whose hash ends with the bits the directory maps to
+ * it. Entries are not kept in any order, a removed entry is replaced by the last one. Only support unique key.
+ *
+ * Bucket page format (size in byte):
+ *  ---------------------------------------------------------------------------
+ * | Size (4) | MaxSize (4) | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
+ *  ---------------------------------------------------------------------------
+ */
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
+#define HASH_BUCKET_PAGE_HEADER_SIZE 8
+#define HASH_BUCKET_ARRAY_SIZE ((PAGE_SIZE - HASH_BUCKET_PAGE_HEADER_SIZE) / sizeof(MappingType))
+
+INDEX_TEMPLATE_ARGUMENTS
+class HashTableBucketPage {
+public:
+  // After creating a new bucket page from buffer pool, must call initialize method to set default values
+  void Init(int max_size = HASH_BUCKET_ARRAY_SIZE);
+
+  int GetSize() const { return size_; }
+
+  int GetMaxSize() const { return max_size_; }
+
+  bool IsFull() const { return size_ >= max_size_; }
+
+  bool IsEmpty() const { return size_ == 0; }
+
+  KeyType KeyAt(int index) const;
+
+  ValueType ValueAt(int index) const;
+
+  /**
+   * @return index of the entry with the key, or -1 if there is none
+   */
+  int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
+
+  bool Lookup(const KeyType &key, ValueType &value, const KeyComparator &comparator) const;
+
+  /**
+   * @return false if the bucket is full or holds the key already
+   */
+  bool Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
+
+  /**
+   * @return false if the bucket does not hold the key
+   */
+  bool Remove(const KeyType &key, const KeyComparator &comparator);
+
+  void RemoveAt(int index);
+
+private:
+  int size_;
+  int max_size_;
+  MappingType array_[HASH_BUCKET_ARRAY_SIZE];
+};
+
+#endif  // MINISQL_HASH_TABLE_BUCKET_PAGE_H
@@ -0,0 +1,90 @@
+#ifndef MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+#define MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+#define HASH_DIRECTORY_MAX_DEPTH 9
+#define HASH_DIRECTORY_ARRAY_SIZE (1 << HASH_DIRECTORY_MAX_DEPTH)
+
+/**
+ * hash_table_directory_page.h
+ *
+ * A directory page of an extendible hash table maps the low GlobalDepth bits of a hash to a bucket page. A bucket
+ * with local depth d is shared by the 2^(GlobalDepth - d) slots which agree on the low d bits of their index; the
+ * slot which differs from a slot only in bit d - 1 is its split image.
+ *
+ * Directory page format (size in byte):
+ *  ------------------------------------------------------------------------------------------------
+ * | PageId (4) | GlobalDepth (2) | MaxDepth (2) | LocalDepth(0) (1) | ... | LocalDepth(511) (1) |
+ *  ------------------------------------------------------------------------------------------------
+ *  ------------------------------------------------------
+ * | BucketPageId(0) (4) | ... | BucketPageId(511) (4) |
+ *  ------------------------------------------------------
+ */
+class HashTableDirectoryPage {
+public:
+  // After creating a new directory page from buffer pool, must call initialize method to set default values
+  void Init(page_id_t page_id, uint32_t max_depth = HASH_DIRECTORY_MAX_DEPTH);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  uint32_t HashToBucketIndex(uint32_t hash) const { return hash & GetGlobalDepthMask(); }
+
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const;
+
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
+
+  /**
+   * @return the slot which shares all but the highest of the local depth bits of the bucket at bucket_idx
+   */
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const;
+
+  uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  uint32_t GetMaxDepth() const { return max_depth_; }
+
+  uint32_t GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+  /**
+   * Double the directory, the new upper half of the slots mirrors the lower half
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Halve the directory, only allowed if CanShrink()
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return true if no bucket has a local depth equal to the global depth
+   */
+  bool CanShrink() const;
+
+  /**
+   * @return the number of slots in use, 2^GlobalDepth
+   */
+  uint32_t Size() const { return 1U << global_depth_; }
+
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const;
+
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth);
+
+  /**
+   * Check that every bucket is referenced by exactly the slots its local depth calls for
+   * @return false if the directory is inconsistent
+   */
+  bool VerifyIntegrity() const;
+
+private:
+  page_id_t page_id_;
+  uint16_t global_depth_;
+  uint16_t max_depth_;
+  uint8_t local_depths_[HASH_DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[HASH_DIRECTORY_ARRAY_SIZE];
+};
+
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "Hash table directory page does not fit in a page.");
+
+#endif  // MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
@@ -0,0 +1,70 @@
+#ifndef MINISQL_HASH_TABLE_HEADER_PAGE_H
+#define MINISQL_HASH_TABLE_HEADER_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+#define HASH_HEADER_MAX_DEPTH 9
+#define HASH_HEADER_ARRAY_SIZE (1 << HASH_HEADER_MAX_DEPTH)
+// the header is indexed by the top bits of a hash, directories by the low bits
+#define HASH_HEADER_HASH_SHIFT (32 - HASH_HEADER_MAX_DEPTH)
+
+/**
+ * hash_table_header_page.h
+ *
+ * The header page is the root of an extendible hash table. It is a directory of directory pages, organized the
+ * same way a directory page is a directory of buckets: the header maps GlobalDepth bits from the top of a hash to a
+ * directory page, a directory with local depth d is shared by the slots which agree on the low d of these bits.
+ * A table starts with a single directory, which is split in two once it is full, so that the size of a directory
+ * page does not limit the size of the table.
+ *
+ * Header page format (size in byte):
+ *  ------------------------------------------------------------------------------------------------
+ * | PageId (4) | GlobalDepth (4) | LocalDepth(0) (1) | ... | LocalDepth(511) (1) |
+ *  ------------------------------------------------------------------------------------------------
+ *  ------------------------------------------------------------
+ * | DirectoryPageId(0) (4) | ... | DirectoryPageId(511) (4) |
+ *  ------------------------------------------------------------
+ */
+class HashTableHeaderPage {
+public:
+  // After creating a new header page from buffer pool, must call initialize method to set default values
+  void Init(page_id_t page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  uint32_t HashToDirectoryIndex(uint32_t hash) const { return (hash >> HASH_HEADER_HASH_SHIFT) & GetGlobalDepthMask(); }
+
+  page_id_t GetDirectoryPageId(uint32_t directory_idx) const;
+
+  void SetDirectoryPageId(uint32_t directory_idx, page_id_t directory_page_id);
+
+  uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  uint32_t GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+  /**
+   * Double the header, the new upper half of the slots mirrors the lower half
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * @return the number of slots in use, 2^GlobalDepth
+   */
+  uint32_t Size() const { return 1U << global_depth_; }
+
+  uint32_t GetLocalDepth(uint32_t directory_idx) const;
+
+  void SetLocalDepth(uint32_t directory_idx, uint32_t local_depth);
+
+private:
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[HASH_HEADER_ARRAY_SIZE];
+  page_id_t directory_page_ids_[HASH_HEADER_ARRAY_SIZE];
+};
+
+static_assert(sizeof(HashTableHeaderPage) <= PAGE_SIZE, "Hash table header page does not fit in a page.");
+
+#endif  // MINISQL_HASH_TABLE_HEADER_PAGE_H
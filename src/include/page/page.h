@@ -16,6 +16,7 @@
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManager;
+  friend class BufferPoolManagerInstance;
 
 public:
   DISALLOW_COPY(Page)
@@ -41,15 +42,30 @@ public:
   /** Acquire the page write latch. */
   inline void WLatch() { rwlatch_.WLock(); }
 
+  /** Acquire the page write latch if it is free. @return true if the latch was acquired */
+  inline bool TryWLatch() { return rwlatch_.TryWLock(); }
+
   /** Release the page write latch. */
   inline void WUnlatch() { rwlatch_.WUnlock(); }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
 
+  /** Acquire the page read latch if no writer holds it. @return true if the latch was acquired */
+  inline bool TryRLatch() { return rwlatch_.TryRLock(); }
+
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Start reading the page without latching it, an alternative to RLatch() for short reads.
+   * @return the version to pass to ValidateRLatch() once the read is done
+   */
+  inline uint64_t OptimisticRLatch() { return rwlatch_.OptimisticRead(); }
+
+  /** @return true if the page was not write latched since OptimisticRLatch() returned version */
+  inline bool ValidateRLatch(uint64_t version) { return rwlatch_.Validate(version); }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -76,8 +92,8 @@ private:
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
-  /** Page latch. */
-  ReaderWriterLatch rwlatch_;
+  /** Page latch, the buffer pool manager write latches a frame while it is given to another page. */
+  HybridLatch rwlatch_;
 };
 
 #endif  // MINISQL_PAGE_H
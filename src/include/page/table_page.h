@@ -22,6 +22,7 @@
 #include "common/rowid.h"
 #include "page/page.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 #include "transaction/transaction.h"
@@ -36,6 +37,13 @@ public:
 
   page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
 
+  /**
+   * Read the next page id from raw page data, used by read-ahead
+   */
+  static page_id_t NextPageIdOf(char *page_data) {
+    return *reinterpret_cast<page_id_t *>(page_data + OFFSET_NEXT_PAGE_ID);
+  }
+
   void SetPrevPageId(page_id_t prev_page_id) {
     memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
   }
@@ -57,6 +65,12 @@ public:
 
   bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * Point the view at the tuple in this page, no data is copied
+   * @return false if the tuple does not exist or is deleted
+   */
+  bool GetTupleView(const RowId &rid, const Schema *schema, RowView *view);
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
@@ -113,6 +127,11 @@ private:
 
 public:
   static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
+
+  /**
+   * @return free space a page needs to take a tuple of serialized_size bytes, including its slot
+   */
+  static uint32_t SpaceNeededFor(uint32_t serialized_size) { return serialized_size + SIZE_TUPLE; }
 };
 
 #endif
\ No newline at end of file
@@ -17,6 +17,8 @@ class Field {
 
   friend class TypeFloat;
 
+  friend class KeyEncoding;
+
 public:
   explicit Field(const TypeId type) : type_id_(type), len_(FIELD_NULL_LEN), is_null_(true) {}
 
@@ -84,6 +86,10 @@ public:
     return is_null_;
   }
 
+  inline TypeId GetTypeId() const {
+    return type_id_;
+  }
+
   inline uint32_t GetLength() const {
     return Type::GetInstance(type_id_)->GetLength(*this);
   }
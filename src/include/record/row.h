@@ -27,11 +27,16 @@ public:
    * Row used for insert
    * Field integrity should check by upper level
    */
-  explicit Row(std::vector<Field> &fields) : heap_(new SimpleMemHeap) {
+  explicit Row(std::vector<Field> &fields) : Row(fields, nullptr) {}
+
+  /**
+   * Row whose fields are allocated in the given heap, e.g. a per-query arena, instead of one owned by the row
+   */
+  Row(std::vector<Field> &fields, MemHeap *heap) : heap_(heap != nullptr ? heap : &own_heap_) {
     // deep copy
+    fields_.reserve(fields.size());
     for (auto &field : fields) {
-      void *buf = heap_->Allocate(sizeof(Field));
-      fields_.push_back(new(buf)Field(field));
+      fields_.push_back(CopyField(field));
     }
   }
 
@@ -43,28 +48,21 @@ public:
   /**
    * Row used for deserialize and update
    */
-  Row(RowId rid) : rid_(rid), heap_(new SimpleMemHeap) {}
+  Row(RowId rid) : rid_(rid), heap_(&own_heap_) {}
+
+  Row(RowId rid, MemHeap *heap) : rid_(rid), heap_(heap != nullptr ? heap : &own_heap_) {}
 
   /**
    * Row copy function
    */
-  Row(const Row &other) : heap_(new SimpleMemHeap) {
-    if (!fields_.empty()) {
-      for (auto &field : fields_) {
-        heap_->Free(field);
-      }
-      fields_.clear();
-    }
-    rid_ = other.rid_;
+  Row(const Row &other) : rid_(other.rid_), heap_(&own_heap_) {
+    fields_.reserve(other.fields_.size());
     for (auto &field : other.fields_) {
-      void *buf = heap_->Allocate(sizeof(Field));
-      fields_.push_back(new(buf)Field(*field));
+      fields_.push_back(CopyField(*field));
     }
   }
 
-  virtual ~Row() {
-    delete heap_;
-  }
+  virtual ~Row() = default;
 
   /**
    * Note: Make sure that bytes write to buf is equal to GetSerializedSize()
@@ -93,12 +91,20 @@ public:
 
   inline size_t GetFieldCount() const { return fields_.size(); }
 
+  static constexpr size_t ROW_HEAP_CHUNK_SIZE = 256;
+
 private:
   Row &operator=(const Row &other) = delete;
 
+  /**
+   * Copy a field into the heap of this row, char data included
+   */
+  Field *CopyField(const Field &field);
+
 private:
   RowId rid_{};
-  std::vector<Field *> fields_;   /** Make sure that all fields are created by mem heap */
+  std::vector<Field *> fields_;   /** Make sure that all fields and their data are created by mem heap */
+  ArenaMemHeap own_heap_{ROW_HEAP_CHUNK_SIZE};
   MemHeap *heap_{nullptr};
 };
 
@@ -0,0 +1,100 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include <string>
+
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/schema.h"
+
+/**
+ * RowView reads the fields of a serialized row in place, e.g. straight from a table page, without deserializing it
+ * into a Row. It holds a pointer to the row bytes, so it is only valid as long as the page holding them is resident
+ * and unmodified.
+ *
+ * The row format is the one written by Row::SerializeTo:
+ * | RowId | Null-1 | Field-1 | ... | Null-N | Field-N |
+ * where a null field takes no bytes and a char field is prefixed with its length. The field offsets of a row are
+ * computed once, on first access, into a fixed table.
+ */
+class RowView {
+public:
+  RowView() = default;
+
+  RowView(const char *data, const Schema *schema, const RowId &rid) { Reset(data, schema, rid); }
+
+  /**
+   * The row id is passed in since the one serialized with the row is the id it had before it was inserted
+   */
+  void Reset(const char *data, const Schema *schema, const RowId &rid) {
+    data_ = data;
+    schema_ = schema;
+    rid_ = rid;
+    num_offsets_ = 0;
+  }
+
+  inline bool IsValid() const { return data_ != nullptr; }
+
+  inline RowId GetRowId() const { return rid_; }
+
+  inline uint32_t GetFieldCount() const { return schema_->GetColumnCount(); }
+
+  inline TypeId GetType(uint32_t idx) const { return schema_->GetColumn(idx)->GetType(); }
+
+  inline bool IsNull(uint32_t idx) const { return MACH_READ_FROM(bool, data_ + FieldOffset(idx)); }
+
+  int32_t GetInt(uint32_t idx) const {
+    ASSERT(GetType(idx) == TypeId::kTypeInt, "Not an int field.");
+    return MACH_READ_INT32(data_ + FieldOffset(idx) + sizeof(bool));
+  }
+
+  float GetFloat(uint32_t idx) const {
+    ASSERT(GetType(idx) == TypeId::kTypeFloat, "Not a float field.");
+    return MACH_READ_FROM(float, data_ + FieldOffset(idx) + sizeof(bool));
+  }
+
+  /**
+   * @return the bytes of a char field, which are not null terminated
+   */
+  const char *GetChars(uint32_t idx) const {
+    ASSERT(GetType(idx) == TypeId::kTypeChar, "Not a char field.");
+    return data_ + FieldOffset(idx) + sizeof(bool) + sizeof(uint32_t);
+  }
+
+  uint32_t GetCharLength(uint32_t idx) const {
+    ASSERT(GetType(idx) == TypeId::kTypeChar, "Not a char field.");
+    return MACH_READ_UINT32(data_ + FieldOffset(idx) + sizeof(bool));
+  }
+
+  /**
+   * @return a field which refers to the row bytes instead of owning a copy of them
+   */
+  Field GetField(uint32_t idx) const;
+
+  /**
+   * @return the field as text, the same as Field::GetData of the deserialized field
+   */
+  std::string GetFieldString(uint32_t idx) const;
+
+  /**
+   * @return size of the serialized row
+   */
+  uint32_t GetSerializedSize() const { return FieldOffset(GetFieldCount()); }
+
+private:
+  /**
+   * @return offset of the null flag of a field, or of the end of the row for idx == field count
+   */
+  uint32_t FieldOffset(uint32_t idx) const;
+
+  static constexpr uint32_t MAX_CACHED_OFFSETS = 32;
+
+  const char *data_{nullptr};
+  const Schema *schema_{nullptr};
+  RowId rid_;
+  mutable uint32_t num_offsets_{0};
+  mutable uint16_t offsets_[MAX_CACHED_OFFSETS];
+};
+
+#endif  // MINISQL_ROW_VIEW_H
@@ -2,26 +2,47 @@
 #define DISK_MGR_H
 
 #include <atomic>
-#include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
+#include <vector>
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/io_uring.h"
+
+/**
+ * A page read or write of a batch
+ */
+struct PageIORequest {
+  page_id_t page_id_;
+  char *data_;
+  bool is_write_;
+};
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
  *
+ * Page allocation works on an in-memory copy of the bitmap pages and a summary of the extents which still have free
+ * pages, rebuilt from the meta page at open. Like the meta page, bitmaps are written back on Sync and Close.
+ *
+ * Pages are read and written with positional pread/pwrite on a plain file descriptor, so I/O on different pages
+ * does not serialize. Writes only reach the OS page cache, call Sync to make them durable.
+ *
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
  *      | Page N | Free Page BitMap 2 | Page N+1 | ... | Page 2N | ... |
  */
 class DiskManager {
 public:
-  explicit DiskManager(const std::string &db_file);
+  /**
+   * @param use_async_io set up an io_uring for batched page I/O, falls back to synchronous I/O if unavailable
+   */
+  explicit DiskManager(const std::string &db_file, bool use_async_io = true);
 
   ~DiskManager() {
     if (!closed) {
@@ -41,6 +62,17 @@ public:
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Batched page I/O: submit the requests, keeping up to queue_depth of them in flight, and wait until all of them
+   * completed. Uses io_uring when available and pread/pwrite otherwise.
+   */
+  void BatchPageIO(std::vector<PageIORequest> &requests, size_t queue_depth = DEFAULT_IO_QUEUE_DEPTH);
+
+  /**
+   * @return whether batched I/O goes through io_uring
+   */
+  bool IsAsyncIOEnabled();
+
   /**
    * Get next free page from disk
    * @return logical page id of allocated page
@@ -57,6 +89,11 @@ public:
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * Write back the meta page and force every write issued so far to stable storage
+   */
+  void Sync();
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
@@ -70,6 +107,14 @@ public:
     return meta_data_;
   }
 
+  /**
+   * Number of logical page reads/writes issued so far
+   * Note: Used for statistics and tests
+   */
+  size_t GetNumReads() const { return num_reads_.load(); }
+
+  size_t GetNumWrites() const { return num_writes_.load(); }
+
   static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
 
 private:
@@ -93,13 +138,33 @@ private:
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
+  /**
+   * Get the cached bitmap page of an extent, reading it in on first use. db_io_latch_ must be held
+   */
+  BitmapPage<PAGE_SIZE> *GetBitmap(uint32_t extent_id);
+
+  /**
+   * Write back modified bitmap pages, db_io_latch_ must be held
+   */
+  void FlushBitmaps();
+
 private:
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file
+  int db_fd_{-1};
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
+  // protects the meta page and the bitmap pages, page reads and writes need no latch
   std::recursive_mutex db_io_latch_;
   bool closed{false};
+  // page allocation state, protected by db_io_latch_
+  std::vector<std::unique_ptr<char[]>> bitmaps_;
+  std::vector<bool> bitmap_dirty_;
+  std::set<uint32_t> free_extents_;  // extents which have a free page
+  // ring for batched asynchronous I/O, nullptr if io_uring is unavailable
+  std::unique_ptr<IoUring> io_uring_;
+  // protects io_uring_, a batch holds it while it uses the ring
+  std::mutex io_uring_latch_;
+  std::atomic<size_t> num_reads_{0};
+  std::atomic<size_t> num_writes_{0};
   char meta_data_[PAGE_SIZE];
 };
 
@@ -0,0 +1,78 @@
+#ifndef MINISQL_IO_URING_H
+#define MINISQL_IO_URING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * IoUring is a minimal io_uring submission/completion ring built directly on the io_uring_setup and
+ * io_uring_enter system calls, so no liburing is needed. It only supports plain reads and writes on a file.
+ *
+ * The ring is not thread safe, the owner has to serialize access to it.
+ */
+class IoUring {
+public:
+  /**
+   * Try to set up a ring with the given number of entries, check IsValid afterwards
+   */
+  explicit IoUring(uint32_t entries);
+
+  ~IoUring();
+
+  /**
+   * @return false if the kernel does not support io_uring or the ring could not be set up
+   */
+  bool IsValid() const { return ring_fd_ >= 0; }
+
+  /**
+   * @return number of submission queue entries
+   */
+  uint32_t GetEntries() const { return sq_entries_; }
+
+  /**
+   * Queue a read or write request, it is not handed to the kernel before Submit
+   * @return false if the submission queue is full
+   */
+  bool Prepare(int fd, bool is_write, char *buf, uint32_t len, off_t offset, uint64_t user_data);
+
+  /**
+   * Hand all prepared requests to the kernel and wait until at least min_complete requests completed
+   * @return false on error
+   */
+  bool Submit(uint32_t min_complete);
+
+  /**
+   * Pop one completion if there is any
+   * @param[out] user_data user data of the completed request
+   * @param[out] res result of the request, the number of bytes transferred or -errno
+   * @return false if the completion queue is empty
+   */
+  bool PopCompletion(uint64_t *user_data, int32_t *res);
+
+private:
+  int ring_fd_{-1};
+  void *sq_ptr_{nullptr};
+  void *cq_ptr_{nullptr};
+  size_t sq_ring_size_{0};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  uint32_t sq_entries_{0};
+  // submission queue
+  uint32_t *sq_head_{nullptr};
+  uint32_t *sq_tail_{nullptr};
+  uint32_t *sq_mask_{nullptr};
+  uint32_t *sq_array_{nullptr};
+  uint32_t to_submit_{0};
+  // completion queue
+  uint32_t *cq_head_{nullptr};
+  uint32_t *cq_tail_{nullptr};
+  uint32_t *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+};
+
+#endif  // MINISQL_IO_URING_H
@@ -1,12 +1,21 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "page/free_space_map_page.h"
 #include "page/table_page.h"
 #include "storage/table_iterator.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 
+/**
+ * TableHeap is a doubly linked chain of table pages. A free space map, chained in its own pages, records the free
+ * space of every heap page so that inserts go straight to a page with room or append to the tail.
+ */
 class TableHeap {
   friend class TableIterator;
 
@@ -17,13 +26,17 @@ class TableHeap {
     return new (buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
   }
 
+  /**
+   * @param fsm_page_id first page of the free space map, INVALID_PAGE_ID to rebuild the map from the page chain
+   */
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap) {
+                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap,
+                           page_id_t fsm_page_id = INVALID_PAGE_ID) {
     void *buf = heap->Allocate(sizeof(TableHeap));
     // TablePage *first_page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(first_page_id)->GetData());
     // buffer_pool_manager->UnpinPage(first_page_id);
     // first_page->Init(first_page_id, INVALID_PAGE_ID, log_manager, nullptr);
-    return new (buf) TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+    return new (buf) TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager, fsm_page_id);
   }
 
   ~TableHeap() {
@@ -36,6 +49,7 @@ class TableHeap {
       if(next_id==INVALID_PAGE_ID) break;
       else pre_id = next_id;
     }
+    FreeFreeSpaceMap();
   }
 
   /**
@@ -46,6 +60,15 @@ class TableHeap {
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Insert a batch of tuples. Consecutive tuples are packed into a page while it is pinned once, new pages are
+   * appended for what does not fit into the existing free space.
+   * @param[in/out] rows Tuple rows to insert, the rid of every inserted tuple is wrapped in its row
+   * @param[in] txn The transaction performing the insert
+   * @return true iff all tuples were inserted, on failure the rows before the failing one are inserted
+   */
+  bool InsertTuples(std::vector<Row> &rows, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -91,9 +114,11 @@ class TableHeap {
   void FreeHeap();
 
   /**
+   * @param[in] use_scan_ring if true, the scan recycles a private ring of SCAN_RING_SIZE frames instead of
+   *            pushing the whole table through the shared buffer pool, use it for full table scans
    * @return the begin iterator of this table
    */
-  TableIterator Begin(Transaction *txn);
+  TableIterator Begin(Transaction *txn, bool use_scan_ring = false);
 
   /**
    * @return the end iterator of this table
@@ -105,6 +130,24 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return the id of the first page of the free space map
+   */
+  inline page_id_t GetFreeSpaceMapPageId() const { return fsm_page_id_; }
+
+  /**
+   * @return ids of the heap pages in chain order, read from the free space map instead of the page chain
+   */
+  std::vector<page_id_t> GetPageIds();
+
+  /**
+   * Visit every tuple of the heap pages page_ids[begin, end), e.g. one part of the heap out of several scanned by
+   * different threads. A page is read latched while its tuples are visited, so the views stay valid during the
+   * call. The scan recycles a private ring of frames.
+   */
+  void ScanPages(const std::vector<page_id_t> &page_ids, size_t begin, size_t end,
+                 const std::function<void(const RowView &)> &visit);
+
  private:
   /**
    * create table heap and initialize first page
@@ -114,20 +157,74 @@ class TableHeap {
       : buffer_pool_manager_(buffer_pool_manager),
         schema_(schema),
         log_manager_(log_manager),
-        lock_manager_(lock_manager){
-            // ASSERT(false, "Not implemented yet.");
-        };
+        lock_manager_(lock_manager) {
+    auto *first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_));
+    ASSERT(first_page != nullptr, "No frame for the first table page.");
+    first_page->Init(first_page_id_, INVALID_PAGE_ID, log_manager_, txn);
+    uint32_t free_space = first_page->GetFreeSpaceRemaining();
+    buffer_pool_manager_->UnpinPage(first_page_id_, true);
+    auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(fsm_page_id_)->GetData());
+    map_page->Init();
+    map_page->Append(first_page_id_, FreeSpaceMapPage::ToCategory(free_space));
+    buffer_pool_manager_->UnpinPage(fsm_page_id_, true);
+    LoadFreeSpaceMap();
+  }
 
   /**
    * load existing table heap by first_page_id
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+                     LogManager *log_manager, LockManager *lock_manager, page_id_t fsm_page_id)
       : buffer_pool_manager_(buffer_pool_manager),
         first_page_id_(first_page_id),
         schema_(schema),
         log_manager_(log_manager),
-        lock_manager_(lock_manager) {}
+        lock_manager_(lock_manager),
+        fsm_page_id_(fsm_page_id) {
+    if (fsm_page_id_ == INVALID_PAGE_ID) {
+      BuildFreeSpaceMap();
+    }
+    LoadFreeSpaceMap();
+  }
+
+  /**
+   * Create the free space map by walking the page chain, for heaps which do not have one yet
+   */
+  void BuildFreeSpaceMap();
+
+  /**
+   * Read the free space map chain into the in-memory summary
+   */
+  void LoadFreeSpaceMap();
+
+  /**
+   * Delete the pages of the free space map
+   */
+  void FreeFreeSpaceMap();
+
+  /**
+   * Find a heap page which has at least needed bytes free, the page of the last insert is tried first
+   * @param[out] index entry of the page in the free space map
+   * @return false if no page has enough room
+   */
+  bool FindPageWithSpace(uint32_t needed, uint32_t *index);
+
+  /**
+   * Append a new page to the heap and register it in the free space map
+   * @param[out] index entry of the new page in the free space map
+   * @return false if no page can be allocated
+   */
+  bool AppendPage(Transaction *txn, uint32_t *index);
+
+  /**
+   * @return id of the heap page of an entry of the free space map
+   */
+  page_id_t GetMapEntryPageId(uint32_t index);
+
+  /**
+   * Record the free space of a heap page in the free space map
+   */
+  void UpdateFreeSpace(page_id_t page_id, uint32_t free_bytes);
 
  private:
   BufferPoolManager *buffer_pool_manager_;
@@ -135,6 +232,13 @@ class TableHeap {
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  // free space map
+  page_id_t fsm_page_id_{INVALID_PAGE_ID};
+  std::vector<page_id_t> fsm_pages_;                    // map pages in chain order
+  std::vector<uint8_t> fsm_max_;                        // upper bound of the categories recorded in each map page
+  std::unordered_map<page_id_t, uint32_t> fsm_index_;   // heap page id -> entry in the map
+  uint32_t fsm_count_{0};                               // number of entries, the last one is the tail of the heap
+  uint32_t last_index_{0};                              // entry of the page which took the last insert
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
@@ -1,20 +1,27 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include <memory>
+
+#include "buffer/buffer_ring.h"
 #include "common/rowid.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "transaction/transaction.h"
 
 
 class TableHeap;
+class TablePage;
 
 class TableIterator {
 
 public:
   // you may define your own constructor based on your member variables
-  explicit TableIterator(Row* row_,TableHeap* table_heap_,Transaction* txn);
+  explicit TableIterator(Row* row_,TableHeap* table_heap_,Transaction* txn,
+                         std::shared_ptr<BufferRing> ring = nullptr);
 
   TableIterator(const TableIterator &other);
+  TableIterator &operator=(const TableIterator &other) = delete;
 
   virtual ~TableIterator();
    
@@ -26,15 +33,47 @@ public:
 
   Row *operator->();
 
+  /**
+   * View of the current tuple in its page, which avoids deserializing it. Prefer it on hot paths which only look at
+   * a few fields, the view is valid until the iterator moves: the iterator keeps the page it is on pinned.
+   * The view is not valid (RowView::IsValid) if the tuple was deleted after the iterator reached it, check it first.
+   */
+  const RowView &View();
+
+  /**
+   * @return row id of the current tuple
+   */
+  RowId GetRowId() const { return content->GetRowId(); }
+
   TableIterator &operator++();
 
   TableIterator operator++(int);
 
+private:
+  /**
+   * Deserialize the current tuple into content
+   */
+  void Load();
+
+  /**
+   * Pin the page of the current tuple if the iterator does not hold it yet
+   */
+  TablePage *CurrentPage();
+
 private:
   // add your own private member variables here
   Row* content;
   TableHeap* table_heap_;
   Transaction *txn_;
+  // ring of frames recycled by a sequential scan, shared by copies of the iterator
+  std::shared_ptr<BufferRing> ring_;
+  // number of page boundaries crossed, read-ahead starts once the scan is known to be sequential
+  uint32_t pages_crossed_{0};
+  // the tuple is only deserialized into content when the row itself is asked for
+  bool loaded_{true};
+  RowView view_;
+  // page of the current tuple, pinned from the first time it is read until the iterator leaves it
+  TablePage *page_{nullptr};
 };
 
 #endif //MINISQL_TABLE_ITERATOR_H
@@ -0,0 +1,168 @@
+#ifndef MINISQL_EXTERNAL_SORTER_H
+#define MINISQL_EXTERNAL_SORTER_H
+
+#include <algorithm>
+#include <cstdio>
+#include <type_traits>
+#include <vector>
+
+/**
+ * ExternalSorter sorts more items than fit in memory. Added items are buffered up to memory_limit bytes; a full
+ * buffer is sorted and spilled to a temporary file as a sorted run. Sort() sorts what is left in the buffer and, if
+ * runs were spilled, merges them all, after which Next() returns the items in ascending order.
+ *
+ * Items are written to the run files as raw bytes, so they have to be trivially copyable.
+ */
+template <typename T, typename Compare>
+class ExternalSorter {
+  static_assert(std::is_trivially_copyable<T>::value, "Sorted items are spilled as raw bytes.");
+
+public:
+  ExternalSorter(Compare compare, size_t memory_limit)
+      : compare_(compare), max_buffered_(std::max<size_t>(memory_limit / sizeof(T), MIN_BUFFERED_ITEMS)) {}
+
+  ~ExternalSorter() {
+    for (auto &run : runs_) {
+      fclose(run.file);
+    }
+  }
+
+  /**
+   * @return false if the buffer was full and could not be spilled
+   */
+  bool Add(const T &item) {
+    if (buffer_.size() == max_buffered_ && !Spill()) {
+      return false;
+    }
+    buffer_.push_back(item);
+    count_++;
+    return true;
+  }
+
+  /**
+   * Finish the input and prepare to return the items in order
+   * @return false if a run could not be spilled or read back
+   */
+  bool Sort() {
+    if (runs_.empty()) {
+      std::sort(buffer_.begin(), buffer_.end(), compare_);
+      return true;
+    }
+    if (!buffer_.empty() && !Spill()) {
+      return false;
+    }
+    std::vector<T>().swap(buffer_);
+    // split the memory budget among the run read buffers
+    size_t run_buffer_size = std::max<size_t>(max_buffered_ / runs_.size(), MIN_BUFFERED_ITEMS);
+    for (size_t i = 0; i < runs_.size(); i++) {
+      rewind(runs_[i].file);
+      runs_[i].buffer_size = run_buffer_size;
+      if (!Fill(runs_[i])) {
+        return false;
+      }
+      if (!runs_[i].buffer.empty()) {
+        heap_.push_back(i);
+      }
+    }
+    std::make_heap(heap_.begin(), heap_.end(), HeapCompare{this});
+    return true;
+  }
+
+  /**
+   * @return false once all items have been returned
+   */
+  bool Next(T &item) {
+    if (runs_.empty()) {
+      if (next_ == buffer_.size()) {
+        return false;
+      }
+      item = buffer_[next_++];
+      return true;
+    }
+    if (heap_.empty() || failed_) {
+      return false;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), HeapCompare{this});
+    Run &run = runs_[heap_.back()];
+    item = run.buffer[run.next++];
+    if (run.next == run.buffer.size()) {
+      if (!Fill(run)) {
+        failed_ = true;
+      }
+      if (run.buffer.empty()) {
+        heap_.pop_back();
+        return true;
+      }
+    }
+    std::push_heap(heap_.begin(), heap_.end(), HeapCompare{this});
+    return true;
+  }
+
+  /**
+   * @return true if reading a run back failed, in which case Next() stopped early
+   */
+  bool HasFailed() const { return failed_; }
+
+  /**
+   * @return number of items added
+   */
+  size_t GetCount() const { return count_; }
+
+  /**
+   * @return number of sorted runs spilled to disk
+   */
+  size_t GetRunCount() const { return runs_.size(); }
+
+private:
+  static constexpr size_t MIN_BUFFERED_ITEMS = 64;
+
+  struct Run {
+    FILE *file;
+    std::vector<T> buffer;
+    size_t buffer_size;
+    size_t next;
+  };
+
+  // orders run ids so that the run with the smallest current item is on top of the heap
+  struct HeapCompare {
+    bool operator()(size_t a, size_t b) const {
+      const Run &run_a = sorter->runs_[a];
+      const Run &run_b = sorter->runs_[b];
+      return sorter->compare_(run_b.buffer[run_b.next], run_a.buffer[run_a.next]);
+    }
+    ExternalSorter *sorter;
+  };
+
+  bool Spill() {
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+      return false;
+    }
+    runs_.push_back(Run{file, {}, 0, 0});
+    std::sort(buffer_.begin(), buffer_.end(), compare_);
+    size_t size = buffer_.size();
+    size_t written = fwrite(buffer_.data(), sizeof(T), size, file);
+    buffer_.clear();
+    return written == size;
+  }
+
+  // read the next items of a run into its buffer, which is left empty at the end of the run
+  bool Fill(Run &run) {
+    run.buffer.resize(run.buffer_size);
+    size_t read = fread(run.buffer.data(), sizeof(T), run.buffer_size, run.file);
+    run.buffer.resize(read);
+    run.next = 0;
+    return !ferror(run.file);
+  }
+
+  Compare compare_;
+  size_t max_buffered_;
+  std::vector<T> buffer_;
+  size_t next_{0};
+  size_t count_{0};
+  std::vector<Run> runs_;
+  std::vector<size_t> heap_;
+  bool failed_{false};
+};
+
+#endif  // MINISQL_EXTERNAL_SORTER_H
@@ -1,9 +1,11 @@
 #ifndef MINISQL_MEM_HEAP_H
 #define MINISQL_MEM_HEAP_H
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <unordered_set>
+#include <vector>
 #include "common/macros.h"
 
 class MemHeap {
@@ -37,6 +39,7 @@ public:
     void *buf = malloc(size);
     ASSERT(buf != nullptr, "Out of memory exception");
     allocated_.insert(buf);
+    num_allocations_++;
     return buf;
   }
 
@@ -47,11 +50,103 @@ public:
     auto iter = allocated_.find(ptr);
     if (iter != allocated_.end()) {
       allocated_.erase(iter);
+      free(ptr);
     }
   }
 
+  /**
+   * @return number of blocks requested from the system so far
+   */
+  size_t GetNumAllocations() const { return num_allocations_; }
+
 private:
   std::unordered_set<void *> allocated_;
+  size_t num_allocations_{0};
+};
+
+/**
+ * Bump pointer heap. Allocations are carved out of large chunks, Free is a no-op and all memory is given back at
+ * once by Reset or when the heap is destroyed, so objects allocated here must not own resources of their own.
+ * Chunks double in size from the initial chunk size up to MAX_CHUNK_SIZE, a larger request gets a chunk of its own.
+ */
+class ArenaMemHeap : public MemHeap {
+public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 4096;
+  static constexpr size_t MAX_CHUNK_SIZE = 1 << 20;
+
+  explicit ArenaMemHeap(size_t initial_chunk_size = DEFAULT_CHUNK_SIZE) : next_chunk_size_(initial_chunk_size) {}
+
+  ArenaMemHeap(const ArenaMemHeap &other) = delete;
+
+  ArenaMemHeap &operator=(const ArenaMemHeap &other) = delete;
+
+  ~ArenaMemHeap() {
+    for (auto &chunk : chunks_) {
+      free(chunk.data_);
+    }
+  }
+
+  void *Allocate(size_t size) override {
+    // zero sized requests still get a distinct, non-null address
+    size = size == 0 ? ALIGNMENT : (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (size > static_cast<size_t>(end_ - cur_)) {
+      NewChunk(size);
+    }
+    void *buf = cur_;
+    cur_ += size;
+    return buf;
+  }
+
+  void Free(void *) override {}
+
+  /**
+   * Release all allocations. The last, and largest, chunk is kept for reuse, so a heap which is reset after every
+   * unit of work stops allocating once it has grown to fit one.
+   */
+  void Reset() {
+    if (chunks_.empty()) {
+      return;
+    }
+    for (size_t i = 0; i + 1 < chunks_.size(); i++) {
+      free(chunks_[i].data_);
+    }
+    chunks_.front() = chunks_.back();
+    chunks_.resize(1);
+    cur_ = chunks_.front().data_;
+    end_ = cur_ + chunks_.front().size_;
+  }
+
+  /**
+   * @return number of chunks requested from the system so far
+   */
+  size_t GetNumAllocations() const { return num_allocations_; }
+
+private:
+  static constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+
+  struct Chunk {
+    char *data_;
+    size_t size_;
+  };
+
+  void NewChunk(size_t min_size) {
+    size_t size = next_chunk_size_ < min_size ? min_size : next_chunk_size_;
+    if (next_chunk_size_ < MAX_CHUNK_SIZE) {
+      next_chunk_size_ *= 2;
+    }
+    char *data = static_cast<char *>(malloc(size));
+    ASSERT(data != nullptr, "Out of memory exception");
+    chunks_.push_back({data, size});
+    num_allocations_++;
+    cur_ = data;
+    end_ = data + size;
+  }
+
+  std::vector<Chunk> chunks_;
+  char *cur_{nullptr};
+  char *end_{nullptr};
+  size_t next_chunk_size_;
+  size_t num_allocations_{0};
 };
 
 #endif //MINISQL_MEM_HEAP_H
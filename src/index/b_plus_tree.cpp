@@ -1,6 +1,8 @@
 #include "index/b_plus_tree.h"
+#include <algorithm>
 #include <string>
 #include   <unordered_map>
+#include <type_traits>
 #include "glog/logging.h"
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
@@ -15,19 +17,30 @@ BPLUSTREE_TYPE::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_ma
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size) {
   IndexRootsPage* index_root_page = reinterpret_cast<IndexRootsPage*>(buffer_pool_manager->FetchPage(INDEX_ROOTS_PAGE_ID));
-  buffer_pool_manager->UnpinPage(INDEX_ROOTS_PAGE_ID);
   if(!index_root_page->GetRootId(this->index_id_,&this->root_page_id_)){
     this->root_page_id_ = INVALID_PAGE_ID;
   }
-  // this->first_page_id_ = INVALID_PAGE_ID;
+  buffer_pool_manager->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+  // the leftmost leaf, where iterators start, is found again when a tree is loaded
+  this->first_page_id_ = this->root_page_id_;
+  while (this->first_page_id_ != INVALID_PAGE_ID) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(this->first_page_id_)->GetData());
+    bool is_leaf = node->IsLeafPage();
+    page_id_t child_page_id = is_leaf ? INVALID_PAGE_ID : reinterpret_cast<InternalPage *>(node)->ValueAt(0);
+    buffer_pool_manager->UnpinPage(this->first_page_id_, false);
+    if (is_leaf) {
+      break;
+    }
+    this->first_page_id_ = child_page_id;
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Destroy() {
   // delete in the root page
   IndexRootsPage* root_page_index_ = reinterpret_cast<IndexRootsPage*>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
-  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID);
   root_page_index_->Delete(this->index_id_);
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID);
   // delete tree
   if(this->root_page_id_==INVALID_PAGE_ID) return;
   BPlusTreePage* tree_page_ = reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(this->root_page_id_)->GetData());
@@ -55,32 +68,72 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return (this->root_page_id_ == INVALID_PA
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction) {
-  ValueType temp;
-  if (IsEmpty()) return false;
-  BPlusTreePage *root_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData() );
-  bool is_leaf = root_page->IsLeafPage();
-  if (is_leaf) {
-    bool res = reinterpret_cast<LeafPage *>(root_page)->Lookup(key, temp, comparator_);
-    buffer_pool_manager_->UnpinPage(root_page_id_);
-    result.push_back(temp);
-    return res;
-  } else {
-    BPlusTreePage *temp_internal_page = reinterpret_cast<BPlusTreePage *>(root_page);
-    // find the leaf
-    while (!temp_internal_page->IsLeafPage()) {
-      buffer_pool_manager_->UnpinPage(temp_internal_page->GetPageId());
-      auto temp = reinterpret_cast<InternalPage*>(temp_internal_page);
-      int child_index = temp->KeyIndex(key, comparator_);
-      temp_internal_page = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE_TYPE *>(
-          buffer_pool_manager_->FetchPage(temp->ValueAt(child_index))->GetData() );
+  static constexpr int MAX_OPTIMISTIC_ATTEMPTS = 4;
+  for (int i = 0; i < MAX_OPTIMISTIC_ATTEMPTS; i++) {
+    ValueType value;
+    bool found;
+    if (GetValueOptimistic(key, value, found)) {
+      if (found) {
+        result.push_back(value);
+      }
+      return found;
     }
-    // find leaf
-    LeafPage *res_leaf = reinterpret_cast<LeafPage *>(temp_internal_page);
-    bool res = res_leaf->Lookup(key, temp, comparator_);
-    result.push_back(temp);
-    buffer_pool_manager_->UnpinPage(res_leaf->GetPageId());
-    return res;
   }
+  // too much contention, fall back to read latches
+  std::vector<Page *> latched;
+  Page *page = FindLeafLatched(key, Operation::kFind, true, latched);
+  if (page == nullptr) {
+    return false;
+  }
+  ValueType value;
+  bool res = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, value, comparator_);
+  ReleaseLatches(latched, false);
+  if (res) {
+    result.push_back(value);
+  }
+  return res;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetRange(const KeyType &lower, const KeyType &upper, std::vector<ValueType> &result,
+                              Transaction *transaction) {
+  size_t count = result.size();
+  // the scan goes on after from, or at from if it is not past yet
+  KeyType from = lower;
+  bool past = false;
+  std::vector<Page *> latched;
+  Page *page = FindLeafLatched(from, Operation::kFind, true, latched);
+  while (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    int i = leaf->LowerBound(from, comparator_);
+    if (past && i < leaf->GetSize() && comparator_(leaf->KeyAt(i), from) == 0) {
+      i++;
+    }
+    for (; i < leaf->GetSize(); i++) {
+      if (comparator_(leaf->KeyAt(i), upper) > 0) {
+        ReleaseLatches(latched, false);
+        return result.size() > count;
+      }
+      result.push_back(leaf->ValueAt(i));
+      from = leaf->KeyAt(i);
+      past = true;
+    }
+    page_id_t next_page_id = leaf->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    Page *next_page = TryFetchRLatched(next_page_id);
+    ReleaseLatches(latched, false);
+    if (next_page != nullptr) {
+      latched.push_back(next_page);
+      page = next_page;
+      continue;
+    }
+    std::this_thread::yield();
+    page = FindLeafLatched(from, Operation::kFind, true, latched);
+  }
+  ReleaseLatches(latched, false);
+  return result.size() > count;
 }
 
 /*****************************************************************************
@@ -95,102 +148,219 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  if (this->root_page_id_ == INVALID_PAGE_ID) {
-    LeafPage *root_leaf_page =
-        reinterpret_cast<LeafPage *>(buffer_pool_manager_->NewPage(this->root_page_id_)->GetData() );
-    root_leaf_page->Init(root_page_id_);
-    this->first_page_id_ = root_page_id_;
-    root_leaf_page->Insert(key, value, comparator_);
-    // success
-    buffer_pool_manager_->UnpinPage(this->root_page_id_);
-    // update root page
-    UpdateRootPageId();
-    return true;
-  } else
-    return InsertIntoLeaf(key, value);
+  std::vector<Page *> latched;
+  // optimistic: most inserts neither split the leaf nor change the root
+  Page *page = FindLeafLatched(key, Operation::kInsert, true, latched);
+  if (page != nullptr) {
+    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    if (leaf_page->KeyIndex(key, comparator_) != leaf_page->GetSize()) {
+      ReleaseLatches(latched, true);
+      return false;
+    }
+    if (IsSafe(leaf_page, Operation::kInsert)) {
+      leaf_page->Insert(key, value, comparator_);
+      ReleaseLatches(latched, true);
+      return true;
+    }
+    ReleaseLatches(latched, true);
+  }
+  // the leaf may split, start over holding write latches on every page which may change
+  page = FindLeafLatched(key, Operation::kInsert, false, latched);
+  bool res = true;
+  if (page == nullptr) {
+    StartNewTree(key, value);
+  } else {
+    res = InsertIntoLeaf(reinterpret_cast<LeafPage *>(page->GetData()), key, value, transaction);
+  }
+  ReleaseLatches(latched, true);
+  return res;
 }
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
+ * root_latch_ is held exclusively by the caller.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  LeafPage *root_leaf_page = reinterpret_cast<LeafPage *>(buffer_pool_manager_->NewPage(root_page_id_)->GetData());
+  root_leaf_page->Init(root_page_id_);
+  first_page_id_ = root_page_id_;
+  root_leaf_page->Insert(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(root_page_id_);
+  UpdateRootPageId();
+}
+
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Entries are appended to the rightmost leaf. Once a page of any level holds its share of the entries of the level, a
+ * new page is started and the full one is added to the level above, which is started with its second page. The
+ * number of pages of a level is fixed when its first page is created, so every page, the last one included, ends up
+ * between half full and full.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(size_t count, const std::function<bool(KeyType &, ValueType &)> &next,
+                              double fill_factor) {
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    root_latch_.WUnlock();
+    return false;
+  }
+  if (count == 0) {
+    root_latch_.WUnlock();
+    return true;
+  }
+  std::vector<BulkLevel> levels(1);
+  levels[0].entries = count;
+  std::vector<page_id_t> created;
+  KeyType key;
+  KeyType prev_key{};
+  ValueType value;
+  bool sorted = true;
+  for (size_t i = 0; i < count; i++) {
+    if (!next(key, value) || (i > 0 && comparator_(prev_key, key) >= 0)) {
+      sorted = false;
+      break;
+    }
+    Page *page = BulkPageFor(levels, 0, key, fill_factor, created);
+    reinterpret_cast<LeafPage *>(page->GetData())->Insert(key, value, comparator_);
+    levels[0].filled++;
+    prev_key = key;
+  }
+  if (!sorted) {
+    for (auto &level : levels) {
+      if (level.page != nullptr) {
+        buffer_pool_manager_->UnpinPage(level.page->GetPageId());
+      }
+    }
+    for (auto page_id : created) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    root_latch_.WUnlock();
+    return false;
+  }
+  // finish the last page of every level, the top level has a single page, the root
+  page_id_t root_page_id = INVALID_PAGE_ID;
+  for (size_t level = 0; level < levels.size(); level++) {
+    ASSERT(levels[level].page_count == levels[level].pages, "Bulk load left pages unfilled.");
+    root_page_id = levels[level].page->GetPageId();
+    KeyType first_key = levels[level].first_key;
+    BulkFinishPage(levels, level, levels[level].page, first_key, fill_factor, created);
+  }
+  root_page_id_ = root_page_id;
+  first_page_id_ = created.front();
+  UpdateRootPageId();
+  root_latch_.WUnlock();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::BulkPageFor(std::vector<BulkLevel> &levels, size_t level, const KeyType &key,
+                                  double fill_factor, std::vector<page_id_t> &created) {
+  if (level == levels.size()) {
+    // the entries of a level are the pages of the level below
+    levels.emplace_back();
+    levels[level].entries = levels[level - 1].pages;
+  }
+  if (levels[level].page != nullptr && levels[level].filled < levels[level].page_entries) {
+    return levels[level].page;
+  }
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  ASSERT(page != nullptr, "Out of memory.");
+  created.push_back(page_id);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  size_t min_entries;
+  size_t max_entries;
+  if (level == 0) {
+    reinterpret_cast<LeafPage *>(node)->Init(page_id);
+    // a leaf splits as soon as it is full
+    min_entries = node->GetMaxSize() / 2;
+    max_entries = node->GetMaxSize() - 1;
+  } else {
+    reinterpret_cast<InternalPage *>(node)->Init(page_id);
+    // the entries of an internal page are its children, one more than its keys
+    min_entries = node->GetMaxSize() / 2;
+    max_entries = node->GetMaxSize();
+  }
+  BulkLevel &state = levels[level];
+  if (state.pages == 0) {
+    size_t target = std::clamp(static_cast<size_t>(fill_factor * max_entries), min_entries, max_entries);
+    state.pages = (state.entries + target - 1) / target;
+    while (state.pages > 1 && state.entries / state.pages < min_entries) {
+      state.pages--;
+    }
+  }
+  state.page_entries = state.entries / state.pages + (state.page_count < state.entries % state.pages ? 1 : 0);
+  state.page_count++;
+  state.filled = 0;
+  Page *full_page = state.page;
+  KeyType full_first_key = state.first_key;
+  state.page = page;
+  state.first_key = key;
+  if (full_page != nullptr) {
+    if (level == 0) {
+      reinterpret_cast<LeafPage *>(full_page->GetData())->SetNextPageId(page_id);
+      reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(full_page->GetPageId());
+    }
+    BulkFinishPage(levels, level, full_page, full_first_key, fill_factor, created);
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::BulkAppendChild(std::vector<BulkLevel> &levels, size_t level, const KeyType &key,
+                                          page_id_t child, double fill_factor, std::vector<page_id_t> &created) {
+  Page *page = BulkPageFor(levels, level, key, fill_factor, created);
+  auto *node = reinterpret_cast<InternalPage *>(page->GetData());
+  if (levels[level].filled == 0) {
+    node->SetValueAt(0, child);
+  } else {
+    node->SetKeyAt(node->GetSize(), key);
+    node->SetValueAt(node->GetSize() + 1, child);
+    node->IncreaseSize(1);
+  }
+  levels[level].filled++;
+  return page->GetPageId();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkFinishPage(std::vector<BulkLevel> &levels, size_t level, Page *page,
+                                    const KeyType &first_key, double fill_factor, std::vector<page_id_t> &created) {
+  page_id_t parent_page_id = INVALID_PAGE_ID;
+  if (levels[level].pages > 1) {
+    parent_page_id = BulkAppendChild(levels, level + 1, first_key, page->GetPageId(), fill_factor, created);
+  }
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(parent_page_id);
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
- * User needs to first find the right leaf page as insertion target, then look
+ * The leaf page and all of its ancestors which may change are write latched by the caller. Look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immediately, otherwise insert entry. Remember to deal with split if necessary.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  // find the leaf by iterate
-  // int i;
-  int new_page_id;
-  BPlusTreePage* btree_page = reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(root_page_id_));
-  bool is_root_leaf = btree_page->IsLeafPage();
-  if (is_root_leaf) {
-    // leaf page, insert immediately
-
-    // check if exist
-    LeafPage *root_leaf_page = reinterpret_cast<LeafPage *>(btree_page);
-    
-    if (root_leaf_page->KeyIndex(key, comparator_) != root_leaf_page->GetSize()) {
-      // already exist
-      buffer_pool_manager_->UnpinPage(root_leaf_page->GetPageId());
-      return false;
-    }
-    if (root_leaf_page->Insert(key, value, comparator_) >= root_leaf_page->GetMaxSize()) {
-      // need to split
-      KeyType temp;
-      LeafPage *new_leaf_page = Split<LeafPage>(root_leaf_page, temp);
-      InternalPage *new_root_page = reinterpret_cast<InternalPage*>(buffer_pool_manager_->NewPage(new_page_id) ->GetData());
-      new_root_page->Init(new_page_id);
-      this->root_page_id_ = new_page_id;
-      new_leaf_page->SetParentPageId(new_page_id);
-      root_leaf_page->SetParentPageId(new_page_id);
-      // new_root_page->InsertNodeAfter(INVALID_PAGE_ID, root_leaf_page->KeyAt(0),root_leaf_page->GetPageId());
-      new_root_page->SetValueAt(0, root_leaf_page->GetPageId());
-      new_root_page->InsertNodeAfter(root_leaf_page->GetPageId(), new_leaf_page->KeyAt(0), new_leaf_page->GetPageId());
-      // this->InsertIntoParent(root_leaf_page, new_leaf_page->KeyAt(0),new_leaf_page);
-      //  end insert unpin
-      buffer_pool_manager_->UnpinPage(root_page_id_, true);
-      buffer_pool_manager_->UnpinPage(root_leaf_page->GetPageId(), true);
-      buffer_pool_manager_->UnpinPage(new_leaf_page->GetPageId(), true);
-
-      // update root page id
-      UpdateRootPageId();
-    }
-    return true;
+bool BPLUSTREE_TYPE::InsertIntoLeaf(LeafPage *leaf_page, const KeyType &key, const ValueType &value,
+                                    Transaction *transaction) {
+  if (leaf_page->KeyIndex(key, comparator_) != leaf_page->GetSize()) {
+    // already exist
+    return false;
   }
-  // then consider the root is internal page, we have to first find the leaf.
-  BPlusTreePage *temp_ptr_internal = reinterpret_cast<BPlusTreePage*>(btree_page);
-  while (!temp_ptr_internal->IsLeafPage()) {
-    // find child page index
-    auto temp = reinterpret_cast<InternalPage*>(temp_ptr_internal);
-    int key_index = temp->KeyIndex(key, comparator_);
-    buffer_pool_manager_->UnpinPage(temp_ptr_internal->GetPageId());
-    temp_ptr_internal = reinterpret_cast<BPlusTreePage *>(
-        buffer_pool_manager_->FetchPage(temp->ValueAt(key_index))->GetData() );
-  }
-  // find the leaf
-  LeafPage *leaf_page_ = reinterpret_cast<LeafPage *>(temp_ptr_internal);
-  // insert to the leaf
-  if (leaf_page_->Insert(key, value, comparator_) >= leaf_page_->GetMaxSize()) {
+  if (leaf_page->Insert(key, value, comparator_) >= leaf_page->GetMaxSize()) {
     // the leaf if full, split
-    KeyType temp;
-    LeafPage *new_leaf_ = Split<LeafPage>(leaf_page_, temp);
-    // insert to parent
-    InsertIntoParent(leaf_page_,new_leaf_->KeyAt(0),new_leaf_);
-
-    buffer_pool_manager_->UnpinPage(new_leaf_->GetPageId());
+    KeyType middle_key;
+    LeafPage *new_leaf_page = Split<LeafPage>(leaf_page, middle_key);
+    LinkNextLeafBack(new_leaf_page);
+    InsertIntoParent(leaf_page, new_leaf_page->KeyAt(0), new_leaf_page);
+    buffer_pool_manager_->UnpinPage(new_leaf_page->GetPageId());
   }
-  // insert successful
-  buffer_pool_manager_->UnpinPage(leaf_page_->GetPageId());
   return true;
 }
 
@@ -235,38 +405,29 @@ N *BPLUSTREE_TYPE::Split(N *node, KeyType &middle_key) {
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                                       Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    // need to generate new root
+    page_id_t new_root_id;
+    InternalPage *new_root_page = reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(new_root_id)->GetData());
+    new_root_page->Init(new_root_id);
+    new_root_page->SetValueAt(0, old_node->GetPageId());
+    new_root_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+    old_node->SetParentPageId(new_root_id);
+    new_node->SetParentPageId(new_root_id);
+    buffer_pool_manager_->UnpinPage(new_root_id);
+    root_page_id_ = new_root_id;
+    UpdateRootPageId();
+    return;
+  }
   InternalPage *parent_page =
-      reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(old_node->GetParentPageId())->GetData() );
-
+      reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(old_node->GetParentPageId())->GetData());
   // insert middle key to parent node
   new_node->SetParentPageId(parent_page->GetPageId());
   if (parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId()) >= parent_page->GetMaxSize()) {
     // internal node full after insert, need to split
     KeyType middle_key;
     InternalPage *new_internal_page = Split<InternalPage>(parent_page, middle_key);
-    if (parent_page->IsRootPage()) {
-      // need to generate new root
-      int new_root_id;
-      // new root
-      InternalPage *new_root_internal =
-          reinterpret_cast<InternalPage *>(buffer_pool_manager_->NewPage(new_root_id)->GetData() );
-      new_root_internal->Init(new_root_id);
-      this->root_page_id_ = new_root_id;
-      parent_page->SetParentPageId(new_root_id);
-      new_internal_page->SetParentPageId(new_root_id);
-
-      new_root_internal->SetValueAt(0, parent_page->GetPageId());
-      new_root_internal->InsertNodeAfter(parent_page->GetPageId(), middle_key, new_internal_page->GetPageId());
-      buffer_pool_manager_->UnpinPage(new_root_id);
-      buffer_pool_manager_->UnpinPage(new_internal_page->GetPageId());
-
-      UpdateRootPageId();
-      // end
-    } else {
-      InsertIntoParent(parent_page, middle_key, new_internal_page);
-    }
-
-    // InsertIntoParent(parent_page, new_internal_page->KeyAt(0),new_internal_page);
+    InsertIntoParent(parent_page, middle_key, new_internal_page);
     buffer_pool_manager_->UnpinPage(new_internal_page->GetPageId());
   }
   // success
@@ -326,44 +487,43 @@ void BPLUSTREE_TYPE::CheckDeletedPageInTree(BPlusTree& tree)const{
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
-  // check if empty
-  if (IsEmpty()) return;
-  // need to find the leaf contain the key
-  
-  BPlusTreePage *temp_internal_ptr =
-      reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(this->root_page_id_)->GetData() );
-
-  int child_index;
-  while (!temp_internal_ptr->IsLeafPage()) {
-    // unpin this page
-    
-    // seek for child
-    InternalPage* temp = reinterpret_cast<InternalPage*>(temp_internal_ptr);
-    child_index = temp->KeyIndex(key, comparator_);
-    buffer_pool_manager_->UnpinPage(temp_internal_ptr->GetPageId());
-    temp_internal_ptr = reinterpret_cast<BPlusTreePage *>(
-        buffer_pool_manager_->FetchPage(temp->ValueAt(child_index))->GetData() );
-  }
-  // find leaf
-  LeafPage *target_leaf = reinterpret_cast<LeafPage *>(temp_internal_ptr);
-  int size_after_remove = target_leaf->RemoveAndDeleteRecord(key, comparator_);
-
-  if (target_leaf->IsRootPage() && size_after_remove == 0) {
-    // delete to a empty tree
-    buffer_pool_manager_->UnpinPage(this->root_page_id_);
-    buffer_pool_manager_->DeletePage(this->root_page_id_);
-    this->root_page_id_ = INVALID_PAGE_ID;
-    UpdateRootPageId();
+  std::vector<Page *> latched;
+  // optimistic: most removes leave the leaf above its min size
+  Page *page = FindLeafLatched(key, Operation::kRemove, true, latched);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  if (leaf_page->KeyIndex(key, comparator_) == leaf_page->GetSize() || IsSafe(leaf_page, Operation::kRemove)) {
+    leaf_page->RemoveAndDeleteRecord(key, comparator_);
+    ReleaseLatches(latched, true);
     return;
   }
-  // leaf node no root
-  if (size_after_remove >= target_leaf->GetMinSize()){ 
-    buffer_pool_manager_->UnpinPage(target_leaf->GetPageId());
+  ReleaseLatches(latched, true);
+  // the leaf may underflow, start over holding write latches on every page which may change
+  page = FindLeafLatched(key, Operation::kRemove, false, latched);
+  if (page == nullptr) {
+    ReleaseLatches(latched, true);
     return;
   }
-  // now consider the node need redistribute or coalesce
-  CoalesceOrRedistribute<LeafPage>(target_leaf);
-  buffer_pool_manager_->UnpinPage(target_leaf->GetPageId());
+  leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  std::vector<page_id_t> deleted;
+  int size_after_remove = leaf_page->RemoveAndDeleteRecord(key, comparator_);
+  if (leaf_page->IsRootPage()) {
+    if (size_after_remove == 0) {
+      // delete to a empty tree
+      deleted.push_back(root_page_id_);
+      root_page_id_ = INVALID_PAGE_ID;
+      UpdateRootPageId();
+    }
+  } else if (size_after_remove < leaf_page->GetMinSize()) {
+    CoalesceOrRedistribute<LeafPage>(leaf_page, latched, deleted, transaction);
+  }
+  ReleaseLatches(latched, true);
+  // merged pages are unreachable now, nobody else holds them
+  for (auto page_id : deleted) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
 }
 
 /*
@@ -386,71 +546,49 @@ bool BPLUSTREE_TYPE::isDistinct(N* node) {
 }
  INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, std::vector<Page *> &latched, std::vector<page_id_t> &deleted,
+                                            Transaction *transaction) {
   if (node->IsRootPage()) {
-    // update root
-    int old_root_id = this->root_page_id_;
-    this->root_page_id_ = node->RemoveAndReturnOnlyChild();
-    assert(old_root_id!=root_page_id_);
-    BPlusTreePage* temp_tree = reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData() );
-    temp_tree->SetParentPageId(INVALID_PAGE_ID);
+    // the root is left with a single child, which becomes the new root
+    deleted.push_back(root_page_id_);
+    root_page_id_ = node->RemoveAndReturnOnlyChild();
+    BPlusTreePage *new_root_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
+    new_root_page->SetParentPageId(INVALID_PAGE_ID);
     buffer_pool_manager_->UnpinPage(root_page_id_);
-    buffer_pool_manager_->UnpinPage(old_root_id);
-    buffer_pool_manager_->DeletePage(old_root_id);
-    this->UpdateRootPageId();
-    return false;
+    UpdateRootPageId();
+    return true;
   }
-
   InternalPage *parent_page =
-      reinterpret_cast<InternalPage*>(reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData()));
+      reinterpret_cast<InternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId())->GetData());
   int index = parent_page->ValueIndex(node->GetPageId());
-  N *sibling_page;
-
-  if (index == 0)
-    sibling_page = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(parent_page->ValueAt(1))->GetData() );
-  
-  else
-    sibling_page = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(parent_page->ValueAt(index - 1))->GetData() );
-  assert(sibling_page->GetParentPageId()==node->GetParentPageId());
+  // the sibling may still be latched by someone who went through the parent before us
+  Page *sibling = FetchLatched(parent_page->ValueAt(index == 0 ? 1 : index - 1), true);
+  latched.push_back(sibling);
+  N *sibling_page = reinterpret_cast<N *>(sibling->GetData());
+  assert(sibling_page->GetParentPageId() == node->GetParentPageId());
+  bool node_deleted = false;
   if (sibling_page->GetSize() > sibling_page->GetMinSize()) {
-    Redistribute(sibling_page,node,index);
-    //Coalesce<N>(sibling_page, node, parent_page, index);
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId());
-    buffer_pool_manager_->UnpinPage(sibling_page->GetPageId());
-    buffer_pool_manager_->UnpinPage(node->GetPageId());
-    return false;
-    // node->MoveFirstToEndOf(sibling_page, parent_page->value_[index],buffer_pool_manager_);
-    //
-
-  if(!parent_page->IsLeafPage())
-  for(int i=0;i<parent_page->GetSize()+1;++i){
-    auto temp = reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(parent_page->ValueAt(i))->GetData());
-    assert(temp->GetPageId());
-    assert(temp->GetParentPageId()==parent_page->GetPageId());
-    buffer_pool_manager_->UnpinPage(parent_page->ValueAt(i));
-  }
+    Redistribute(sibling_page, node, index);
   } else {
-    // need to merge
-    bool recur_;
+    // need to merge, always into the left page
+    bool recur;
     if (index == 0) {
-      recur_ = Coalesce<N>(node, sibling_page, parent_page, 0);
-    } else
-      recur_ = Coalesce<N>(sibling_page, node, parent_page, index-1);
-    if (recur_) {
-      CoalesceOrRedistribute(parent_page);
+      recur = Coalesce<N>(node, sibling_page, parent_page, 0, deleted, transaction);
+    } else {
+      recur = Coalesce<N>(sibling_page, node, parent_page, index - 1, deleted, transaction);
+      node_deleted = true;
+    }
+    if (recur) {
+      CoalesceOrRedistribute(parent_page, latched, deleted, transaction);
     }
-    buffer_pool_manager_->UnpinPage(parent_page->GetPageId());
-    buffer_pool_manager_->UnpinPage(node->GetPageId());
-    buffer_pool_manager_->UnpinPage(sibling_page->GetPageId());
-
-
-    return true;
   }
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId());
+  return node_deleted;
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
+ * Move all the key & value pairs from one page to its sibling page, and record
+ * the emptied page in deleted. Parent page must be adjusted to
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
  * Using template N to represent either internal page or leaf page.
@@ -464,8 +602,12 @@ INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N *neighbor_node, N *node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *parent, const int &index,
-                              Transaction *transaction) {
+                              std::vector<page_id_t> &deleted, Transaction *transaction) {
   (node)->MoveAllTo(neighbor_node, (parent)->KeyAt(index), buffer_pool_manager_);
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    LinkNextLeafBack(neighbor_node);
+  }
+  deleted.push_back(node->GetPageId());
   for (int i = index; i < (parent)->GetSize() - 1; i++) {
     (parent)->SetKeyAt(i, (parent)->KeyAt(i + 1));
   }
@@ -500,6 +642,19 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
     KeyType &parent_key = (*parent_page)[index-1];
     node->MoveLastToFrontOf(neighbor_node, parent_key, buffer_pool_manager_);
   }
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LinkNextLeafBack(LeafPage *leaf) {
+  page_id_t next_page_id = leaf->GetNextPageId();
+  if (next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  Page *next_page = FetchLatched(next_page_id, true);
+  reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId(leaf->GetPageId());
+  next_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page_id, true);
 }
 
 /*
@@ -525,38 +680,38 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
-  if (IsEmpty()) return INDEXITERATOR_TYPE();
-
-  LeafPage *first_leaf =
-      reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(this->first_page_id_)->GetData() );
-  return INDEXITERATOR_TYPE(0, first_leaf, buffer_pool_manager_);
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return INDEXITERATOR_TYPE();
+  }
+  Page *page = FetchLatched(root_page_id_, false);
+  root_latch_.RUnlock();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    Page *child = FetchLatched(reinterpret_cast<InternalPage *>(node)->ValueAt(0), false);
+    page_id_t page_id = page->GetPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page = child;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return INDEXITERATOR_TYPE(this, page, 0);
 }
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
  * first, then construct index iterator
- * @return : index iterator
+ * @return : index iterator at the first key not less than the input key
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  // need to find the leaf page and index in page
-  InternalPage *temp_internal_ptr =
-      reinterpret_cast<InternalPage*>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData() );
-  // find leaf
-  while (!temp_internal_ptr->IsLeafPage()) {
-    buffer_pool_manager_->UnpinPage(temp_internal_ptr->GetPageId());
-    int local_index = temp_internal_ptr->KeyIndex(key, comparator_);
-    temp_internal_ptr = reinterpret_cast<InternalPage *>(
-        buffer_pool_manager_->FetchPage(temp_internal_ptr->ValueAt(local_index))->GetData() );
-  }
-  // find leaf
-  LeafPage *leaf_page_ = reinterpret_cast<LeafPage *>(temp_internal_ptr);
-  int index = leaf_page_->KeyIndex(key, comparator_);
-  if (index == leaf_page_->GetSize()) {
+  int index;
+  Page *page = SeekForward(key, true, index);
+  if (page == nullptr) {
     return INDEXITERATOR_TYPE();
-  } else {
-    return INDEXITERATOR_TYPE(index, leaf_page_, buffer_pool_manager_);
   }
+  return INDEXITERATOR_TYPE(this, page, index);
 }
 
 /*
@@ -567,6 +722,48 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() { return INDEXITERATOR_TYPE(); }
 
+/*
+ * Descend along the last child of every page to the rightmost leaf
+ * @return : index iterator at the last key of the tree
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin() {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return INDEXITERATOR_TYPE();
+  }
+  Page *page = FetchLatched(root_page_id_, false);
+  root_latch_.RUnlock();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal_page = reinterpret_cast<InternalPage *>(node);
+    Page *child = FetchLatched(internal_page->ValueAt(internal_page->GetSize()), false);
+    page_id_t page_id = page->GetPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page = child;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  // the leaf stays latched for the iterator
+  return INDEXITERATOR_TYPE(this, page, node->GetSize() - 1);
+}
+
+/*
+ * Find the leaf page that contains the input key, the last key not greater than it is either in the leaf or the last
+ * key of the previous leaf
+ * @return : index iterator at the last key not greater than the input key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+  int index;
+  Page *page = SeekBackward(key, true, index);
+  if (page == nullptr) {
+    return INDEXITERATOR_TYPE();
+  }
+  return INDEXITERATOR_TYPE(this, page, index);
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
@@ -578,6 +775,225 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() { return INDEXITERATOR_TYPE(); }
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) { return nullptr; }
 
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchLatched(page_id_t page_id, bool exclusive) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  ASSERT(page != nullptr, "No free frame in buffer pool.");
+  // the pin keeps the page in its frame while we wait for the latch
+  if (exclusive) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetValueOptimistic(const KeyType &key, ValueType &value, bool &found) {
+  uint64_t root_version = root_latch_.OptimisticRead();
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    found = false;
+    return root_latch_.Validate(root_version);
+  }
+  Page *parent = nullptr;
+  page_id_t parent_id = INVALID_PAGE_ID;
+  uint64_t parent_version = 0;
+  while (true) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      if (parent != nullptr) {
+        buffer_pool_manager_->UnpinPage(parent_id, false);
+      }
+      return false;
+    }
+    uint64_t version = page->OptimisticRLatch();
+    // the page must still be the one the parent pointed to when we took its version
+    bool valid = page->GetPageId() == page_id &&
+                 (parent == nullptr ? root_latch_.Validate(root_version) : parent->ValidateRLatch(parent_version));
+    if (parent != nullptr) {
+      buffer_pool_manager_->UnpinPage(parent_id, false);
+    }
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return false;
+    }
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      found = reinterpret_cast<LeafPage *>(node)->Lookup(key, value, comparator_);
+      valid = page->ValidateRLatch(version);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return valid;
+    }
+    auto *internal_page = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id = internal_page->ValueAt(internal_page->KeyIndex(key, comparator_));
+    // a torn child page id must not be fetched
+    if (!page->ValidateRLatch(version)) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      return false;
+    }
+    parent = page;
+    parent_id = page_id;
+    parent_version = version;
+    page_id = child_page_id;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::TryFetchRLatched(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  if (!page->TryRLatch()) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return nullptr;
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::SeekForward(const KeyType &key, bool inclusive, int &index) {
+  std::vector<Page *> latched;
+  Page *page = FindLeafLatched(key, Operation::kFind, true, latched);
+  while (page != nullptr) {
+    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    index = leaf_page->LowerBound(key, comparator_);
+    if (!inclusive && index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
+      index++;
+    }
+    if (index < leaf_page->GetSize()) {
+      return page;
+    }
+    // all keys of the leaf are less, the key we look for starts the next leaf
+    page_id_t next_page_id = leaf_page->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    Page *next_page = TryFetchRLatched(next_page_id);
+    ReleaseLatches(latched, false);
+    if (next_page != nullptr) {
+      latched.push_back(next_page);
+      page = next_page;
+      continue;
+    }
+    std::this_thread::yield();
+    page = FindLeafLatched(key, Operation::kFind, true, latched);
+  }
+  ReleaseLatches(latched, false);
+  return nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::SeekBackward(const KeyType &key, bool inclusive, int &index) {
+  std::vector<Page *> latched;
+  Page *page = FindLeafLatched(key, Operation::kFind, true, latched);
+  while (page != nullptr) {
+    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    index = leaf_page->LowerBound(key, comparator_);
+    if (!inclusive || index == leaf_page->GetSize() || comparator_(leaf_page->KeyAt(index), key) != 0) {
+      index--;
+    }
+    if (index >= 0) {
+      return page;
+    }
+    // all keys of the leaf are greater, the key we look for ends the previous leaf
+    page_id_t prev_page_id = leaf_page->GetPrevPageId();
+    if (prev_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    // leaves are latched left to right everywhere else, waiting for the previous one could deadlock
+    Page *prev_page = TryFetchRLatched(prev_page_id);
+    ReleaseLatches(latched, false);
+    if (prev_page != nullptr) {
+      latched.push_back(prev_page);
+      page = prev_page;
+      continue;
+    }
+    std::this_thread::yield();
+    page = FindLeafLatched(key, Operation::kFind, true, latched);
+  }
+  ReleaseLatches(latched, false);
+  return nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafLatched(const KeyType &key, Operation op, bool optimistic,
+                                      std::vector<Page *> &latched) {
+  bool exclusive = op != Operation::kFind && !optimistic;
+  if (exclusive) {
+    root_latch_.WLock();
+  } else {
+    root_latch_.RLock();
+  }
+  latched.push_back(nullptr);
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    // an insert keeps root_latch_ to start a new tree
+    if (!exclusive) {
+      ReleaseLatches(latched, false);
+    }
+    return nullptr;
+  }
+  Page *page = FetchLatched(root_page_id_, exclusive);
+  latched.push_back(page);
+  while (true) {
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (!exclusive) {
+      if (node->IsLeafPage() && op != Operation::kFind) {
+        // the leaf stays pinned, and the parent is still read latched, so it stays where it is while it is latched again
+        page->RUnlatch();
+        page->WLatch();
+      }
+      ReleaseLatches(latched, false, 1);
+    } else if (IsSafe(node, op)) {
+      ReleaseLatches(latched, true, 1);
+    }
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    auto *internal_page = reinterpret_cast<InternalPage *>(node);
+    page = FetchLatched(internal_page->ValueAt(internal_page->KeyIndex(key, comparator_)), exclusive);
+    latched.push_back(page);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseLatches(std::vector<Page *> &latched, bool exclusive, size_t keep) {
+  size_t count = latched.size() - keep;
+  for (size_t i = 0; i < count; i++) {
+    Page *page = latched[i];
+    if (page == nullptr) {
+      if (exclusive) {
+        root_latch_.WUnlock();
+      } else {
+        root_latch_.RUnlock();
+      }
+      continue;
+    }
+    // unlatch first, an unpinned frame may be given to another page right away
+    page_id_t page_id = page->GetPageId();
+    if (exclusive) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page_id, exclusive);
+  }
+  latched.erase(latched.begin(), latched.begin() + count);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation op) const {
+  if (op == Operation::kInsert) {
+    return node->GetSize() + 1 < node->GetMaxSize();
+  }
+  if (op == Operation::kRemove) {
+    // the root underflows when it loses its last key
+    return node->IsRootPage() ? node->GetSize() > 1 : node->GetSize() > node->GetMinSize();
+  }
+  return true;
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -588,9 +1004,11 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) { return n
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId() {
-  IndexRootsPage* meta_root_page = reinterpret_cast<IndexRootsPage*>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
-  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID);
-  meta_root_page->Update(this->index_id_,this->root_page_id_);
+  // the roots page is shared by all indexes
+  Page *page = FetchLatched(INDEX_ROOTS_PAGE_ID, true);
+  reinterpret_cast<IndexRootsPage *>(page->GetData())->Update(this->index_id_, this->root_page_id_);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
 /**
@@ -696,7 +1114,7 @@ void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
   if (page->IsLeafPage()) {
     auto *leaf = reinterpret_cast<LeafPage *>(page);
     std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
-              << " next: " << leaf->GetNextPageId() << std::endl;
+              << " next: " << leaf->GetNextPageId() << " prev: " << leaf->GetPrevPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
       std::cout << leaf->KeyAt(i) << ",";
     }
@@ -1,10 +1,19 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include "index/b_plus_tree_index.h"
 #include "index/generic_key.h"
+#include "utils/external_sorter.h"
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema,
-                                     BufferPoolManager *buffer_pool_manager)
+                                     BufferPoolManager *buffer_pool_manager, bool unique)
         : Index(index_id, key_schema),
+          unique_(unique),
           comparator_(key_schema_),
           container_(index_id, buffer_pool_manager, comparator_) {
 
@@ -14,7 +23,7 @@ INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
   ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
   KeyType index_key;
-  index_key.SerializeFromKey(key, key_schema_);
+  SerializeKey(key, row_id, index_key);
 
   bool status = container_.Insert(index_key, row_id, txn);
 
@@ -27,7 +36,7 @@ dberr_t BPLUSTREE_INDEX_TYPE::InsertEntry(const Row &key, RowId row_id, Transact
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
   KeyType index_key;
-  index_key.SerializeFromKey(key, key_schema_);
+  SerializeKey(key, row_id, index_key);
 
   container_.Remove(index_key, txn);
   return DB_SUCCESS;
@@ -35,14 +44,170 @@ dberr_t BPLUSTREE_INDEX_TYPE::RemoveEntry(const Row &key, RowId row_id, Transact
 
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn) {
-  KeyType index_key;
-  index_key.SerializeFromKey(key, key_schema_);
-  if (container_.GetValue(index_key, result, txn)) {
+  if (unique_) {
+    KeyType index_key;
+    index_key.SerializeFromKey(key, key_schema_);
+    if (container_.GetValue(index_key, result, txn)) {
+      return DB_SUCCESS;
+    }
+    return DB_KEY_NOT_FOUND;
+  }
+  // the entries of the key lie between its smallest and largest possible row ids
+  KeyType lower_key, upper_key;
+  lower_key.SerializeFromKey(key, KEY_MIN_ROWID, key_schema_);
+  upper_key.SerializeFromKey(key, KEY_MAX_ROWID, key_schema_);
+  if (container_.GetRange(lower_key, upper_key, result, txn)) {
     return DB_SUCCESS;
   }
   return DB_KEY_NOT_FOUND;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::BulkLoad(const std::vector<EntrySource> &sources, double fill_factor,
+                                       size_t sort_memory) {
+  struct Entry {
+    KeyType key;
+    ValueType value;
+  };
+  auto compare = [this](const Entry &a, const Entry &b) { return comparator_(a.key, b.key) < 0; };
+  using Sorter = ExternalSorter<Entry, decltype(compare)>;
+  std::vector<std::unique_ptr<Sorter>> sorters;
+  for (size_t i = 0; i < sources.size(); i++) {
+    sorters.emplace_back(new Sorter(compare, sort_memory / sources.size()));
+  }
+  std::atomic<bool> failed{false};
+  auto extract = [&](size_t i) {
+    Sorter &sorter = *sorters[i];
+    Entry entry;
+    bool added = true;
+    sources[i]([&](std::vector<Field> &fields, const RowId &row_id) {
+      ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+      SerializeKey(Row(fields), row_id, entry.key);
+      entry.value = row_id;
+      added = added && sorter.Add(entry);
+    });
+    if (!added || !sorter.Sort()) {
+      failed = true;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < sources.size(); i++) {
+    threads.emplace_back(extract, i);
+  }
+  if (!sources.empty()) {
+    extract(0);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  if (failed) {
+    return DB_FAILED;
+  }
+  size_t count = 0;
+  for (auto &sorter : sorters) {
+    count += sorter->GetCount();
+  }
+  if (sorters.size() <= 1) {
+    bool status = container_.BulkLoad(
+            count,
+            [&sorters](KeyType &key, ValueType &value) {
+              Entry entry;
+              if (!sorters[0]->Next(entry)) {
+                return false;
+              }
+              key = entry.key;
+              value = entry.value;
+              return true;
+            },
+            fill_factor);
+    return status ? DB_SUCCESS : DB_FAILED;
+  }
+  // The sorted entries of all sources are merged on a thread of its own, which hands them to the tree builder in
+  // batches, so that merging and building overlap. The source with the smallest next entry is on top of the heap.
+  static constexpr size_t BATCH_SIZE = 4096;
+  static constexpr size_t MAX_READY_BATCHES = 4;
+  std::mutex latch;
+  std::condition_variable cv;
+  std::deque<std::vector<Entry>> ready;
+  bool merged = false;
+  bool cancelled = false;
+  threads.emplace_back([&]() {
+    std::vector<Entry> heads(sorters.size());
+    std::vector<size_t> heap;
+    for (size_t i = 0; i < sorters.size(); i++) {
+      if (sorters[i]->Next(heads[i])) {
+        heap.push_back(i);
+      }
+    }
+    auto heap_compare = [&](size_t a, size_t b) { return compare(heads[b], heads[a]); };
+    std::make_heap(heap.begin(), heap.end(), heap_compare);
+    while (!heap.empty()) {
+      std::vector<Entry> batch;
+      batch.reserve(BATCH_SIZE);
+      while (!heap.empty() && batch.size() < BATCH_SIZE) {
+        std::pop_heap(heap.begin(), heap.end(), heap_compare);
+        size_t i = heap.back();
+        batch.push_back(heads[i]);
+        if (sorters[i]->Next(heads[i])) {
+          std::push_heap(heap.begin(), heap.end(), heap_compare);
+        } else {
+          heap.pop_back();
+        }
+      }
+      std::unique_lock<std::mutex> lock(latch);
+      cv.wait(lock, [&]() { return ready.size() < MAX_READY_BATCHES || cancelled; });
+      if (cancelled) {
+        break;
+      }
+      ready.push_back(std::move(batch));
+      cv.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(latch);
+    merged = true;
+    cv.notify_all();
+  });
+  std::vector<Entry> batch;
+  size_t next = 0;
+  bool status = container_.BulkLoad(
+          count,
+          [&](KeyType &key, ValueType &value) {
+            if (next == batch.size()) {
+              std::unique_lock<std::mutex> lock(latch);
+              cv.wait(lock, [&]() { return !ready.empty() || merged; });
+              if (ready.empty()) {
+                return false;
+              }
+              batch = std::move(ready.front());
+              ready.pop_front();
+              next = 0;
+              cv.notify_all();
+            }
+            key = batch[next].key;
+            value = batch[next].value;
+            next++;
+            return true;
+          },
+          fill_factor);
+  {
+    // the builder stops early on a duplicate key
+    std::lock_guard<std::mutex> lock(latch);
+    cancelled = true;
+    cv.notify_all();
+  }
+  threads[0].join();
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SerializeKey(const Row &key, const RowId &row_id, KeyType &index_key) const {
+  if (unique_) {
+    index_key.SerializeFromKey(key, key_schema_);
+  } else {
+    index_key.SerializeFromKey(key, row_id, key_schema_);
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::Destroy() {
   container_.Destroy();
@@ -65,6 +230,34 @@ INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() {
   return container_.End();
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetRangeIterator(const KeyType &lower, bool lower_inclusive,
+                                                          const KeyType &upper, bool upper_inclusive) {
+  auto iter = container_.Begin(lower);
+  // keys are unique in the tree, only the first one can equal lower
+  if (!lower_inclusive && iter != container_.End() && comparator_((*iter).first, lower) == 0) {
+    ++iter;
+  }
+  iter.SetUpperBound(upper, upper_inclusive, &comparator_);
+  return iter;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() {
+  return container_.RBegin();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseRangeIterator(const KeyType &lower, bool lower_inclusive,
+                                                                 const KeyType &upper, bool upper_inclusive) {
+  auto iter = container_.RBegin(upper);
+  if (!upper_inclusive && iter != container_.End() && comparator_((*iter).first, upper) == 0) {
+    --iter;
+  }
+  iter.SetLowerBound(lower, lower_inclusive, &comparator_);
+  return iter;
+}
+
 template
 class BPlusTreeIndex<GenericKey<4>, RowId, GenericComparator<4>>;
 
@@ -0,0 +1,453 @@
+#include "index/extendible_hash_table.h"
+
+#include <unordered_set>
+
+#include "glog/logging.h"
+#include "index/basic_comparator.h"
+#include "index/generic_key.h"
+#include "page/index_roots_page.h"
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                                                const KeyComparator &comparator, uint32_t directory_max_depth,
+                                                int bucket_max_size)
+    : index_id_(index_id),
+      header_page_id_(INVALID_PAGE_ID),
+      buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      directory_max_depth_(directory_max_depth),
+      bucket_max_size_(bucket_max_size) {
+  Page *roots_page = FetchLatched(INDEX_ROOTS_PAGE_ID, true);
+  auto *roots = reinterpret_cast<IndexRootsPage *>(roots_page->GetData());
+  if (roots->GetRootId(index_id_, &header_page_id_) && header_page_id_ != INVALID_PAGE_ID) {
+    Release(roots_page, true);
+    return;
+  }
+  // a new table starts with a single directory holding a single bucket
+  Page *header_page = buffer_pool_manager_->NewPage(header_page_id_);
+  ASSERT(header_page != nullptr, "Out of memory.");
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(header_page->GetData());
+  header->Init(header_page_id_);
+  page_id_t directory_page_id;
+  NewDirectory(directory_page_id);
+  buffer_pool_manager_->UnpinPage(directory_page_id, true);
+  header->SetDirectoryPageId(0, directory_page_id);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+  if (!roots->Update(index_id_, header_page_id_)) {
+    roots->Insert(index_id_, header_page_id_);
+  }
+  Release(roots_page, true, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::Destroy() {
+  Page *roots_page = FetchLatched(INDEX_ROOTS_PAGE_ID, true);
+  reinterpret_cast<IndexRootsPage *>(roots_page->GetData())->Delete(index_id_);
+  Release(roots_page, true, true);
+  if (header_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  Page *header_page = FetchLatched(header_page_id_, true);
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(header_page->GetData());
+  std::unordered_set<page_id_t> directory_page_ids;
+  for (uint32_t i = 0; i < header->Size(); i++) {
+    directory_page_ids.insert(header->GetDirectoryPageId(i));
+  }
+  for (auto directory_page_id : directory_page_ids) {
+    Page *directory_page = FetchLatched(directory_page_id, true);
+    auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+    std::unordered_set<page_id_t> bucket_page_ids;
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      bucket_page_ids.insert(directory->GetBucketPageId(i));
+    }
+    Release(directory_page, true);
+    for (auto bucket_page_id : bucket_page_ids) {
+      buffer_pool_manager_->DeletePage(bucket_page_id);
+    }
+    buffer_pool_manager_->DeletePage(directory_page_id);
+  }
+  Release(header_page, true);
+  buffer_pool_manager_->DeletePage(header_page_id_);
+  header_page_id_ = INVALID_PAGE_ID;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *) {
+  uint32_t hash = Hash(key);
+  Page *directory_page = FetchDirectory(hash, false);
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+  Page *bucket_page = FetchLatched(directory->GetBucketPageId(directory->HashToBucketIndex(hash)), false);
+  Release(directory_page, false);
+  ValueType value;
+  bool found = reinterpret_cast<BucketPage *>(bucket_page->GetData())->Lookup(key, value, comparator_);
+  Release(bucket_page, false);
+  if (found) {
+    result.push_back(value);
+  }
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *) {
+  uint32_t hash = Hash(key);
+  while (true) {
+    Page *directory_page = FetchDirectory(hash, true);
+    bool is_dirty = false;
+    InsertResult result = InsertIntoDirectory(reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData()),
+                                              hash, key, value, is_dirty);
+    Release(directory_page, true, is_dirty);
+    if (result != InsertResult::kFull) {
+      return result == InsertResult::kInserted;
+    }
+    if (!SplitDirectory(hash)) {
+      LOG(WARNING) << "Extendible hash table " << index_id_ << " is full." << std::endl;
+      return false;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename EXTENDIBLE_HASH_TABLE_TYPE::InsertResult EXTENDIBLE_HASH_TABLE_TYPE::InsertIntoDirectory(
+        HashTableDirectoryPage *directory, uint32_t hash, const KeyType &key, const ValueType &value, bool &is_dirty) {
+  while (true) {
+    uint32_t bucket_idx = directory->HashToBucketIndex(hash);
+    Page *bucket_page = FetchLatched(directory->GetBucketPageId(bucket_idx), true);
+    auto *bucket = reinterpret_cast<BucketPage *>(bucket_page->GetData());
+    if (bucket->KeyIndex(key, comparator_) != -1) {
+      Release(bucket_page, true);
+      return InsertResult::kExists;
+    }
+    if (!bucket->IsFull()) {
+      bucket->Insert(key, value, comparator_);
+      Release(bucket_page, true, true);
+      return InsertResult::kInserted;
+    }
+    if (!SplitBucket(directory, bucket_idx, bucket_page)) {
+      return InsertResult::kFull;
+    }
+    is_dirty = true;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::SplitBucket(HashTableDirectoryPage *directory, uint32_t bucket_idx,
+                                             Page *bucket_page) {
+  uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+  if (local_depth == directory->GetGlobalDepth()) {
+    if (directory->GetGlobalDepth() == directory->GetMaxDepth()) {
+      Release(bucket_page, true);
+      return false;
+    }
+    directory->IncrGlobalDepth();
+  }
+  page_id_t bucket_page_id = bucket_page->GetPageId();
+  page_id_t image_page_id;
+  Page *image_page = buffer_pool_manager_->NewPage(image_page_id);
+  ASSERT(image_page != nullptr, "Out of memory.");
+  auto *bucket = reinterpret_cast<BucketPage *>(bucket_page->GetData());
+  auto *image = reinterpret_cast<BucketPage *>(image_page->GetData());
+  image->Init(bucket_max_size_);
+  // the slots of the bucket with the next bit set move to the new bucket, and so do their entries
+  uint32_t high_bit = 1U << local_depth;
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    if (directory->GetBucketPageId(i) == bucket_page_id) {
+      directory->SetLocalDepth(i, local_depth + 1);
+      if (i & high_bit) {
+        directory->SetBucketPageId(i, image_page_id);
+      }
+    }
+  }
+  // backwards, since a removed entry is replaced by the last one
+  for (int i = bucket->GetSize() - 1; i >= 0; i--) {
+    KeyType key = bucket->KeyAt(i);
+    if (Hash(key) & high_bit) {
+      image->Insert(key, bucket->ValueAt(i), comparator_);
+      bucket->RemoveAt(i);
+    }
+  }
+  // nobody reaches the new bucket before the directory is released
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+  Release(bucket_page, true, true);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::SplitDirectory(uint32_t hash) {
+  Page *header_page = FetchLatched(header_page_id_, true);
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(header_page->GetData());
+  uint32_t directory_idx = header->HashToDirectoryIndex(hash);
+  page_id_t directory_page_id = header->GetDirectoryPageId(directory_idx);
+  Page *directory_page = FetchLatched(directory_page_id, true);
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+  if (directory->GetLocalDepth(directory->HashToBucketIndex(hash)) < directory->GetMaxDepth()) {
+    // the bucket may be split again, after a concurrent split of the directory or removes
+    Release(directory_page, true);
+    Release(header_page, true);
+    return true;
+  }
+  uint32_t local_depth = header->GetLocalDepth(directory_idx);
+  if (local_depth == HASH_HEADER_MAX_DEPTH) {
+    Release(directory_page, true);
+    Release(header_page, true);
+    return false;
+  }
+  if (local_depth == header->GetGlobalDepth()) {
+    header->IncrGlobalDepth();
+  }
+  // the new directory has the shape of the old one, each bucket is split by the next header bit of the hash
+  page_id_t image_page_id;
+  Page *image_page = buffer_pool_manager_->NewPage(image_page_id);
+  ASSERT(image_page != nullptr, "Out of memory.");
+  auto *image = reinterpret_cast<HashTableDirectoryPage *>(image_page->GetData());
+  image->Init(image_page_id, directory->GetMaxDepth());
+  while (image->GetGlobalDepth() < directory->GetGlobalDepth()) {
+    image->IncrGlobalDepth();
+  }
+  uint32_t high_bit = 1U << (HASH_HEADER_HASH_SHIFT + local_depth);
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    uint32_t bucket_depth = directory->GetLocalDepth(i);
+    image->SetLocalDepth(i, bucket_depth);
+    uint32_t first = i & ((1U << bucket_depth) - 1);
+    if (first != i) {
+      // the first slot of the bucket comes first
+      image->SetBucketPageId(i, image->GetBucketPageId(first));
+      continue;
+    }
+    Page *bucket_page = FetchLatched(directory->GetBucketPageId(i), true);
+    auto *bucket = reinterpret_cast<BucketPage *>(bucket_page->GetData());
+    page_id_t new_bucket_page_id;
+    Page *new_bucket_page = buffer_pool_manager_->NewPage(new_bucket_page_id);
+    ASSERT(new_bucket_page != nullptr, "Out of memory.");
+    auto *new_bucket = reinterpret_cast<BucketPage *>(new_bucket_page->GetData());
+    new_bucket->Init(bucket_max_size_);
+    for (int j = bucket->GetSize() - 1; j >= 0; j--) {
+      KeyType key = bucket->KeyAt(j);
+      if (Hash(key) & high_bit) {
+        new_bucket->Insert(key, bucket->ValueAt(j), comparator_);
+        bucket->RemoveAt(j);
+      }
+    }
+    image->SetBucketPageId(i, new_bucket_page_id);
+    buffer_pool_manager_->UnpinPage(new_bucket_page_id, true);
+    Release(bucket_page, true, true);
+  }
+  for (uint32_t i = 0; i < header->Size(); i++) {
+    if (header->GetDirectoryPageId(i) == directory_page_id) {
+      header->SetLocalDepth(i, local_depth + 1);
+      if (i & (1U << local_depth)) {
+        header->SetDirectoryPageId(i, image_page_id);
+      }
+    }
+  }
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+  Release(directory_page, true, true);
+  Release(header_page, true, true);
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::Remove(const KeyType &key, Transaction *) {
+  uint32_t hash = Hash(key);
+  Page *directory_page = FetchDirectory(hash, true);
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+  uint32_t bucket_idx = directory->HashToBucketIndex(hash);
+  Page *bucket_page = FetchLatched(directory->GetBucketPageId(bucket_idx), true);
+  auto *bucket = reinterpret_cast<BucketPage *>(bucket_page->GetData());
+  if (!bucket->Remove(key, comparator_)) {
+    Release(bucket_page, true);
+    Release(directory_page, true);
+    return false;
+  }
+  if (!bucket->IsEmpty()) {
+    Release(bucket_page, true, true);
+    Release(directory_page, true);
+    return true;
+  }
+  MergeBucket(directory, bucket_idx, bucket_page);
+  Release(directory_page, true, true);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::MergeBucket(HashTableDirectoryPage *directory, uint32_t bucket_idx,
+                                             Page *bucket_page) {
+  page_id_t bucket_page_id = bucket_page->GetPageId();
+  while (reinterpret_cast<BucketPage *>(bucket_page->GetData())->IsEmpty()) {
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    if (local_depth == 0) {
+      break;
+    }
+    uint32_t image_idx = directory->GetSplitImageIndex(bucket_idx);
+    if (directory->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t image_page_id = directory->GetBucketPageId(image_idx);
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      page_id_t page_id = directory->GetBucketPageId(i);
+      if (page_id == bucket_page_id || page_id == image_page_id) {
+        directory->SetBucketPageId(i, image_page_id);
+        directory->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    // nobody reaches the empty bucket any more, the directory is write latched
+    Release(bucket_page, true);
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    // the image may be empty as well
+    bucket_page = FetchLatched(image_page_id, true);
+    bucket_page_id = image_page_id;
+    bucket_idx = image_idx;
+  }
+  Release(bucket_page, true, true);
+  while (directory->CanShrink()) {
+    directory->DecrGlobalDepth();
+  }
+}
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::Hash(const KeyType &key) const {
+  // FNV-1a of the key bytes, finished with the MurmurHash3 mixer so that the low bits depend on all bytes
+  auto *bytes = reinterpret_cast<const uint8_t *>(&key);
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < sizeof(KeyType); i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return static_cast<uint32_t>(hash);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *EXTENDIBLE_HASH_TABLE_TYPE::FetchLatched(page_id_t page_id, bool exclusive) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  ASSERT(page != nullptr, "No free frame in buffer pool.");
+  // the pin keeps the page in its frame while we wait for the latch
+  if (exclusive) {
+    page->WLatch();
+  } else {
+    page->RLatch();
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTENDIBLE_HASH_TABLE_TYPE::Release(Page *page, bool exclusive, bool is_dirty) {
+  page_id_t page_id = page->GetPageId();
+  if (exclusive) {
+    page->WUnlatch();
+  } else {
+    page->RUnlatch();
+  }
+  buffer_pool_manager_->UnpinPage(page_id, is_dirty);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *EXTENDIBLE_HASH_TABLE_TYPE::FetchDirectory(uint32_t hash, bool exclusive) {
+  Page *header_page = FetchLatched(header_page_id_, false);
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(header_page->GetData());
+  Page *directory_page = FetchLatched(header->GetDirectoryPageId(header->HashToDirectoryIndex(hash)), exclusive);
+  Release(header_page, false);
+  return directory_page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *EXTENDIBLE_HASH_TABLE_TYPE::NewDirectory(page_id_t &directory_page_id) {
+  Page *directory_page = buffer_pool_manager_->NewPage(directory_page_id);
+  ASSERT(directory_page != nullptr, "Out of memory.");
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+  directory->Init(directory_page_id, directory_max_depth_);
+  page_id_t bucket_page_id;
+  Page *bucket_page = buffer_pool_manager_->NewPage(bucket_page_id);
+  ASSERT(bucket_page != nullptr, "Out of memory.");
+  reinterpret_cast<BucketPage *>(bucket_page->GetData())->Init(bucket_max_size_);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  directory->SetBucketPageId(0, bucket_page_id);
+  return directory_page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t EXTENDIBLE_HASH_TABLE_TYPE::GetDirectoryCount() {
+  Page *header_page = FetchLatched(header_page_id_, false);
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(header_page->GetData());
+  std::unordered_set<page_id_t> directory_page_ids;
+  for (uint32_t i = 0; i < header->Size(); i++) {
+    directory_page_ids.insert(header->GetDirectoryPageId(i));
+  }
+  Release(header_page, false);
+  return directory_page_ids.size();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTENDIBLE_HASH_TABLE_TYPE::Check() {
+  bool consistent = true;
+  Page *header_page = FetchLatched(header_page_id_, false);
+  auto *header = reinterpret_cast<HashTableHeaderPage *>(header_page->GetData());
+  std::unordered_set<page_id_t> directory_page_ids;
+  for (uint32_t directory_idx = 0; directory_idx < header->Size(); directory_idx++) {
+    page_id_t directory_page_id = header->GetDirectoryPageId(directory_idx);
+    if (!directory_page_ids.insert(directory_page_id).second) {
+      continue;
+    }
+    Page *directory_page = FetchLatched(directory_page_id, false);
+    auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+    if (!directory->VerifyIntegrity()) {
+      LOG(ERROR) << "inconsistent directory " << directory_page_id << std::endl;
+      consistent = false;
+    }
+    // every entry must be found where a lookup of its key goes
+    std::unordered_set<page_id_t> bucket_page_ids;
+    for (uint32_t bucket_idx = 0; bucket_idx < directory->Size(); bucket_idx++) {
+      page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+      if (!bucket_page_ids.insert(bucket_page_id).second) {
+        continue;
+      }
+      Page *bucket_page = FetchLatched(bucket_page_id, false);
+      auto *bucket = reinterpret_cast<BucketPage *>(bucket_page->GetData());
+      for (int i = 0; i < bucket->GetSize(); i++) {
+        uint32_t hash = Hash(bucket->KeyAt(i));
+        if (header->GetDirectoryPageId(header->HashToDirectoryIndex(hash)) != directory_page_id ||
+            directory->GetBucketPageId(directory->HashToBucketIndex(hash)) != bucket_page_id) {
+          LOG(ERROR) << "misplaced entry in bucket " << bucket_page_id << std::endl;
+          consistent = false;
+        }
+      }
+      Release(bucket_page, false);
+    }
+    Release(directory_page, false);
+  }
+  Release(header_page, false);
+  bool all_unpinned = buffer_pool_manager_->CheckAllUnpinned();
+  if (!all_unpinned) {
+    LOG(ERROR) << "problem in page unpin" << std::endl;
+  }
+  return consistent && all_unpinned;
+}
+
+template class ExtendibleHashTable<int, int, BasicComparator<int>>;
+
+template class ExtendibleHashTable<GenericKey<4>, RowId, GenericComparator<4>>;
+
+template class ExtendibleHashTable<GenericKey<8>, RowId, GenericComparator<8>>;
+
+template class ExtendibleHashTable<GenericKey<16>, RowId, GenericComparator<16>>;
+
+template class ExtendibleHashTable<GenericKey<32>, RowId, GenericComparator<32>>;
+
+template class ExtendibleHashTable<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template class ExtendibleHashTable<GenericKey<128>, RowId, GenericComparator<128>>;
@@ -0,0 +1,139 @@
+#include "index/generic_key.h"
+
+static constexpr uint32_t NULL_MARKER_SIZE = sizeof(uint8_t);
+
+static void WriteBigEndian(uint32_t value, char *buf) {
+  buf[0] = static_cast<char>(value >> 24);
+  buf[1] = static_cast<char>(value >> 16);
+  buf[2] = static_cast<char>(value >> 8);
+  buf[3] = static_cast<char>(value);
+}
+
+static uint32_t ReadBigEndian(const char *buf) {
+  auto *bytes = reinterpret_cast<const uint8_t *>(buf);
+  return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+         (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+}
+
+/**
+ * @return number of characters of a char field, which ends at its first zero byte
+ */
+static uint32_t CharLength(const Field *field, const Column *column) {
+  return strnlen(field->GetData(), std::min(field->GetLength(), column->GetLength()));
+}
+
+uint32_t KeyEncoding::GetEncodedSize(const Column *column) {
+  if (column->GetType() == TypeId::kTypeChar) {
+    return NULL_MARKER_SIZE + column->GetLength() + 1;
+  }
+  return NULL_MARKER_SIZE + Type::GetTypeSize(column->GetType());
+}
+
+uint32_t KeyEncoding::GetEncodedSize(const Schema *schema) {
+  uint32_t size = 0;
+  for (auto column : schema->GetColumns()) {
+    size += GetEncodedSize(column);
+  }
+  return size;
+}
+
+uint32_t KeyEncoding::GetEncodedSize(const Row &key, const Schema *schema) {
+  uint32_t size = 0;
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *column = schema->GetColumn(i);
+    if (column->GetType() != TypeId::kTypeChar) {
+      size += GetEncodedSize(column);
+    } else if (key.GetField(i)->IsNull()) {
+      size += NULL_MARKER_SIZE;
+    } else {
+      size += NULL_MARKER_SIZE + CharLength(key.GetField(i), column) + 1;
+    }
+  }
+  return size;
+}
+
+uint32_t KeyEncoding::Encode(const Row &key, const Schema *schema, char *buf) {
+  char *begin = buf;
+  uint32_t count = std::min<uint32_t>(schema->GetColumnCount(), key.GetFieldCount());
+  for (uint32_t i = 0; i < count; i++) {
+    const Column *column = schema->GetColumn(i);
+    const Field *field = key.GetField(i);
+    *buf++ = field->IsNull() ? 0 : 1;
+    switch (column->GetType()) {
+      case TypeId::kTypeInt: {
+        uint32_t bits = field->IsNull() ? 0 : static_cast<uint32_t>(field->value_.integer_) ^ 0x80000000u;
+        WriteBigEndian(bits, buf);
+        buf += sizeof(int32_t);
+        break;
+      }
+      case TypeId::kTypeFloat: {
+        uint32_t bits = 0;
+        if (!field->IsNull()) {
+          // -0.0 equals 0.0
+          float real = field->value_.float_ == 0.0f ? 0.0f : field->value_.float_;
+          memcpy(&bits, &real, sizeof(bits));
+          bits = (bits & 0x80000000u) ? ~bits : bits ^ 0x80000000u;
+        }
+        WriteBigEndian(bits, buf);
+        buf += sizeof(float);
+        break;
+      }
+      case TypeId::kTypeChar: {
+        if (!field->IsNull()) {
+          uint32_t len = CharLength(field, column);
+          memcpy(buf, field->GetData(), len);
+          buf[len] = 0;
+          buf += len + 1;
+        }
+        break;
+      }
+      default:
+        ASSERT(false, "Unsupported key type.");
+    }
+  }
+  return buf - begin;
+}
+
+void KeyEncoding::Decode(const char *buf, const Schema *schema, Row &key) {
+  // rebuild the row format and let the row deserialize itself
+  std::vector<char> row(sizeof(RowId) + GetEncodedSize(schema) + schema->GetColumnCount() * sizeof(uint32_t));
+  char *dst = row.data();
+  MACH_WRITE_TO(RowId, dst, key.GetRowId());
+  dst += sizeof(RowId);
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *column = schema->GetColumn(i);
+    bool is_null = *buf++ == 0;
+    MACH_WRITE_TO(bool, dst, is_null);
+    dst += sizeof(bool);
+    switch (column->GetType()) {
+      case TypeId::kTypeInt:
+        if (!is_null) {
+          MACH_WRITE_INT32(dst, static_cast<int32_t>(ReadBigEndian(buf) ^ 0x80000000u));
+          dst += sizeof(int32_t);
+        }
+        buf += sizeof(int32_t);
+        break;
+      case TypeId::kTypeFloat:
+        if (!is_null) {
+          uint32_t bits = ReadBigEndian(buf);
+          bits = (bits & 0x80000000u) ? bits ^ 0x80000000u : ~bits;
+          memcpy(dst, &bits, sizeof(bits));
+          dst += sizeof(float);
+        }
+        buf += sizeof(float);
+        break;
+      case TypeId::kTypeChar:
+        if (!is_null) {
+          uint32_t len = strnlen(buf, column->GetLength());
+          MACH_WRITE_UINT32(dst, len);
+          memcpy(dst + sizeof(uint32_t), buf, len);
+          dst += sizeof(uint32_t) + len;
+          buf += len + 1;
+        }
+        break;
+      default:
+        ASSERT(false, "Unsupported key type.");
+    }
+  }
+  key.DeserializeFrom(row.data(), const_cast<Schema *>(schema));
+}
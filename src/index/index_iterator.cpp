@@ -1,5 +1,6 @@
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
+#include "index/b_plus_tree.h"
 #include "index/index_iterator.h"
 
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(int index,B_PLUS_TREE_LEAF_PAGE_TYPE* leaf_page,BufferPoolManager* buffer_pool_manager):index_(index),leaf_page_(leaf_page) ,buffer_pool_manager_(buffer_pool_manager){
@@ -8,14 +9,37 @@ INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(int index,B_PLUS_TREE
   val_.second = leaf_page_->ValueAt(index_);
   }
 }
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree,
+                                                           Page *page, int index)
+    : buffer_pool_manager_(tree->buffer_pool_manager_), tree_(tree) {
+  Position(page, index);
+  val_.first = leaf_page_->KeyAt(index_);
+  val_.second = leaf_page_->ValueAt(index_);
+}
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(IndexIterator &other){
   this->index_ = other.index_;
   this->val_ = other.val_;
   this->leaf_page_ = other.leaf_page_;
   this->buffer_pool_manager_ = other.buffer_pool_manager_;
+  this->tree_ = other.tree_;
+  this->pages_crossed_ = other.pages_crossed_;
+  this->comparator_ = other.comparator_;
+  this->has_upper_ = other.has_upper_;
+  this->upper_ = other.upper_;
+  this->upper_inclusive_ = other.upper_inclusive_;
+  this->has_lower_ = other.has_lower_;
+  this->lower_ = other.lower_;
+  this->lower_inclusive_ = other.lower_inclusive_;
+}
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : IndexIterator(other) {
+  // the latch moves along
+  page_ = other.page_;
+  other.page_ = nullptr;
+  other.MakeEnd();
 }
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::~IndexIterator() {
-
+  Release();
 }
 
 INDEX_TEMPLATE_ARGUMENTS const MappingType &INDEXITERATOR_TYPE::operator*() {
@@ -25,25 +49,38 @@ INDEX_TEMPLATE_ARGUMENTS const MappingType &INDEXITERATOR_TYPE::operator*() {
 
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
   ASSERT(leaf_page_!=nullptr, "the end iterator!");
+  if (page_ == nullptr) {
+    Reposition(true);
+    return *this;
+  }
   if(index_<leaf_page_->GetSize()-1){
     index_++;
   }else{
     // find next page
-      buffer_pool_manager_->UnpinPage(leaf_page_->GetPageId());
-    if(leaf_page_->GetNextPageId()==INVALID_PAGE_ID){
+    page_id_t next_page_id = leaf_page_->GetNextPageId();
+    if(next_page_id==INVALID_PAGE_ID){
       // end
-      index_ = -1;
-      leaf_page_ = nullptr;
-      buffer_pool_manager_ = nullptr;
+      MakeEnd();
+      return *this;
+    }
+    // the next leaf is only taken if it is free, see BPlusTree::GetRange()
+    Page *next_page = tree_->TryFetchRLatched(next_page_id);
+    if (next_page != nullptr) {
+      Release();
+      Position(next_page, 0);
+      if(++pages_crossed_>=SEQUENTIAL_SCAN_THRESHOLD){
+        buffer_pool_manager_->Prefetch(next_page_id,&B_PLUS_TREE_LEAF_PAGE_TYPE::NextPageIdOf);
+      }
+    } else {
+      // descend again to the key after the current one
+      Release();
+      Reposition(true);
       return *this;
-    }else {
-      //next page
-      leaf_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE*>(buffer_pool_manager_->FetchPage(leaf_page_->GetNextPageId())->GetData());
-      index_ = 0;
     }
   }
   val_.first = leaf_page_->KeyAt(index_);
   val_.second = leaf_page_->ValueAt(index_);
+  CheckBounds();
   return *this;
 }
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE INDEXITERATOR_TYPE::operator++(int) {
@@ -52,6 +89,50 @@ INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE INDEXITERATOR_TYPE::operator++(int)
   ++(*this);
   return res;
 }
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator--() {
+  ASSERT(leaf_page_ != nullptr, "the end iterator!");
+  if (page_ == nullptr) {
+    Reposition(false);
+    return *this;
+  }
+  if (index_ > 0) {
+    index_--;
+  } else {
+    // find previous page
+    page_id_t prev_page_id = leaf_page_->GetPrevPageId();
+    if (prev_page_id == INVALID_PAGE_ID) {
+      // end
+      MakeEnd();
+      return *this;
+    }
+    // leaves are latched left to right, the previous leaf is only taken if it is free
+    Page *prev_page = tree_->TryFetchRLatched(prev_page_id);
+    if (prev_page != nullptr) {
+      Release();
+      Position(prev_page, reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(prev_page->GetData())->GetSize() - 1);
+      if (++pages_crossed_ >= SEQUENTIAL_SCAN_THRESHOLD) {
+        buffer_pool_manager_->Prefetch(prev_page_id, &B_PLUS_TREE_LEAF_PAGE_TYPE::PrevPageIdOf);
+      }
+    } else {
+      // descend again to the key before the current one
+      Release();
+      Reposition(false);
+      return *this;
+    }
+  }
+  val_.first = leaf_page_->KeyAt(index_);
+  val_.second = leaf_page_->ValueAt(index_);
+  CheckBounds();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE INDEXITERATOR_TYPE::operator--(int) {
+  ASSERT(leaf_page_ != nullptr, "the end iterator!");
+  IndexIterator res(*this);
+  --(*this);
+  return res;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const {
   return (index_==itr.index_&&leaf_page_==itr.leaf_page_&&buffer_pool_manager_==itr.buffer_pool_manager_);
@@ -62,6 +143,78 @@ bool INDEXITERATOR_TYPE::operator!=(const IndexIterator &itr) const {
   return !((*this)==itr);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetUpperBound(const KeyType &upper, bool inclusive, const KeyComparator *comparator) {
+  comparator_ = comparator;
+  has_upper_ = true;
+  upper_ = upper;
+  upper_inclusive_ = inclusive;
+  CheckBounds();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SetLowerBound(const KeyType &lower, bool inclusive, const KeyComparator *comparator) {
+  comparator_ = comparator;
+  has_lower_ = true;
+  lower_ = lower;
+  lower_inclusive_ = inclusive;
+  CheckBounds();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::CheckBounds() {
+  if (leaf_page_ == nullptr) {
+    return;
+  }
+  int upper_cmp = has_upper_ ? (*comparator_)(val_.first, upper_) : -1;
+  int lower_cmp = has_lower_ ? (*comparator_)(val_.first, lower_) : 1;
+  if (upper_cmp > 0 || (upper_cmp == 0 && !upper_inclusive_) ||
+      lower_cmp < 0 || (lower_cmp == 0 && !lower_inclusive_)) {
+    MakeEnd();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Position(Page *page, int index) {
+  buffer_pool_manager_ = tree_->buffer_pool_manager_;
+  page_ = page;
+  leaf_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
+  index_ = index;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page_ == nullptr) {
+    return;
+  }
+  page_id_t page_id = page_->GetPageId();
+  page_->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  page_ = nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::MakeEnd() {
+  Release();
+  index_ = -1;
+  leaf_page_ = nullptr;
+  buffer_pool_manager_ = nullptr;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Reposition(bool forward) {
+  int index;
+  Page *page = forward ? tree_->SeekForward(val_.first, false, index) : tree_->SeekBackward(val_.first, false, index);
+  if (page == nullptr) {
+    MakeEnd();
+    return;
+  }
+  Position(page, index);
+  val_.first = leaf_page_->KeyAt(index_);
+  val_.second = leaf_page_->ValueAt(index_);
+  CheckBounds();
+}
+
 template
 class IndexIterator<int, int, BasicComparator<int>>;
 
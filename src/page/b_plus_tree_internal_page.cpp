@@ -49,14 +49,20 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const page_id_t &value) const {
   }
   return res;
 }
-/* return key index that first big than input key*/
+/* return key index that first big than input key, by binary search */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyIndex(const KeyType &key,const KeyComparator& comparator_) const{
-  int i;
-  for (i = 0; i < this->GetSize(); ++i) {
-      if (comparator_(this->KeyAt(i),key)>0) break;
-  } 
-  return i;
+  int low = 0;
+  int high = this->GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (comparator_(key_[mid], key) > 0) {
+      high = mid;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return low;
  }
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
@@ -100,12 +106,7 @@ bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value
 }
 INDEX_TEMPLATE_ARGUMENTS
 page_id_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  // replace with your own code
-  int val;
-  for (val = 0; val < this->GetSize(); ++val) {
-    if (comparator(key_[val],key)>0) break;
-  }
-  return val;
+  return KeyIndex(key, comparator);
 }
 
 /*****************************************************************************
@@ -216,7 +217,7 @@ page_id_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
  * The middle_key is the separation key you should get from the parent. You need
  * to make sure the middle key is added to the recipient to maintain the invariant.
  * You also need to use BufferPoolManager to persist changes to the parent page id for those
- * pages that are moved to the recipient
+ * pages that are moved to the recipient. The emptied page is deleted by the caller.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
@@ -235,8 +236,6 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
   }
    recipient->key_[recipient->GetSize()] = middle_key;
    recipient->IncreaseSize(this->GetSize()+1);
-  buffer_pool_manager->UnpinPage(this->GetPageId());
-  buffer_pool_manager->DeletePage(this->GetPageId());
 }
 
 /*****************************************************************************
@@ -272,11 +271,12 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *rec
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::destroy(BufferPoolManager* buffer_pool_manager){
   std::vector<page_id_t> children_page_id_;
-  buffer_pool_manager->UnpinPage(this->GetPageId());
   for(int i=0;i<this->GetSize()+1;++i){
     children_page_id_.push_back(this->ValueAt(i));
   }
-  buffer_pool_manager->DeletePage(this->GetPageId());
+  page_id_t page_id = this->GetPageId();
+  buffer_pool_manager->UnpinPage(page_id);
+  buffer_pool_manager->DeletePage(page_id);
   for(auto &it:children_page_id_){
     B_PLUS_TREE_INTERNAL_PAGE_TYPE* tree_page = reinterpret_cast<B_PLUS_TREE_INTERNAL_PAGE_TYPE*>(buffer_pool_manager->FetchPage(it)->GetData());
     if(tree_page->IsLeafPage()){
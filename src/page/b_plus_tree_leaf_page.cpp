@@ -10,7 +10,7 @@
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next/prev page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
@@ -21,6 +21,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, in
   this->SetSize(0);
   this->SetPageType(IndexPageType::LEAF_PAGE);
   this->SetNextPageId(INVALID_PAGE_ID);
+  this->SetPrevPageId(INVALID_PAGE_ID);
 }
 
 /**
@@ -36,17 +37,44 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
     this->next_page_id_ = next_page_id;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const {
+  return this->prev_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) {
+  this->prev_page_id_ = prev_page_id;
+}
+
+/**
+ * Helper method to find the first index i so that key_[i] >= key, by binary search
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::LowerBound(const KeyType &key, const KeyComparator &comparator) const {
+  int low = 0;
+  int high = this->GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    if (comparator(key_[mid], key) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
 /**
- * Helper method to find the first index i so that array_[i].first >= key
- * NOTE: This method is only used when generating index iterator
+ * Helper method to find the index of key, or the page size if it is not in the page
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
-  int i;
-  for (i = 0; i < this->GetSize(); ++i) {
-    if (comparator(key, key_[i]) == 0) break;
+  int i = LowerBound(key, comparator);
+  if (i < this->GetSize() && comparator(key_[i], key) == 0) {
+    return i;
   }
-  return i;
+  return this->GetSize();
 }
 INDEX_TEMPLATE_ARGUMENTS
 page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndReturnOnlyChild() {
@@ -86,18 +114,14 @@ ValueType B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const {return value_[in
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  int find_index;
-  // if (find_index != this->GetSize()) return this->GetSize();
-  for (find_index = 0; find_index < this->GetSize(); ++find_index) {
-    if (comparator(key_[find_index],key) >= 0){
-      if(comparator(key_[find_index],key)==0) return GetSize();
-      else break;
-    } 
-  } 
+  int find_index = LowerBound(key, comparator);
+  if (find_index < this->GetSize() && comparator(key_[find_index], key) == 0) {
+    // unique key
+    return this->GetSize();
+  }
+  std::copy_backward(key_ + find_index, key_ + this->GetSize(), key_ + this->GetSize() + 1);
+  std::copy_backward(value_ + find_index, value_ + this->GetSize(), value_ + this->GetSize() + 1);
   this->IncreaseSize(1);
-  int i;
-  for (i = this->GetSize() - 1; i > find_index; i--) key_[i] = key_[i - 1];
-  for (i = this->GetSize() - 1; i > find_index; i--) value_[i] = value_[i - 1];
   value_[find_index] = value;
   key_[find_index] = key;
   return this->GetSize();
@@ -107,7 +131,8 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs from this page to "recipient" page, which is linked in after this page. The
+ * prev link of the page after them is left to the caller.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient,KeyType &middle_key,BufferPoolManager *buffer_pool_manager){
@@ -125,6 +150,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient,
   recipient->SetSize(recipient_size);
   this->SetSize(local_size);
   recipient->next_page_id_ = this->next_page_id_;
+  recipient->prev_page_id_ = this->GetPageId();
   this->next_page_id_ = recipient->GetPageId();
   //return recipient->key_[0];
 
@@ -148,10 +174,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value, const KeyComparator &comparator) const {
-  int i;
-  for (i = 0; i < this->GetSize(); i++) {
-    if (comparator(key_[i], key) == 0) break;
-  }
+  int i = KeyIndex(key, comparator);
   if (i < this->GetSize()) {
     value = value_[i];
     return true;
@@ -171,12 +194,8 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value, co
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {int index = KeyIndex(key,comparator);
   if (index == this->GetSize()) return this->GetSize();
-  for (int i = index; i < this->GetSize() - 1; ++i) {
-    key_[i] = key_[i + 1];
-  }
-  for (int i = index; i < this->GetSize() - 1; ++i){
-    value_[i] = value_[i+1]; 
-   }
+  std::copy(key_ + index + 1, key_ + this->GetSize(), key_ + index);
+  std::copy(value_ + index + 1, value_ + this->GetSize(), value_ + index);
   this->IncreaseSize(-1);
    return this->GetSize();
  }
@@ -186,11 +205,12 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  *****************************************************************************/
 /*
  * Remove all of key & value pairs from this page to "recipient" page. Don't forget
- * to update the next_page id in the sibling page
+ * to update the next_page id in the sibling page. The emptied page is deleted by the caller, which also points the
+ * prev link of the page after it to the recipient.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient, const KeyType &middle_key,
-                                           BufferPoolManager *buffer_pool_manager_) {
+                                           BufferPoolManager *) {
     //recipient->IncreaseSize(this->GetSize());
   for (int i=recipient->GetSize();i<recipient->GetSize()+this->GetSize();++i){
       recipient->value_[i] = this->value_[i - recipient->GetSize()];
@@ -198,8 +218,6 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient, const K
    }
    recipient->next_page_id_ = this->GetNextPageId();
   recipient->IncreaseSize(this->GetSize());
-  buffer_pool_manager_->UnpinPage(this->GetPageId());
-  buffer_pool_manager_->DeletePage(this->GetPageId());
 }
 
 
@@ -1,26 +1,49 @@
+#include <cstring>
+
 #include "page/bitmap_page.h"
 #include "glog/logging.h"
 // #define ENABLE_BPM_DEBUG
+template<size_t PageSize>
+uint64_t BitmapPage<PageSize>::LoadWord(uint32_t word_index) const {
+  uint64_t word;
+  memcpy(&word, bytes + word_index * sizeof(uint64_t), sizeof(uint64_t));
+  // page 0 of a byte is its highest bit, byte swap on little endian so that the first page is the highest bit
+  return __builtin_bswap64(word);
+}
+
 template<size_t PageSize>
 bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset)
 {
     if (page_allocated_ == MAX_CHARS * 8) return 0;
+    // scan a word at a time starting from the hint, wrapping around once
+    uint32_t start = (next_free_page_ % (MAX_CHARS << 3)) / 64;
+    for (uint32_t i = 0; i <= MAX_WORDS; i++) {
+      uint32_t word_index = (start + i) % MAX_WORDS;
+      uint64_t free_bits = ~LoadWord(word_index);
+      if (free_bits == 0) continue;
+      page_offset = word_index * 64 + __builtin_clzll(free_bits);
+      break;
+    }
     page_allocated_++;
-    page_offset = next_free_page_;
-
     bytes[page_offset>>3] |= 1 << (7 - (page_offset & 0x7));
-    if(page_allocated_<MAX_CHARS * 8)
-    while (true) {
-      next_free_page_ = (next_free_page_ + 1) % (MAX_CHARS << 3);
-      if (IsPageFree(next_free_page_)) break;
-    }
-
+    next_free_page_ = page_offset;
     return 1;
 }
+
+template<size_t PageSize>
+uint32_t BitmapPage<PageSize>::CountAllocatedPages() const {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < MAX_WORDS; i++) {
+    count += __builtin_popcountll(LoadWord(i));
+  }
+  return count;
+}
+
 template<size_t PageSize>
 bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset) {
     if (IsPageFree(page_offset)) return 0;
-    next_free_page_ = page_offset;
+    // keep allocating from the lowest free page
+    if (page_offset < next_free_page_) next_free_page_ = page_offset;
 #ifdef ENABLE_BPM_DEBUG
       if(page_offset>=MAX_CHARS*8)
       {
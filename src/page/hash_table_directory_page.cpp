@@ -0,0 +1,92 @@
+#include "page/hash_table_directory_page.h"
+
+#include <unordered_map>
+
+#include "common/macros.h"
+
+void HashTableDirectoryPage::Init(page_id_t page_id, uint32_t max_depth) {
+  ASSERT(max_depth <= HASH_DIRECTORY_MAX_DEPTH, "Directory depth exceeds the page.");
+  page_id_ = page_id;
+  global_depth_ = 0;
+  max_depth_ = max_depth;
+  for (uint32_t i = 0; i < HASH_DIRECTORY_ARRAY_SIZE; i++) {
+    local_depths_[i] = 0;
+    bucket_page_ids_[i] = INVALID_PAGE_ID;
+  }
+}
+
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) const {
+  ASSERT(bucket_idx < Size(), "Bucket index out of range.");
+  return bucket_page_ids_[bucket_idx];
+}
+
+void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
+  ASSERT(bucket_idx < Size(), "Bucket index out of range.");
+  bucket_page_ids_[bucket_idx] = bucket_page_id;
+}
+
+uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) const {
+  uint32_t local_depth = GetLocalDepth(bucket_idx);
+  ASSERT(local_depth > 0, "A bucket of local depth 0 has no split image.");
+  return bucket_idx ^ (1U << (local_depth - 1));
+}
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  ASSERT(global_depth_ < max_depth_, "Directory is full.");
+  uint32_t size = Size();
+  for (uint32_t i = 0; i < size; i++) {
+    local_depths_[size + i] = local_depths_[i];
+    bucket_page_ids_[size + i] = bucket_page_ids_[i];
+  }
+  global_depth_++;
+}
+
+void HashTableDirectoryPage::DecrGlobalDepth() {
+  ASSERT(CanShrink(), "Directory cannot shrink.");
+  global_depth_--;
+}
+
+bool HashTableDirectoryPage::CanShrink() const {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  for (uint32_t i = 0; i < Size(); i++) {
+    if (local_depths_[i] == global_depth_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) const {
+  ASSERT(bucket_idx < Size(), "Bucket index out of range.");
+  return local_depths_[bucket_idx];
+}
+
+void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth) {
+  ASSERT(bucket_idx < Size(), "Bucket index out of range.");
+  ASSERT(local_depth <= global_depth_, "Local depth exceeds global depth.");
+  local_depths_[bucket_idx] = local_depth;
+}
+
+bool HashTableDirectoryPage::VerifyIntegrity() const {
+  std::unordered_map<page_id_t, uint32_t> slot_counts;
+  for (uint32_t i = 0; i < Size(); i++) {
+    uint32_t local_depth = local_depths_[i];
+    if (local_depth > global_depth_ || bucket_page_ids_[i] == INVALID_PAGE_ID) {
+      return false;
+    }
+    // slots which agree on the low local depth bits share the bucket and its depth
+    uint32_t first = i & ((1U << local_depth) - 1);
+    if (bucket_page_ids_[first] != bucket_page_ids_[i] || local_depths_[first] != local_depth) {
+      return false;
+    }
+    slot_counts[bucket_page_ids_[i]]++;
+  }
+  for (uint32_t i = 0; i < Size(); i++) {
+    if (slot_counts[bucket_page_ids_[i]] != 1U << (global_depth_ - local_depths_[i])) {
+      return false;
+    }
+  }
+  return true;
+}
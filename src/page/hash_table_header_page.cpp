@@ -0,0 +1,43 @@
+#include "page/hash_table_header_page.h"
+
+#include "common/macros.h"
+
+void HashTableHeaderPage::Init(page_id_t page_id) {
+  page_id_ = page_id;
+  global_depth_ = 0;
+  for (uint32_t i = 0; i < HASH_HEADER_ARRAY_SIZE; i++) {
+    local_depths_[i] = 0;
+    directory_page_ids_[i] = INVALID_PAGE_ID;
+  }
+}
+
+page_id_t HashTableHeaderPage::GetDirectoryPageId(uint32_t directory_idx) const {
+  ASSERT(directory_idx < Size(), "Directory index out of range.");
+  return directory_page_ids_[directory_idx];
+}
+
+void HashTableHeaderPage::SetDirectoryPageId(uint32_t directory_idx, page_id_t directory_page_id) {
+  ASSERT(directory_idx < Size(), "Directory index out of range.");
+  directory_page_ids_[directory_idx] = directory_page_id;
+}
+
+void HashTableHeaderPage::IncrGlobalDepth() {
+  ASSERT(global_depth_ < HASH_HEADER_MAX_DEPTH, "Header is full.");
+  uint32_t size = Size();
+  for (uint32_t i = 0; i < size; i++) {
+    local_depths_[size + i] = local_depths_[i];
+    directory_page_ids_[size + i] = directory_page_ids_[i];
+  }
+  global_depth_++;
+}
+
+uint32_t HashTableHeaderPage::GetLocalDepth(uint32_t directory_idx) const {
+  ASSERT(directory_idx < Size(), "Directory index out of range.");
+  return local_depths_[directory_idx];
+}
+
+void HashTableHeaderPage::SetLocalDepth(uint32_t directory_idx, uint32_t local_depth) {
+  ASSERT(directory_idx < Size(), "Directory index out of range.");
+  ASSERT(local_depth <= global_depth_, "Local depth exceeds global depth.");
+  local_depths_[directory_idx] = local_depth;
+}
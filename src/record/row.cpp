@@ -37,13 +37,17 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
   offset += sizeof(RowId);
   // get column count
   uint32_t column_count = schema->GetColumnCount();
-  if(column_count>fields_.capacity()) fields_.resize(column_count);
+  // a row deserialized again, e.g. by a table iterator, drops its old fields
+  if (heap_ == &own_heap_) {
+    own_heap_.Reset();
+  }
+  fields_.assign(column_count, nullptr);
   for (uint32_t i = 0; i < column_count; ++i) {
     bool is_null = MACH_READ_FROM(bool,buf+offset);
     offset += sizeof(bool);
     // if(is_null) continue;
     const Column *temp = schema->GetColumn(i);
-    offset += this->fields_[i]->DeserializeFrom(buf + offset, temp->GetType(), &fields_[i],is_null,
+    offset += Field::DeserializeFrom(buf + offset, temp->GetType(), &fields_[i],is_null,
     heap_);
   }
   return offset;
@@ -61,3 +65,13 @@ uint32_t Row::GetSerializedSize(Schema *schema) const {
   offset += sizeof(RowId);
   return offset;
 }
+
+Field *Row::CopyField(const Field &field) {
+  if (field.GetTypeId() != TypeId::kTypeChar || field.IsNull()) {
+    return ALLOC_P(heap_, Field)(field);
+  }
+  uint32_t len = field.GetLength();
+  char *data = static_cast<char *>(heap_->Allocate(len));
+  memcpy(data, field.GetData(), len);
+  return ALLOC_P(heap_, Field)(TypeId::kTypeChar, data, len, false);
+}
@@ -0,0 +1,74 @@
+#include <cstring>
+
+#include "record/row_view.h"
+
+Field RowView::GetField(uint32_t idx) const {
+  TypeId type = GetType(idx);
+  if (IsNull(idx)) {
+    return Field(type);
+  }
+  switch (type) {
+    case TypeId::kTypeInt:
+      return Field(type, GetInt(idx));
+    case TypeId::kTypeFloat:
+      return Field(type, GetFloat(idx));
+    case TypeId::kTypeChar:
+      return Field(type, const_cast<char *>(GetChars(idx)), GetCharLength(idx), false);
+    default:
+      ASSERT(false, "Unsupported field type.");
+      return Field(type);
+  }
+}
+
+std::string RowView::GetFieldString(uint32_t idx) const {
+  if (IsNull(idx)) {
+    return std::string();
+  }
+  switch (GetType(idx)) {
+    case TypeId::kTypeInt:
+      return std::to_string(GetInt(idx));
+    case TypeId::kTypeFloat:
+      return std::to_string(GetFloat(idx));
+    case TypeId::kTypeChar: {
+      // char data may or may not carry its terminating zero
+      const char *chars = GetChars(idx);
+      return std::string(chars, strnlen(chars, GetCharLength(idx)));
+    }
+    default:
+      ASSERT(false, "Unsupported field type.");
+      return std::string();
+  }
+}
+
+uint32_t RowView::FieldOffset(uint32_t idx) const {
+  ASSERT(idx <= GetFieldCount(), "Failed to access field");
+  if (idx < num_offsets_) {
+    return offsets_[idx];
+  }
+  // continue from the last known offset
+  uint32_t i = 0;
+  uint32_t offset = sizeof(RowId);
+  if (num_offsets_ > 0) {
+    i = num_offsets_ - 1;
+    offset = offsets_[i];
+  } else {
+    offsets_[num_offsets_++] = offset;
+  }
+  while (i < idx) {
+    bool is_null = MACH_READ_FROM(bool, data_ + offset);
+    offset += sizeof(bool);
+    if (!is_null) {
+      TypeId type = GetType(i);
+      if (type == TypeId::kTypeChar) {
+        offset += sizeof(uint32_t) + MACH_READ_UINT32(data_ + offset);
+      } else {
+        offset += Type::GetTypeSize(type);
+      }
+    }
+    i++;
+    if (i == num_offsets_ && num_offsets_ < MAX_CACHED_OFFSETS) {
+      offsets_[num_offsets_++] = offset;
+    }
+  }
+  return offset;
+}
@@ -246,7 +246,10 @@ uint32_t TypeChar::DeserializeFrom(char *storage, Field **field, bool is_null, M
     return 0;
   }
   uint32_t len = MACH_READ_UINT32(storage);
-  *field = ALLOC_P(heap, Field)(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
+  // the data lives in the heap as well, so the field needs no destructor
+  char *data = static_cast<char *>(heap->Allocate(len));
+  memcpy(data, storage + sizeof(uint32_t), len);
+  *field = ALLOC_P(heap, Field)(TypeId::kTypeChar, data, len, false);
   return len + sizeof(uint32_t);
 }
 
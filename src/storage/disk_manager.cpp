@@ -1,131 +1,214 @@
+#include <cerrno>
+#include <fcntl.h>
 #include <stdexcept>
 #include <sys/stat.h>
+#include <unistd.h>
 // #define ENABLE_BPM_DEBUG
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 #include "storage/disk_manager.h"
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
-  // std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw std::exception();
-    }
+DiskManager::DiskManager(const std::string &db_file, bool use_async_io) : file_name_(db_file) {
+  // directory or file does not exist, create a new file
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    throw std::exception();
   }
   ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  // rebuild the summary of extents with free pages
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  for (uint32_t i = 0; i < meta->GetExtentNums(); i++) {
+    if (meta->GetExtentUsedPage(i) < BITMAP_SIZE) {
+      free_extents_.insert(i);
+    }
+  }
+  if (use_async_io) {
+    io_uring_ = std::make_unique<IoUring>(DEFAULT_IO_QUEUE_DEPTH);
+    if (!io_uring_->IsValid()) {
+      io_uring_.reset();
+    }
+  }
+}
+
+void DiskManager::Sync() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (closed) {
+    return;
+  }
+  FlushBitmaps();
+  WritePhysicalPage(META_PAGE_ID, meta_data_);
+  if (fsync(db_fd_) != 0) {
+    LOG(ERROR) << "I/O error while syncing";
+  }
 }
 
 void DiskManager::Close() {
-  // std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if (!closed) {
-    db_io_.close();
+    FlushBitmaps();
+    WritePhysicalPage(META_PAGE_ID, meta_data_);
+    close(db_fd_);
+    db_fd_ = -1;
     closed = true;
   }
 }
 
 void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
-  // assert(false);
+  num_reads_++;
   ReadPhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
 void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
   ASSERT(logical_page_id >= 0, "Invalid page id.");
+  num_writes_++;
   WritePhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
-page_id_t DiskManager::AllocatePage() {
-
-    DiskFileMetaPage* meta = reinterpret_cast<DiskFileMetaPage*> (meta_data_);
-    // check if full
-    if(meta->GetAllocatedPages()==MAX_VALID_PAGE_ID) {
-
-      return INVALID_PAGE_ID;
+void DiskManager::BatchPageIO(std::vector<PageIORequest> &requests, size_t queue_depth) {
+  for (auto &request : requests) {
+    ASSERT(request.page_id_ >= 0, "Invalid page id.");
+    if (request.is_write_) {
+      num_writes_++;
+    } else {
+      num_reads_++;
     }
-    meta->num_allocated_pages_++;
-    uint32_t i;
-    // max pages of an extent
-    uint32_t extent_capacity = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
-    // search an available extent
-    uint32_t extent_id;
-    // check if the exist extent has an available page
-    for(i=0;i<meta->GetExtentNums();i++)
-    {
-      if(meta->GetExtentUsedPage(i)<extent_capacity) break;
+  }
+  // the ring is torn down under the latch when it breaks down, so it is only looked at while holding it
+  std::unique_lock<std::mutex> guard(io_uring_latch_);
+  if (io_uring_ == nullptr || queue_depth <= 1) {
+    guard.unlock();
+    for (auto &request : requests) {
+      if (request.is_write_) {
+        WritePhysicalPage(MapPageId(request.page_id_), request.data_);
+      } else {
+        ReadPhysicalPage(MapPageId(request.page_id_), request.data_);
+      }
     }
-    if(i==meta->GetExtentNums())
-    {
-      // the current extent all full
-
-      // create new extent
-      extent_id = meta->num_extents_ ++ ;
+    return;
+  }
+  queue_depth = std::min<size_t>(queue_depth, io_uring_->GetEntries());
+  size_t next = 0, in_flight = 0;
+  while (next < requests.size() || in_flight > 0) {
+    // fill the queue
+    while (next < requests.size() && in_flight < queue_depth) {
+      PageIORequest &request = requests[next];
+      off_t offset = static_cast<off_t>(MapPageId(request.page_id_)) * PAGE_SIZE;
+      if (!io_uring_->Prepare(db_fd_, request.is_write_, request.data_, PAGE_SIZE, offset, next)) {
+        break;
+      }
+      next++;
+      in_flight++;
     }
-    else 
-    {
-
-      extent_id = i;
+    if (!io_uring_->Submit(1)) {
+      LOG(ERROR) << "io_uring submission failed, falling back to synchronous I/O";
+      break;
     }
-    // generate meta
-    uint32_t bitmap_physical_id = 1 + extent_id * (1 + extent_capacity);
-#ifdef ENABLE_BPM_DEBUG
-      LOG(WARNING) <<"!!!the bitmap page : "<<bitmap_physical_id<<"!!!\n";
-#endif
-    // read in bit map
-
-    char bitmap_contrnt[PAGE_SIZE];
-    ReadPhysicalPage(bitmap_physical_id,bitmap_contrnt);
-    // create bitmap
-    BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bitmap_contrnt);
-    // get page from bitmap
-    (meta->extent_used_page_[extent_id])++;
-    uint32_t page_id_in_extent;
-
-    bitmap->AllocatePage(page_id_in_extent);
-    // write back
+    uint64_t index;
+    int32_t res;
+    while (io_uring_->PopCompletion(&index, &res)) {
+      in_flight--;
+      PageIORequest &request = requests[index];
+      if (res == PAGE_SIZE) {
+        continue;
+      }
+      // short transfer (e.g. read beyond the end of file) or error, redo it synchronously
+      if (request.is_write_) {
+        WritePhysicalPage(MapPageId(request.page_id_), request.data_);
+      } else {
+        ReadPhysicalPage(MapPageId(request.page_id_), request.data_);
+      }
+    }
+  }
+  if (in_flight > 0 || next < requests.size()) {
+    // the ring broke down, drain what is left synchronously; requests in flight are simply repeated
+    io_uring_.reset();
+    guard.unlock();
+    for (size_t i = 0; i < requests.size(); i++) {
+      if (requests[i].is_write_) {
+        WritePhysicalPage(MapPageId(requests[i].page_id_), requests[i].data_);
+      } else {
+        ReadPhysicalPage(MapPageId(requests[i].page_id_), requests[i].data_);
+      }
+    }
+  }
+}
 
-    WritePhysicalPage(bitmap_physical_id,bitmap_contrnt);
+bool DiskManager::IsAsyncIOEnabled() {
+  std::lock_guard<std::mutex> guard(io_uring_latch_);
+  return io_uring_ != nullptr;
+}
 
-    // assert(extent_capacity * extent_id + page_id_in_extent!=523264);
-    return extent_capacity * extent_id + page_id_in_extent;
+page_id_t DiskManager::AllocatePage() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  // check if full
+  if (meta->GetAllocatedPages() == MAX_VALID_PAGE_ID) {
+    return INVALID_PAGE_ID;
+  }
+  uint32_t extent_id;
+  if (free_extents_.empty()) {
+    // all existing extents are full, create a new extent
+    extent_id = meta->num_extents_++;
+    free_extents_.insert(extent_id);
+  } else {
+    // first fit keeps the file compact
+    extent_id = *free_extents_.begin();
+  }
+  uint32_t page_id_in_extent;
+  if (!GetBitmap(extent_id)->AllocatePage(page_id_in_extent)) {
+    ASSERT(false, "Extent summary out of sync with bitmap.");
+    return INVALID_PAGE_ID;
+  }
+  bitmap_dirty_[extent_id] = true;
+  meta->num_allocated_pages_++;
+  if (++meta->extent_used_page_[extent_id] == BITMAP_SIZE) {
+    free_extents_.erase(extent_id);
+  }
+  return BITMAP_SIZE * extent_id + page_id_in_extent;
 }
 
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
-    // generate meta
-    DiskFileMetaPage* meta = reinterpret_cast<DiskFileMetaPage*> (meta_data_);
-    if(logical_page_id>=MAX_VALID_PAGE_ID) return ;
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage *meta = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  if (logical_page_id >= MAX_VALID_PAGE_ID) return;
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  if (extent_id >= meta->GetExtentNums()) return;
+  if (GetBitmap(extent_id)->DeAllocatePage(logical_page_id % BITMAP_SIZE)) {
+    bitmap_dirty_[extent_id] = true;
     meta->num_allocated_pages_--;
-    uint32_t extent_capacity = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
-    uint32_t extent_id = logical_page_id / extent_capacity;
-    char bitmap_content[PAGE_SIZE];
-    uint32_t bitmap_physical_id = 1 + extent_id * (1 + extent_capacity);
-    ReadPhysicalPage(bitmap_physical_id,bitmap_content);
-    BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bitmap_content);    
-    uint32_t page_id_in_extent = logical_page_id % extent_capacity;
-    if(bitmap->DeAllocatePage(page_id_in_extent))
-    {
-      meta->extent_used_page_[extent_id]--;
-    }
-    // write back
-
-    WritePhysicalPage(bitmap_physical_id,bitmap_content);
-    // WritePhysicalPage(0,meta_data_);
+    meta->extent_used_page_[extent_id]--;
+    free_extents_.insert(extent_id);
+  }
 }
 
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
-  uint32_t extent_capacity = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
-  uint32_t extent_id = logical_page_id / extent_capacity;
-  uint32_t bitmap_physical_id = 1 + extent_id * (1 + extent_capacity);
-  char bitmap_content[PAGE_SIZE];
-  ReadPhysicalPage(bitmap_physical_id,bitmap_content);
-  BitmapPage<PAGE_SIZE>* bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(bitmap_content);  
-  return bitmap->IsPageFree(logical_page_id % extent_capacity);
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  if (extent_id >= reinterpret_cast<DiskFileMetaPage *>(meta_data_)->GetExtentNums()) {
+    return true;
+  }
+  return GetBitmap(extent_id)->IsPageFree(logical_page_id % BITMAP_SIZE);
+}
+
+BitmapPage<PAGE_SIZE> *DiskManager::GetBitmap(uint32_t extent_id) {
+  if (extent_id >= bitmaps_.size()) {
+    bitmaps_.resize(extent_id + 1);
+    bitmap_dirty_.resize(extent_id + 1, false);
+  }
+  if (bitmaps_[extent_id] == nullptr) {
+    bitmaps_[extent_id] = std::make_unique<char[]>(PAGE_SIZE);
+    ReadPhysicalPage(1 + extent_id * (1 + BITMAP_SIZE), bitmaps_[extent_id].get());
+  }
+  return reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmaps_[extent_id].get());
+}
+
+void DiskManager::FlushBitmaps() {
+  for (uint32_t extent_id = 0; extent_id < bitmaps_.size(); extent_id++) {
+    if (bitmap_dirty_[extent_id]) {
+      WritePhysicalPage(1 + extent_id * (1 + BITMAP_SIZE), bitmaps_[extent_id].get());
+      bitmap_dirty_[extent_id] = false;
+    }
+  }
 }
 
 page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
@@ -149,44 +232,39 @@ long signed int DiskManager::GetFileSize(const std::string &file_name) {
 }
 
 void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  long signed int offset = static_cast<long signed int>(physical_page_id) * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
-#ifdef ENABLE_BPM_DEBUG
-    LOG(INFO) << "Read less than a page" << std::endl;
-#endif
-    memset(page_data, 0, PAGE_SIZE);
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-#ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
-#endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  off_t offset = static_cast<off_t>(physical_page_id) * PAGE_SIZE;
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t res = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    if (res <= 0) {
+      // read beyond file length or I/O error
+      break;
     }
+    read_count += res;
   }
+  if (read_count < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "read over" << std::endl;
+    LOG(INFO) << "Read less than a page" << std::endl;
 #endif
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
 }
 
 void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG(ERROR) << "I/O error while writing";
-    return;
+  off_t offset = static_cast<off_t>(physical_page_id) * PAGE_SIZE;
+  size_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t res = pwrite(db_fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    if (res <= 0) {
+      LOG(ERROR) << "I/O error while writing";
+      return;
+    }
+    write_count += res;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
-#ifdef ENABLE_BPM_DEBUG
-  LOG(INFO) <<"write successfully\n";
-#endif
-}
\ No newline at end of file
+}
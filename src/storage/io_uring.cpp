@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "storage/io_uring.h"
+
+static int IoUringSetup(uint32_t entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int IoUringEnter(int ring_fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+IoUring::IoUring(uint32_t entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IoUringSetup(entries, &params);
+  if (ring_fd < 0) {
+    return;
+  }
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                 IORING_OFF_SQ_RING);
+  if (sq_ptr_ == MAP_FAILED) {
+    sq_ptr_ = nullptr;
+    close(ring_fd);
+    return;
+  }
+  if (single_mmap) {
+    cq_ptr_ = sq_ptr_;
+  } else {
+    cq_ptr_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                   IORING_OFF_CQ_RING);
+    if (cq_ptr_ == MAP_FAILED) {
+      cq_ptr_ = nullptr;
+      munmap(sq_ptr_, sq_ring_size_);
+      sq_ptr_ = nullptr;
+      close(ring_fd);
+      return;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                    IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    if (cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_ring_size_);
+    }
+    munmap(sq_ptr_, sq_ring_size_);
+    sq_ptr_ = cq_ptr_ = nullptr;
+    close(ring_fd);
+    return;
+  }
+  sqes_ = reinterpret_cast<io_uring_sqe *>(sqes);
+  char *sq = reinterpret_cast<char *>(sq_ptr_);
+  sq_head_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<uint32_t *>(sq + params.sq_off.array);
+  char *cq = reinterpret_cast<char *>(cq_ptr_);
+  cq_head_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<uint32_t *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  sq_entries_ = params.sq_entries;
+  ring_fd_ = ring_fd;
+}
+
+IoUring::~IoUring() {
+  if (!IsValid()) {
+    return;
+  }
+  munmap(sqes_, sqes_size_);
+  if (cq_ptr_ != sq_ptr_) {
+    munmap(cq_ptr_, cq_ring_size_);
+  }
+  munmap(sq_ptr_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+bool IoUring::Prepare(int fd, bool is_write, char *buf, uint32_t len, off_t offset, uint64_t user_data) {
+  uint32_t head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  uint32_t tail = *sq_tail_;
+  if (tail - head >= sq_entries_) {
+    return false;
+  }
+  uint32_t index = tail & *sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(io_uring_sqe));
+  sqe->opcode = is_write ? IORING_OP_WRITE : IORING_OP_READ;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buf);
+  sqe->len = len;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+  // the entry must be visible before the kernel sees the new tail
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  to_submit_++;
+  return true;
+}
+
+bool IoUring::Submit(uint32_t min_complete) {
+  while (true) {
+    int res = IoUringEnter(ring_fd_, to_submit_, min_complete, min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+    if (res < 0 && errno == EINTR) {
+      continue;
+    }
+    if (res < 0) {
+      return false;
+    }
+    to_submit_ -= static_cast<uint32_t>(res) < to_submit_ ? res : to_submit_;
+    return true;
+  }
+}
+
+bool IoUring::PopCompletion(uint64_t *user_data, int32_t *res) {
+  uint32_t head = *cq_head_;
+  if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+  io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+  *user_data = cqe->user_data;
+  *res = cqe->res;
+  __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
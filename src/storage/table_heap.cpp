@@ -1,58 +1,65 @@
+#include <algorithm>
+
 #include "storage/table_heap.h"
 #include "glog/logging.h"
 // #define ENABLE_BPM_DEBUG
 bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
-  // assert(row.GetSerializedSize()<PAGE_SIZE);
-
-  page_id_t temp_page_id = this->first_page_id_;
-  // assert(false);
-  TablePage *table_page_ptr = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_)->GetData());
-  buffer_pool_manager_->UnpinPage(first_page_id_);
-  assert(table_page_ptr!=nullptr);
-  // search an availble table page
-  if(table_page_ptr->GetPrevPageId()!=INVALID_PAGE_ID){
-    table_page_ptr->Init(temp_page_id,INVALID_PAGE_ID,log_manager_,txn);
+  uint32_t serialized_size = row.GetSerializedSize(schema_);
+  if (serialized_size > TablePage::SIZE_MAX_ROW) {
+    return false;
   }
-  while (1) {
-
-    // try to insert
-    if(table_page_ptr->InsertTuple(row,schema_,txn,lock_manager_,log_manager_)) break;
-    // assert(false);
-
-    // check next page
-    if (table_page_ptr->GetNextPageId() == INVALID_PAGE_ID) {
-
-      // allocate new page
-      page_id_t new_page_id;
-      TablePage *new_page_ptr = reinterpret_cast<TablePage*>(buffer_pool_manager_->NewPage(new_page_id));
-      // assert(new_page_ptr!=nullptr);
-      if (!new_page_ptr) {
-
-        return false;
-      }
-      table_page_ptr->SetNextPageId(new_page_id);
-      new_page_ptr->Init(new_page_id, temp_page_id, log_manager_, txn);
-      // insert in new page
-      // assert(false);
-      if (!new_page_ptr->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
-
-        assert(false);
-      }
-      buffer_pool_manager_->UnpinPage(new_page_id);
+  uint32_t needed = TablePage::SpaceNeededFor(serialized_size);
+  while (true) {
+    uint32_t index;
+    if (!FindPageWithSpace(needed, &index) && !AppendPage(txn, &index)) {
+      return false;
+    }
+    page_id_t page_id = GetMapEntryPageId(index);
+    auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      return false;
+    }
+    page->WLatch();
+    bool inserted = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+    uint32_t free_space = page->GetFreeSpaceRemaining();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    // the map is only a hint, correct it if the page turned out to be too full
+    UpdateFreeSpace(page_id, free_space);
+    if (inserted) {
       return true;
     }
-    // search next page
-    // assert(false);
-    page_id_t temp_id = temp_page_id;
-    temp_page_id = table_page_ptr->GetNextPageId();
-    table_page_ptr = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(temp_page_id)->GetData());
-    buffer_pool_manager_->UnpinPage(temp_page_id);
-    buffer_pool_manager_->UnpinPage(temp_id);
   }
-  // write in
+}
+
+bool TableHeap::InsertTuples(std::vector<Row> &rows, Transaction *txn) {
+  size_t next = 0;
+  while (next < rows.size()) {
+    uint32_t serialized_size = rows[next].GetSerializedSize(schema_);
+    if (serialized_size > TablePage::SIZE_MAX_ROW) {
+      return false;
+    }
+    uint32_t index;
+    if (!FindPageWithSpace(TablePage::SpaceNeededFor(serialized_size), &index) && !AppendPage(txn, &index)) {
+      return false;
+    }
+    page_id_t page_id = GetMapEntryPageId(index);
+    auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      return false;
+    }
+    // fill the page with as many rows as fit
+    size_t first = next;
+    page->WLatch();
+    while (next < rows.size() && page->InsertTuple(rows[next], schema_, txn, lock_manager_, log_manager_)) {
+      next++;
+    }
+    uint32_t free_space = page->GetFreeSpaceRemaining();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, next > first);
+    UpdateFreeSpace(page_id, free_space);
+  }
   return true;
-  // return table_page_ptr->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
-  // return false;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
@@ -74,9 +81,14 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
   page_id_t page_id = rid.GetPageId();
   // uint32_t slot_num = rid.GetSlotNum();
   TablePage *table_page_ptr = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-  buffer_pool_manager_->UnpinPage(page_id, true);
   Row temp_row(rid);
+  table_page_ptr->WLatch();
   int res =  table_page_ptr->UpdateTuple(row, &temp_row, schema_, txn, lock_manager_, log_manager_);
+  uint32_t free_space = table_page_ptr->GetFreeSpaceRemaining();
+  table_page_ptr->WUnlatch();
+  // the page is only written back once it is unpinned, so it must not be modified after the unpin
+  buffer_pool_manager_->UnpinPage(page_id, res == 1);
+  UpdateFreeSpace(page_id, free_space);
   if(res == 1) return true;
   if(res == 0) return false;
   this->MarkDelete(row.GetRowId(),txn);
@@ -91,6 +103,9 @@ void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   // uint32_t slot_num = rid.GetSlotNum();
   TablePage *table_page_ptr = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
   table_page_ptr->ApplyDelete(rid,txn,log_manager_);
+  uint32_t free_space = table_page_ptr->GetFreeSpaceRemaining();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  UpdateFreeSpace(page_id, free_space);
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
@@ -112,43 +127,258 @@ void TableHeap::FreeHeap() {
     page_ptr = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page_id));
     pre = page_id;
     page_id = page_ptr->GetNextPageId();
+    // a pinned page is not deleted
+    buffer_pool_manager_->UnpinPage(pre, false);
     buffer_pool_manager_->DeletePage(pre);
   }
+  FreeFreeSpaceMap();
 }
 
 bool TableHeap::GetTuple(Row *row, Transaction *txn) { 
   page_id_t page_id = row->GetRowId().GetPageId();
   // uint32_t slot_num = row->GetRowId().GetSlotNum();
   TablePage *table_page_ptr = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-  return table_page_ptr->GetTuple(row,schema_,txn,lock_manager_);
-
+  if (table_page_ptr == nullptr) {
+    return false;
+  }
+  table_page_ptr->RLatch();
+  bool res = table_page_ptr->GetTuple(row,schema_,txn,lock_manager_);
+  table_page_ptr->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return res;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) 
+TableIterator TableHeap::Begin(Transaction *txn, bool use_scan_ring) 
 { 
+  std::shared_ptr<BufferRing> ring = use_scan_ring ? std::make_shared<BufferRing>() : nullptr;
   page_id_t page_id = first_page_id_;
   TablePage* table_page_ptr = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
-  buffer_pool_manager_->UnpinPage(first_page_id_,false);
-  RowId temp;
-  if(table_page_ptr->GetPrevPageId()!=INVALID_PAGE_ID){
+  bool reset = table_page_ptr->GetPrevPageId()!=INVALID_PAGE_ID;
+  if(reset){
     table_page_ptr -> Init(first_page_id_,INVALID_PAGE_ID,this->log_manager_,txn);
   }
+  buffer_pool_manager_->UnpinPage(first_page_id_,reset);
+  RowId temp;
   while(page_id!=INVALID_PAGE_ID){
-    table_page_ptr = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
-    buffer_pool_manager_->UnpinPage(page_id);
-    if(!table_page_ptr->GetFirstTupleRid(&temp)){
-        page_id = table_page_ptr->GetNextPageId();
+    table_page_ptr = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id,ring.get())->GetData());
+    if(table_page_ptr->GetFirstTupleRid(&temp)){
+      break;
     }
-    else break;
+    page_id_t next_page_id = table_page_ptr->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
   }
   if(temp.Get()==INVALID_ROWID.Get()) return TableIterator(nullptr,this,nullptr);
   Row* row_ = new Row(temp);
-  // table_page_ptr->GetTuple(row_,schema_,txn,lock_manager_);
   table_page_ptr->GetTuple(row_,schema_,txn,lock_manager_);
-  return TableIterator(row_,this,txn); 
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return TableIterator(row_,this,txn,ring); 
 }
 
 TableIterator TableHeap::End() 
 { 
   return TableIterator(nullptr,this,nullptr); 
 }
+
+
+void TableHeap::BuildFreeSpaceMap() {
+  auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(fsm_page_id_)->GetData());
+  map_page->Init();
+  page_id_t map_page_id = fsm_page_id_;
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page_id == first_page_id_ && page->GetPrevPageId() != INVALID_PAGE_ID) {
+      // the first page of a new table is created zeroed by the catalog
+      page->Init(first_page_id_, INVALID_PAGE_ID, log_manager_, nullptr);
+    }
+    uint8_t category = FreeSpaceMapPage::ToCategory(page->GetFreeSpaceRemaining());
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, page_id == first_page_id_);
+    if (map_page->IsFull()) {
+      page_id_t new_map_page_id;
+      auto *new_map_page =
+          reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(new_map_page_id)->GetData());
+      new_map_page->Init();
+      map_page->SetNextPageId(new_map_page_id);
+      buffer_pool_manager_->UnpinPage(map_page_id, true);
+      map_page = new_map_page;
+      map_page_id = new_map_page_id;
+    }
+    map_page->Append(page_id, category);
+    page_id = next_page_id;
+  }
+  buffer_pool_manager_->UnpinPage(map_page_id, true);
+}
+
+void TableHeap::LoadFreeSpaceMap() {
+  fsm_pages_.clear();
+  fsm_max_.clear();
+  fsm_index_.clear();
+  fsm_count_ = 0;
+  page_id_t map_page_id = fsm_page_id_;
+  while (map_page_id != INVALID_PAGE_ID) {
+    auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id)->GetData());
+    uint8_t max_category = 0;
+    for (uint32_t i = 0; i < map_page->GetCount(); i++) {
+      fsm_index_[map_page->GetHeapPageId(i)] = fsm_count_ + i;
+      max_category = std::max(max_category, map_page->GetCategory(i));
+    }
+    fsm_pages_.push_back(map_page_id);
+    fsm_max_.push_back(max_category);
+    fsm_count_ += map_page->GetCount();
+    page_id_t next_map_page_id = map_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(map_page_id, false);
+    map_page_id = next_map_page_id;
+  }
+  ASSERT(fsm_count_ > 0, "Free space map must cover the first page.");
+  // appends go to the tail, start looking there
+  last_index_ = fsm_count_ - 1;
+}
+
+void TableHeap::FreeFreeSpaceMap() {
+  for (auto map_page_id : fsm_pages_) {
+    buffer_pool_manager_->DeletePage(map_page_id);
+  }
+  fsm_pages_.clear();
+  fsm_max_.clear();
+  fsm_index_.clear();
+  fsm_count_ = 0;
+}
+
+bool TableHeap::FindPageWithSpace(uint32_t needed, uint32_t *index) {
+  uint32_t required = FreeSpaceMapPage::ToRequiredCategory(needed);
+  // try the page of the last insert first, consecutive inserts mostly go to the same page
+  {
+    page_id_t map_page_id = fsm_pages_[last_index_ / FreeSpaceMapPage::MAX_ENTRY_COUNT];
+    auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id)->GetData());
+    bool fits = map_page->GetCategory(last_index_ % FreeSpaceMapPage::MAX_ENTRY_COUNT) >= required;
+    buffer_pool_manager_->UnpinPage(map_page_id, false);
+    if (fits) {
+      *index = last_index_;
+      return true;
+    }
+  }
+  // skip the map pages which can not have a page with enough room
+  for (uint32_t i = 0; i < fsm_pages_.size(); i++) {
+    if (fsm_max_[i] < required) {
+      continue;
+    }
+    auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_pages_[i])->GetData());
+    uint8_t max_category = 0;
+    for (uint32_t j = 0; j < map_page->GetCount(); j++) {
+      if (map_page->GetCategory(j) >= required) {
+        buffer_pool_manager_->UnpinPage(fsm_pages_[i], false);
+        *index = last_index_ = i * FreeSpaceMapPage::MAX_ENTRY_COUNT + j;
+        return true;
+      }
+      max_category = std::max(max_category, map_page->GetCategory(j));
+    }
+    buffer_pool_manager_->UnpinPage(fsm_pages_[i], false);
+    // the bound was stale, tighten it
+    fsm_max_[i] = max_category;
+  }
+  return false;
+}
+
+bool TableHeap::AppendPage(Transaction *txn, uint32_t *index) {
+  page_id_t tail_page_id = GetMapEntryPageId(fsm_count_ - 1);
+  page_id_t new_page_id;
+  auto *new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+  if (new_page == nullptr) {
+    return false;
+  }
+  new_page->Init(new_page_id, tail_page_id, log_manager_, txn);
+  uint8_t category = FreeSpaceMapPage::ToCategory(new_page->GetFreeSpaceRemaining());
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  auto *tail_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(tail_page_id));
+  tail_page->SetNextPageId(new_page_id);
+  buffer_pool_manager_->UnpinPage(tail_page_id, true);
+  // register in the map, chaining a new map page if the last one is full
+  page_id_t map_page_id = fsm_pages_.back();
+  auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id)->GetData());
+  if (map_page->IsFull()) {
+    page_id_t new_map_page_id;
+    Page *page = buffer_pool_manager_->NewPage(new_map_page_id);
+    if (page == nullptr) {
+      buffer_pool_manager_->UnpinPage(map_page_id, false);
+      return false;
+    }
+    map_page->SetNextPageId(new_map_page_id);
+    buffer_pool_manager_->UnpinPage(map_page_id, true);
+    map_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+    map_page->Init();
+    map_page_id = new_map_page_id;
+    fsm_pages_.push_back(map_page_id);
+    fsm_max_.push_back(0);
+  }
+  map_page->Append(new_page_id, category);
+  buffer_pool_manager_->UnpinPage(map_page_id, true);
+  fsm_max_.back() = std::max(fsm_max_.back(), category);
+  fsm_index_[new_page_id] = fsm_count_;
+  *index = last_index_ = fsm_count_++;
+  return true;
+}
+
+std::vector<page_id_t> TableHeap::GetPageIds() {
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(fsm_count_);
+  for (auto map_page_id : fsm_pages_) {
+    auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id)->GetData());
+    for (uint32_t i = 0; i < map_page->GetCount(); i++) {
+      page_ids.push_back(map_page->GetHeapPageId(i));
+    }
+    buffer_pool_manager_->UnpinPage(map_page_id, false);
+  }
+  return page_ids;
+}
+
+void TableHeap::ScanPages(const std::vector<page_id_t> &page_ids, size_t begin, size_t end,
+                          const std::function<void(const RowView &)> &visit) {
+  BufferRing ring;
+  RowView view;
+  for (size_t i = begin; i < end; i++) {
+    auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_ids[i], &ring));
+    ASSERT(page != nullptr, "Failed to fetch table page.");
+    // the pin keeps the page in its frame, the latch keeps writers out
+    page->RLatch();
+    RowId rid;
+    RowId next_rid;
+    bool found = page->GetFirstTupleRid(&rid);
+    while (found) {
+      if (page->GetTupleView(rid, schema_, &view)) {
+        visit(view);
+      }
+      found = page->GetNextTupleRid(rid, &next_rid);
+      rid = next_rid;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_ids[i], false);
+  }
+}
+
+page_id_t TableHeap::GetMapEntryPageId(uint32_t index) {
+  page_id_t map_page_id = fsm_pages_[index / FreeSpaceMapPage::MAX_ENTRY_COUNT];
+  auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id)->GetData());
+  page_id_t page_id = map_page->GetHeapPageId(index % FreeSpaceMapPage::MAX_ENTRY_COUNT);
+  buffer_pool_manager_->UnpinPage(map_page_id, false);
+  return page_id;
+}
+
+void TableHeap::UpdateFreeSpace(page_id_t page_id, uint32_t free_bytes) {
+  auto it = fsm_index_.find(page_id);
+  if (it == fsm_index_.end()) {
+    return;
+  }
+  uint32_t map_index = it->second / FreeSpaceMapPage::MAX_ENTRY_COUNT;
+  uint32_t slot = it->second % FreeSpaceMapPage::MAX_ENTRY_COUNT;
+  uint8_t category = FreeSpaceMapPage::ToCategory(free_bytes);
+  page_id_t map_page_id = fsm_pages_[map_index];
+  auto *map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id)->GetData());
+  bool changed = map_page->GetCategory(slot) != category;
+  if (changed) {
+    map_page->SetCategory(slot, category);
+  }
+  buffer_pool_manager_->UnpinPage(map_page_id, changed);
+  fsm_max_[map_index] = std::max(fsm_max_[map_index], category);
+}
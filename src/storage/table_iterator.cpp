@@ -2,17 +2,27 @@
 #include "storage/table_iterator.h"
 #include "storage/table_heap.h"
 
-TableIterator::TableIterator(Row* row_,TableHeap* _table_heap_,Transaction* _txn_) :content(row_),table_heap_(_table_heap_),txn_(_txn_)
+TableIterator::TableIterator(Row* row_,TableHeap* _table_heap_,Transaction* _txn_,std::shared_ptr<BufferRing> ring)
+    :content(row_),table_heap_(_table_heap_),txn_(_txn_),ring_(std::move(ring))
 {}
 
 TableIterator::TableIterator(const TableIterator &other) {
   content = other.content;
   table_heap_ = other.table_heap_;
   txn_ = other.txn_;
+  ring_ = other.ring_;
+  pages_crossed_ = other.pages_crossed_;
+  loaded_ = other.loaded_;
+  // every iterator holds its own pin on the current page
+  if (other.page_ != nullptr) {
+    page_ = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(other.page_->GetTablePageId()));
+  }
 }
 
 TableIterator::~TableIterator() {
-  // default
+  if (page_ != nullptr) {
+    table_heap_->buffer_pool_manager_->UnpinPage(page_->GetTablePageId(), false);
+  }
 }
 
 bool TableIterator::operator==(const TableIterator &itr) const {
@@ -25,42 +35,68 @@ bool TableIterator::operator!=(const TableIterator &itr) const {
 
 const Row &TableIterator::operator*() {
   assert(*this!=table_heap_->End());
+  if (!loaded_) {
+    Load();
+  }
   return *content;
 }
 
 Row *TableIterator::operator->() {
   assert(*this!=table_heap_->End());
+  if (!loaded_) {
+    Load();
+  }
   return content;
 }
 
+const RowView &TableIterator::View() {
+  assert(*this!=table_heap_->End());
+  if (!CurrentPage()->GetTupleView(content->GetRowId(), table_heap_->schema_, &view_)) {
+    view_.Reset(nullptr, nullptr, RowId());
+  }
+  return view_;
+}
+
+void TableIterator::Load() {
+  CurrentPage()->GetTuple(content, table_heap_->schema_, txn_, table_heap_->lock_manager_);
+  loaded_ = true;
+}
+
+TablePage *TableIterator::CurrentPage() {
+  if (page_ == nullptr) {
+    page_id_t page_id = content->GetRowId().GetPageId();
+    page_ = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(page_id, ring_.get()));
+    assert(page_ != nullptr);
+  }
+  return page_;
+}
+
 TableIterator &TableIterator::operator++() {
   assert(*this!=table_heap_->End());
   BufferPoolManager* buffer_pool_manager_ = table_heap_->buffer_pool_manager_;
-  page_id_t page_id = content->GetRowId().GetPageId();
   // uint32_t slot_num = content->GetRowId().GetSlotNum();
-  TablePage* page_ptr = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page_id));
-  buffer_pool_manager_->UnpinPage(page_id);
-  assert(page_ptr!=nullptr);
+  TablePage* page_ptr = CurrentPage();
   RowId next_row_id;
   while(!page_ptr->GetNextTupleRid(content->GetRowId(),&next_row_id)){
     // current page's end, next page
-    page_id = page_ptr->GetNextPageId();
+    page_id_t page_id = page_ptr->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_ptr->GetTablePageId(), false);
+    page_ = nullptr;
     if(page_id==INVALID_PAGE_ID){
       content = nullptr;
       txn_ = nullptr;
       return *this;
     }
-    page_ptr = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page_id)->GetData());
-    buffer_pool_manager_->UnpinPage(page_id);
+    page_ptr = page_ = reinterpret_cast<TablePage*>(buffer_pool_manager_->FetchPage(page_id,ring_.get())->GetData());
+    if(++pages_crossed_>=SEQUENTIAL_SCAN_THRESHOLD){
+      buffer_pool_manager_->Prefetch(page_id,&TablePage::NextPageIdOf);
+    }
     // next_row_id.Set(page_id,-1);
     content->SetRowId(RowId(page_id,-1));
   }
-  // get next row id
+  // get next row id, the tuple itself is read on demand
   content->SetRowId(next_row_id);
-  if(!page_ptr->GetTuple(content,table_heap_->schema_,txn_,table_heap_->lock_manager_)){
-    content = nullptr;
-    txn_ = nullptr;
-  }
+  loaded_ = false;
   return *this;
 }
 
@@ -0,0 +1,116 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+static const std::string db_name = "bpm_concurrency_test.db";
+
+/**
+ * Every thread repeatedly fetches a random resident page, checks its content and unpins it.
+ * The working set fits into the pool, so the benchmark measures latching cost rather than disk I/O.
+ * @return fetches per second
+ */
+static double RunFetchBenchmark(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids, size_t num_threads,
+                                size_t ops_per_thread, std::atomic<size_t> *errors) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 rng(t);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      for (size_t i = 0; i < ops_per_thread; i++) {
+        page_id_t page_id = page_ids[dist(rng)];
+        Page *page = bpm->FetchPage(page_id);
+        if (page == nullptr || *reinterpret_cast<page_id_t *>(page->GetData() + 64) != page_id) {
+          errors->fetch_add(1);
+          continue;
+        }
+        bpm->UnpinPage(page_id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_threads * ops_per_thread) / elapsed.count();
+}
+
+TEST(BufferPoolManagerTest, ConcurrentFetchBenchmark) {
+  const size_t buffer_pool_size = 256;
+  const size_t num_pages = buffer_pool_size / 2;
+  const size_t ops_per_thread = 20000;
+  for (size_t num_instances : {1, 8}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, num_instances);
+    ASSERT_EQ(num_instances, bpm->GetNumInstances());
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      Page *page = bpm->NewPage(page_id);
+      ASSERT_NE(nullptr, page);
+      memcpy(page->GetData() + 64, &page_id, sizeof(page_id_t));
+      bpm->UnpinPage(page_id, true);
+      page_ids.push_back(page_id);
+    }
+    for (size_t num_threads : {1, 2, 4, 8}) {
+      std::atomic<size_t> errors{0};
+      double throughput = RunFetchBenchmark(bpm, page_ids, num_threads, ops_per_thread, &errors);
+      ASSERT_EQ(0, errors.load());
+      printf("instances: %zu, threads: %zu, fetch+unpin/s: %.0f\n", num_instances, num_threads, throughput);
+    }
+    ASSERT_TRUE(bpm->CheckAllUnpinned());
+    delete bpm;
+    delete disk_manager;
+    remove(db_name.c_str());
+  }
+}
+
+TEST(BufferPoolManagerTest, ConcurrentNewPageTest) {
+  const size_t buffer_pool_size = 64;
+  const size_t num_threads = 4;
+  const size_t pages_per_thread = 200;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 4);
+  std::vector<std::vector<page_id_t>> created(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        Page *page = bpm->NewPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        memcpy(page->GetData(), &page_id, sizeof(page_id_t));
+        bpm->UnpinPage(page_id, true);
+        created[t].push_back(page_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // every page must have been written back or still be resident with its own content
+  size_t total = 0;
+  for (auto &ids : created) {
+    for (auto page_id : ids) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      ASSERT_EQ(page_id, *reinterpret_cast<page_id_t *>(page->GetData()));
+      bpm->UnpinPage(page_id, false);
+      total++;
+    }
+  }
+  ASSERT_EQ(num_threads * pages_per_thread, total);
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -1,6 +1,7 @@
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -78,4 +79,76 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   delete bpm;
   // assert(false);
   delete disk_manager;
-}
\ No newline at end of file
+}
+TEST(BufferPoolManagerTest, CheckpointTest) {
+  const std::string db_name = "bpm_checkpoint_test.db";
+  const size_t buffer_pool_size = 32;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 2);
+  page_id_t page_id;
+  for (int i = 0; i < 20; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    bpm->UnpinPage(page_id, true);
+  }
+  // Scenario: a pinned dirty page is never written by a checkpoint.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(20, bpm->GetNumDirtyPages());
+  // Scenario: an incremental checkpoint bounds the number of dirty pages.
+  size_t writes_before = disk_manager->GetNumWrites();
+  EXPECT_EQ(15, bpm->Checkpoint(5));
+  EXPECT_EQ(5, bpm->GetNumDirtyPages());
+  EXPECT_EQ(15, disk_manager->GetNumWrites() - writes_before);
+  EXPECT_EQ(4, bpm->Checkpoint());
+  EXPECT_EQ(1, bpm->GetNumDirtyPages());
+  // Scenario: a clean unpin does not hide an earlier modification.
+  bpm->UnpinPage(0, false);
+  EXPECT_EQ(1, bpm->GetNumDirtyPages());
+  EXPECT_EQ(1, bpm->Checkpoint());
+  EXPECT_EQ(0, bpm->GetNumDirtyPages());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "bpm_bg_writer_test.db";
+  const size_t buffer_pool_size = 16;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < static_cast<int>(buffer_pool_size); i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    memcpy(page->GetData(), &i, sizeof(int));
+    bpm->UnpinPage(page_id, true);
+  }
+  // keep page 0 pinned, the writer must leave it alone
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  bpm->StartBackgroundWriter(5, 4);
+  for (int i = 0; i < 400 && bpm->GetNumDirtyPages() > 1; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(1, bpm->GetNumDirtyPages());
+  // Scenario: victims are clean now, so creating new pages does not write anything back.
+  bpm->UnpinPage(0, false);
+  bpm->Checkpoint();
+  size_t writes_before = disk_manager->GetNumWrites();
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_EQ(0, disk_manager->GetNumWrites() - writes_before);
+  // Scenario: everything written by the writer can be read back.
+  for (int i = 0; i < static_cast<int>(buffer_pool_size); i++) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, *reinterpret_cast<int *>(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,120 @@
+#include <cstdio>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer. Frame 1 is accessed twice.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Unpin(6);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+  EXPECT_EQ(0, lru_k_replacer.GetPinCount());
+
+  // Scenario: frames with a single access have infinite distance and go first, oldest first.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+
+  // Scenario: pinned frames are not victims, pinning a victimized frame starts a new history.
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Pin(3);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+  EXPECT_EQ(2, lru_k_replacer.GetPinCount());
+
+  // Scenario: 4 now has two accesses, so 5 and 6 are evicted before it, and 1 has the oldest 2nd access.
+  lru_k_replacer.Unpin(4);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  ASSERT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: the last pinned frame becomes the only victim once unpinned.
+  lru_k_replacer.Unpin(3);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(4, 2, 2);
+  int value;
+  // Scenario: 1 is touched twice in a row, which falls into the correlated period and counts once.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  // Scenario: 2 is touched twice with other accesses in between, so it has a real history of two.
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const std::string db_name = "lru_k_test.db";
+  const size_t buffer_pool_size = 16;
+  const int hot_pages = 4;
+  const int scan_pages = 64;
+  for (auto replacer_type : {ReplacerType::kLRU, ReplacerType::kLRUK}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, 1, replacer_type);
+    page_id_t page_id;
+    for (int i = 0; i < hot_pages + scan_pages; i++) {
+      ASSERT_NE(nullptr, bpm->NewPage(page_id));
+      bpm->UnpinPage(page_id, true);
+    }
+    // the hot pages are fetched repeatedly, like the internal pages of an index
+    for (int round = 0; round < 3; round++) {
+      for (int i = 0; i < hot_pages; i++) {
+        ASSERT_NE(nullptr, bpm->FetchPage(i));
+        bpm->UnpinPage(i, false);
+      }
+    }
+    // a sequential scan touches every other page once
+    for (int i = hot_pages; i < hot_pages + scan_pages; i++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      bpm->UnpinPage(i, false);
+    }
+    // the scan must not flush the hot pages under LRU-K, while it does under LRU
+    size_t reads_before = disk_manager->GetNumReads();
+    for (int i = 0; i < hot_pages; i++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      bpm->UnpinPage(i, false);
+    }
+    size_t reads = disk_manager->GetNumReads() - reads_before;
+    if (replacer_type == ReplacerType::kLRUK) {
+      EXPECT_EQ(0, reads);
+    } else {
+      EXPECT_EQ(hot_pages, reads);
+    }
+    delete bpm;
+    delete disk_manager;
+    remove(db_name.c_str());
+  }
+}
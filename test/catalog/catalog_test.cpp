@@ -37,6 +37,25 @@ TEST(CatalogTest, CatalogMetaTest) {
   }
 }
 
+TEST(CatalogTest, TableMetaTest) {
+  SimpleMemHeap heap;
+  char *buf = reinterpret_cast<char *>(heap.Allocate(PAGE_SIZE));
+  memset(buf, 0, PAGE_SIZE);
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableMetadata *meta = TableMetadata::Create(0, "table-1", 3, 4, schema.get(), &heap);
+  uint32_t size = meta->SerializeTo(buf);
+  TableMetadata *other = nullptr;
+  ASSERT_EQ(size, TableMetadata::DeserializeFrom(buf, other, &heap));
+  ASSERT_EQ(3, other->GetFirstPageId());
+  ASSERT_EQ(4, other->GetFreeSpaceMapPageId());
+  // Scenario: metadata written before free space maps existed ends before the map page id.
+  memset(buf + size - sizeof(uint32_t), 0, sizeof(uint32_t));
+  TableMetadata::DeserializeFrom(buf, other, &heap);
+  ASSERT_EQ(3, other->GetFirstPageId());
+  ASSERT_EQ(INVALID_PAGE_ID, other->GetFreeSpaceMapPageId());
+}
+
 TEST(CatalogTest, CatalogTableTest) {
   SimpleMemHeap heap;
   /** Stage 2: Testing simple operation */
@@ -94,6 +113,19 @@ TEST(CatalogTest, CatalogIndexTest) {
   ASSERT_EQ(DB_COLUMN_NAME_NOT_EXIST, r2);
   auto r3 = catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info);
   ASSERT_EQ(DB_SUCCESS, r3);
+  IndexInfo *hash_index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-2", index_keys, &txn, hash_index_info,
+                                                IndexType::kHash));
+  ASSERT_EQ(IndexType::kBPlusTree, index_info->GetIndexType());
+  ASSERT_EQ(IndexType::kHash, hash_index_info->GetIndexType());
+  IndexInfo *name_index_info = nullptr;
+  std::vector<std::string> name_keys{"name"};
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateIndex("table-1", "index-3", name_keys, &txn, name_index_info,
+                                               IndexType::kHash, false));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-3", name_keys, &txn, name_index_info,
+                                                IndexType::kBPlusTree, false));
+  ASSERT_TRUE(index_info->IsUnique());
+  ASSERT_FALSE(name_index_info->IsUnique());
   for (int i = 0; i < 10; i++) {
     std::vector<Field> fields{
             Field(TypeId::kTypeInt, i),
@@ -102,6 +134,9 @@ TEST(CatalogTest, CatalogIndexTest) {
     Row row(fields);
     RowId rid(1000, i);
     ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(row, rid, nullptr));
+    ASSERT_EQ(DB_SUCCESS, hash_index_info->GetIndex()->InsertEntry(row, rid, nullptr));
+    std::vector<Field> name_fields{Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+    ASSERT_EQ(DB_SUCCESS, name_index_info->GetIndex()->InsertEntry(Row(name_fields), rid, nullptr));
   }
   // Scan Key
   std::vector<RowId> ret;
@@ -134,5 +169,62 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(DB_SUCCESS, index_info_02->GetIndex()->ScanKey(row, ret_02, &txn));
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
+  // the index type is persisted with the index
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("table-1", "index-2", index_info_02));
+  ASSERT_EQ(IndexType::kHash, index_info_02->GetIndexType());
+  for (int i = 0; i < 10; i++) {
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)
+    };
+    Row row(fields);
+    ret_02.clear();
+    ASSERT_EQ(DB_SUCCESS, index_info_02->GetIndex()->ScanKey(row, ret_02, &txn));
+    ASSERT_EQ(RowId(1000, i).Get(), ret_02[0].Get());
+  }
+  // so is uniqueness, all rows share the name
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("table-1", "index-3", index_info_02));
+  ASSERT_FALSE(index_info_02->IsUnique());
+  std::vector<Field> name_fields{Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+  ret_02.clear();
+  ASSERT_EQ(DB_SUCCESS, index_info_02->GetIndex()->ScanKey(Row(name_fields), ret_02, &txn));
+  ASSERT_EQ(10U, ret_02.size());
+  delete db_02;
+}
+TEST(CatalogTest, CatalogDropTest) {
+  SimpleMemHeap heap;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  std::vector<std::string> index_keys{"id"};
+  // dropped tables and indexes give their pages back, creating them again does not grow the file
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  for (int i = 0; i < 20; i++) {
+    TableInfo *table_info = nullptr;
+    ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_info));
+    IndexInfo *index_info = nullptr;
+    ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info));
+    ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-2", index_keys, &txn, index_info,
+                                                  IndexType::kHash));
+    if (i == 0) {
+      first_page_id = table_info->GetRootPageId();
+    } else {
+      ASSERT_EQ(first_page_id, table_info->GetRootPageId());
+    }
+    ASSERT_EQ(DB_SUCCESS, catalog_01->DropIndex("table-1", "index-1"));
+    ASSERT_EQ(DB_TABLE_NOT_EXIST, catalog_01->GetIndex("table-1", "index-1", index_info));
+    ASSERT_EQ(DB_SUCCESS, catalog_01->DropTable("table-1"));
+    ASSERT_EQ(DB_TABLE_NOT_EXIST, catalog_01->GetTable("table-1", table_info));
+    ASSERT_TRUE(db_01->bpm_->IsPageFree(first_page_id));
+  }
+  delete db_01;
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  TableInfo *table_info_02 = nullptr;
+  ASSERT_EQ(DB_TABLE_NOT_EXIST, db_02->catalog_mgr_->GetTable("table-1", table_info_02));
   delete db_02;
-}
\ No newline at end of file
+}
@@ -1,9 +1,14 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
 #include <string>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/b_plus_tree_index.h"
 #include "index/generic_key.h"
+#include "page/disk_file_meta_page.h"
 
 static const std::string db_name = "bp_tree_index_test.db";
 
@@ -78,4 +83,480 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     ASSERT_EQ(i, (*iter).second.GetSlotNum());
     i++;
   }
-}
\ No newline at end of file
+}
+
+static int CompareFields(const std::vector<Field> &lhs, const std::vector<Field> &rhs) {
+  for (size_t i = 0; i < lhs.size(); i++) {
+    // nulls first
+    if (lhs[i].IsNull() || rhs[i].IsNull()) {
+      if (lhs[i].IsNull() != rhs[i].IsNull()) {
+        return lhs[i].IsNull() ? -1 : 1;
+      }
+      continue;
+    }
+    if (lhs[i].CompareLessThan(rhs[i]) == CmpBool::kTrue) {
+      return -1;
+    }
+    if (lhs[i].CompareGreaterThan(rhs[i]) == CmpBool::kTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int Sign(int value) { return (value > 0) - (value < 0); }
+
+TEST(BPlusTreeTests, GenericKeyOrderTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 1, true, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 8, 2, true, false)
+  };
+  Schema key_schema(columns);
+  ASSERT_EQ(5 + 5 + 10, KeyEncoding::GetEncodedSize(&key_schema));
+  std::vector<int32_t> ints{INT32_MIN, -65537, -1, 0, 1, 188, INT32_MAX};
+  std::vector<float> floats{-1e30f, -2.5f, -0.0f, 0.0f, 1e-30f, 2.5f, 1e30f};
+  std::vector<const char *> names{"", "a", "ab", "abc", "b", "minisql"};
+  std::mt19937 rng(0);
+  std::vector<std::vector<Field>> keys;
+  for (int i = 0; i < 500; i++) {
+    std::vector<Field> fields;
+    // few distinct values per column, so that later columns decide as well
+    if (rng() % 8 == 0) {
+      fields.emplace_back(TypeId::kTypeInt);
+    } else {
+      fields.emplace_back(TypeId::kTypeInt, ints[rng() % 3]);
+    }
+    if (rng() % 8 == 0) {
+      fields.emplace_back(TypeId::kTypeFloat);
+    } else {
+      fields.emplace_back(TypeId::kTypeFloat, floats[rng() % floats.size()]);
+    }
+    const char *name = names[rng() % names.size()];
+    fields.emplace_back(TypeId::kTypeChar, const_cast<char *>(name), strlen(name), true);
+    keys.push_back(fields);
+  }
+  for (auto i : ints) {
+    keys.push_back({Field(TypeId::kTypeInt, i), Field(TypeId::kTypeFloat, 0.0f),
+                    Field(TypeId::kTypeChar, const_cast<char *>("x"), 1, true)});
+  }
+  INDEX_COMPARATOR_TYPE comparator(&key_schema);
+  std::vector<INDEX_KEY_TYPE> encoded(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    Row row(keys[i]);
+    encoded[i].SerializeFromKey(row, &key_schema);
+  }
+  // Scenario: memcmp of encoded keys orders as comparing the fields.
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      ASSERT_EQ(CompareFields(keys[i], keys[j]), Sign(comparator(encoded[i], encoded[j]))) << i << " " << j;
+    }
+  }
+  // Scenario: keys decode to the fields they were built from.
+  for (size_t i = 0; i < keys.size(); i++) {
+    Row row(INVALID_ROWID);
+    encoded[i].DeserializeToKey(row, &key_schema);
+    std::vector<Field> decoded;
+    for (auto field : row.GetFields()) {
+      decoded.emplace_back(*field);
+    }
+    ASSERT_EQ(0, CompareFields(keys[i], decoded));
+    ASSERT_EQ(keys[i][2].GetLength(), decoded[2].GetLength());
+  }
+}
+
+TEST(BPlusTreeTests, GenericComparatorBenchmark) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  const size_t key_nums = 1000;
+  const size_t rounds = 200;
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, false, false)
+  };
+  Schema key_schema(columns);
+  std::vector<INDEX_KEY_TYPE> encoded(key_nums);
+  std::vector<std::vector<char>> serialized(key_nums);
+  for (size_t i = 0; i < key_nums; i++) {
+    std::string name = "key" + std::to_string(i % 17);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, static_cast<int32_t>(i % 31)),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    encoded[i].SerializeFromKey(row, &key_schema);
+    serialized[i].resize(row.GetSerializedSize(&key_schema));
+    row.SerializeTo(serialized[i].data(), &key_schema);
+  }
+  // before: both keys were deserialized into rows and compared field by field
+  int64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t r = 0; r < rounds / 10; r++) {
+    for (size_t i = 0; i < key_nums; i++) {
+      Row lhs(INVALID_ROWID);
+      Row rhs(INVALID_ROWID);
+      lhs.DeserializeFrom(serialized[i].data(), &key_schema);
+      rhs.DeserializeFrom(serialized[(i + r + 1) % key_nums].data(), &key_schema);
+      for (uint32_t c = 0; c < key_schema.GetColumnCount(); c++) {
+        if (lhs.GetField(c)->CompareLessThan(*rhs.GetField(c)) == CmpBool::kTrue) {
+          checksum--;
+          break;
+        }
+        if (lhs.GetField(c)->CompareGreaterThan(*rhs.GetField(c)) == CmpBool::kTrue) {
+          checksum++;
+          break;
+        }
+      }
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  printf("row comparator: %.1f ns/compare\n", elapsed.count() / (rounds / 10 * key_nums));
+  INDEX_COMPARATOR_TYPE comparator(&key_schema);
+  start = std::chrono::steady_clock::now();
+  for (size_t r = 0; r < rounds; r++) {
+    for (size_t i = 0; i < key_nums; i++) {
+      checksum += Sign(comparator(encoded[i], encoded[(i + r + 1) % key_nums]));
+    }
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  printf("memcmp comparator: %.1f ns/compare (checksum %ld)\n", elapsed.count() / (rounds * key_nums),
+         static_cast<long>(checksum));
+}
+
+/**
+ * @return sources which produce the entries (keys[i], RowId(i, 0)), each one a strided share of them
+ */
+static std::vector<Index::EntrySource> SplitSources(const std::vector<int> &keys, size_t num_sources) {
+  std::vector<Index::EntrySource> sources;
+  for (size_t s = 0; s < num_sources; s++) {
+    sources.push_back([&keys, s, num_sources](const Index::EntrySink &sink) {
+      std::vector<Field> fields;
+      for (size_t i = s; i < keys.size(); i += num_sources) {
+        fields.clear();
+        fields.emplace_back(TypeId::kTypeInt, keys[i]);
+        sink(fields, RowId(i, 0));
+      }
+    });
+  }
+  return sources;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBulkLoadTest) {
+  using INDEX_KEY_TYPE = GenericKey<8>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<8>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  const int n = 100000;
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = i - n / 2;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  index_id_t index_id = 0;
+  for (size_t num_sources : {1, 4}) {
+    // Scenario: a sort memory of 16KB spills the entries in about a hundred sorted runs.
+    auto *index = ALLOC(heap, BP_TREE_INDEX)(index_id++, &key_schema, engine.bpm_);
+    ASSERT_EQ(DB_SUCCESS, index->BulkLoad(SplitSources(keys, num_sources), DEFAULT_INDEX_FILL_FACTOR, 16 << 10));
+    std::vector<RowId> ret;
+    for (int i = 0; i < n; i++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+      ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(fields), ret, nullptr));
+      ASSERT_EQ(i, ret[i].GetPageId());
+    }
+    int expected = -n / 2;
+    for (auto iter = index->GetBeginIterator(); iter != index->GetEndIterator(); ++iter) {
+      ASSERT_EQ(expected, keys[(*iter).second.GetPageId()]);
+      expected++;
+    }
+    ASSERT_EQ(n / 2, expected);
+  }
+  // Scenario: a duplicate key fails the load of a new index, even if the two entries come from different sources.
+  keys.push_back(keys[n / 3]);
+  for (size_t num_sources : {1, 4}) {
+    auto *duplicates = ALLOC(heap, BP_TREE_INDEX)(index_id++, &key_schema, engine.bpm_);
+    ASSERT_EQ(DB_FAILED, duplicates->BulkLoad(SplitSources(keys, num_sources), nullptr));
+    std::vector<Field> fields{Field(TypeId::kTypeInt, keys[0])};
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_KEY_NOT_FOUND, duplicates->ScanKey(Row(fields), ret, nullptr));
+  }
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexNonUniqueTest) {
+  using INDEX_KEY_TYPE = GenericKey<16>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<16>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("grp", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  // every key has hundreds of entries, which span several leaves
+  const int n = 20000;
+  const int num_keys = 50;
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = i % num_keys;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, &key_schema, engine.bpm_, false);
+  ASSERT_FALSE(index->IsUnique());
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(i, 0), nullptr));
+  }
+  // only the same entry twice is rejected
+  std::vector<Field> first_fields{Field(TypeId::kTypeInt, keys[0])};
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(Row(first_fields), RowId(0, 0), nullptr));
+  auto check_scan = [&](BP_TREE_INDEX *index, const std::vector<bool> &removed) {
+    for (int key = 0; key < num_keys; key++) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+      std::vector<RowId> ret;
+      ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(fields), ret, nullptr));
+      // the entries of a key are sorted by row id
+      std::vector<RowId> expected;
+      for (int i = 0; i < n; i++) {
+        if (keys[i] == key && !removed[i]) {
+          expected.emplace_back(i, 0);
+        }
+      }
+      ASSERT_EQ(expected.size(), ret.size());
+      for (size_t i = 0; i < ret.size(); i++) {
+        ASSERT_EQ(expected[i].Get(), ret[i].Get());
+      }
+    }
+    std::vector<Field> fields{Field(TypeId::kTypeInt, num_keys)};
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(Row(fields), ret, nullptr));
+    ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  };
+  std::vector<bool> removed(n, false);
+  check_scan(index, removed);
+  // a removal takes only the entry of its row
+  for (int i = 0; i < n; i += 3) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(Row(fields), RowId(i, 0), nullptr));
+    removed[i] = true;
+  }
+  check_scan(index, removed);
+  // duplicate keys do not fail a load
+  auto *loaded = ALLOC(heap, BP_TREE_INDEX)(1, &key_schema, engine.bpm_, false);
+  ASSERT_EQ(DB_SUCCESS, loaded->BulkLoad(SplitSources(keys, 4), nullptr));
+  check_scan(loaded, std::vector<bool>(n, false));
+  // an iterator started at the smallest row id of a key visits all of its entries
+  INDEX_KEY_TYPE begin_key;
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 7)};
+  begin_key.SerializeFromKey(Row(fields), KEY_MIN_ROWID, &key_schema);
+  int count = 0;
+  for (auto iter = loaded->GetBeginIterator(begin_key); iter != loaded->GetEndIterator(); ++iter) {
+    if (keys[(*iter).second.GetPageId()] != 7) {
+      break;
+    }
+    count++;
+  }
+  ASSERT_EQ(n / num_keys, count);
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexRangeIteratorTest) {
+  using INDEX_KEY_TYPE = GenericKey<8>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<8>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, &key_schema, engine.bpm_);
+  // even keys only, so that odd bounds are absent from the tree
+  for (int i = 0; i < 2000; i += 2) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(i, 0), nullptr));
+  }
+  auto key_of = [&](int i) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    INDEX_KEY_TYPE key;
+    key.SerializeFromKey(Row(fields), &key_schema);
+    return key;
+  };
+  // return the first and last keys of the range and their count
+  auto scan = [&](int lower, bool lower_inclusive, int upper, bool upper_inclusive) {
+    std::vector<int> keys;
+    for (auto iter = index->GetRangeIterator(key_of(lower), lower_inclusive, key_of(upper), upper_inclusive);
+         iter != index->GetEndIterator(); ++iter) {
+      keys.push_back((*iter).second.GetPageId());
+    }
+    return keys.empty() ? std::vector<int>{} : std::vector<int>{keys.front(), keys.back(), (int)keys.size()};
+  };
+  ASSERT_EQ((std::vector<int>{100, 200, 51}), scan(100, true, 200, true));
+  ASSERT_EQ((std::vector<int>{102, 198, 49}), scan(100, false, 200, false));
+  ASSERT_EQ((std::vector<int>{102, 200, 50}), scan(101, false, 201, true));
+  ASSERT_EQ((std::vector<int>{102, 200, 50}), scan(101, true, 201, false));
+  ASSERT_EQ((std::vector<int>{1900, 1998, 50}), scan(1899, true, 5000, true));
+  ASSERT_EQ((std::vector<int>{0, 0, 1}), scan(-10, true, 1, true));
+  ASSERT_EQ(std::vector<int>{}, scan(200, false, 200, true));
+  ASSERT_EQ(std::vector<int>{}, scan(300, true, 100, true));
+  ASSERT_EQ(std::vector<int>{}, scan(2001, true, 5000, true));
+  // the same ranges scanned downwards
+  auto reverse_scan = [&](int lower, bool lower_inclusive, int upper, bool upper_inclusive) {
+    std::vector<int> keys;
+    for (auto iter = index->GetReverseRangeIterator(key_of(lower), lower_inclusive, key_of(upper), upper_inclusive);
+         iter != index->GetEndIterator(); --iter) {
+      keys.push_back((*iter).second.GetPageId());
+    }
+    return keys.empty() ? std::vector<int>{} : std::vector<int>{keys.front(), keys.back(), (int)keys.size()};
+  };
+  ASSERT_EQ((std::vector<int>{200, 100, 51}), reverse_scan(100, true, 200, true));
+  ASSERT_EQ((std::vector<int>{198, 102, 49}), reverse_scan(100, false, 200, false));
+  ASSERT_EQ((std::vector<int>{200, 102, 50}), reverse_scan(101, false, 201, true));
+  ASSERT_EQ((std::vector<int>{200, 102, 50}), reverse_scan(101, true, 201, false));
+  ASSERT_EQ((std::vector<int>{1998, 1900, 50}), reverse_scan(1899, true, 5000, true));
+  ASSERT_EQ((std::vector<int>{0, 0, 1}), reverse_scan(-10, true, 1, true));
+  ASSERT_EQ(std::vector<int>{}, reverse_scan(200, false, 200, true));
+  ASSERT_EQ(std::vector<int>{}, reverse_scan(300, true, 100, true));
+  ASSERT_EQ(std::vector<int>{}, reverse_scan(-100, true, -1, true));
+  int count = 0;
+  for (auto iter = index->GetReverseBeginIterator(); iter != index->GetEndIterator(); --iter) {
+    ASSERT_EQ(1998 - 2 * count++, (*iter).second.GetPageId());
+  }
+  ASSERT_EQ(1000, count);
+  // Scenario: a copy does not hold the leaf, it finds its key again when it moves.
+  {
+    auto iter = index->GetRangeIterator(key_of(100), true, key_of(110), true);
+    auto copy = iter++;
+    ASSERT_EQ(100, (*copy).second.GetPageId());
+    ASSERT_EQ(102, (*iter).second.GetPageId());
+    ++copy;
+    ASSERT_EQ(102, (*copy).second.GetPageId());
+    ASSERT_TRUE(copy == iter);
+    --copy;
+    ASSERT_EQ(100, (*copy).second.GetPageId());
+  }
+  // a scan which stops at its bound releases its leaf
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  index->Destroy();
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexPrefixRangeTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("a", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("b", TypeId::kTypeInt, 1, false, false)
+  };
+  Schema key_schema(columns);
+  for (bool unique : {true, false}) {
+    auto *index = ALLOC(heap, BP_TREE_INDEX)(unique ? 0 : 1, &key_schema, engine.bpm_, unique);
+    for (int a = 0; a < 10; a++) {
+      for (int b = 0; b < 100; b++) {
+        std::vector<Field> fields{Field(TypeId::kTypeInt, a), Field(TypeId::kTypeInt, b)};
+        ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(a, b), nullptr));
+      }
+    }
+    // count the entries from the first key not before the lower bound to the first key not before the upper bound
+    auto count = [&](std::vector<Field> lower, bool lower_after, std::vector<Field> upper, bool upper_after) {
+      INDEX_KEY_TYPE begin_key, end_key;
+      begin_key.SerializeFromKeyPrefix(Row(lower), &key_schema, lower_after);
+      end_key.SerializeFromKeyPrefix(Row(upper), &key_schema, upper_after);
+      int n = 0;
+      for (auto iter = index->GetRangeIterator(begin_key, !lower_after, end_key, upper_after);
+           iter != index->GetEndIterator(); ++iter) {
+        n++;
+      }
+      return n;
+    };
+    using F = std::vector<Field>;
+    // a = 3
+    ASSERT_EQ(100, count(F{Field(TypeId::kTypeInt, 3)}, false, F{Field(TypeId::kTypeInt, 3)}, true));
+    // a = 3 and b > 50
+    ASSERT_EQ(49, count(F{Field(TypeId::kTypeInt, 3), Field(TypeId::kTypeInt, 50)}, true,
+                        F{Field(TypeId::kTypeInt, 3)}, true));
+    // a = 3 and b >= 50 and b < 60
+    ASSERT_EQ(10, count(F{Field(TypeId::kTypeInt, 3), Field(TypeId::kTypeInt, 50)}, false,
+                        F{Field(TypeId::kTypeInt, 3), Field(TypeId::kTypeInt, 60)}, false));
+    // a = 3 and b <= 1000, the bound is past all keys of a = 3
+    ASSERT_EQ(100, count(F{Field(TypeId::kTypeInt, 3)}, false,
+                         F{Field(TypeId::kTypeInt, 3), Field(TypeId::kTypeInt, 1000)}, true));
+    // a < 2
+    ASSERT_EQ(200, count(F{}, false, F{Field(TypeId::kTypeInt, 2)}, false));
+    // a > 8
+    ASSERT_EQ(100, count(F{Field(TypeId::kTypeInt, 8)}, true, F{}, true));
+  }
+  // Scenario: a char(6) key is encoded in exactly 8 bytes, its bounds have no padding and equal the key.
+  using NARROW_INDEX = BPlusTreeIndex<GenericKey<8>, RowId, GenericComparator<8>>;
+  std::vector<Column *> narrow_columns = {ALLOC_COLUMN(heap)("c", TypeId::kTypeChar, 6, 0, false, false)};
+  Schema narrow_schema(narrow_columns);
+  ASSERT_EQ(8, KeyEncoding::GetEncodedSize(&narrow_schema));
+  auto *narrow_index = ALLOC(heap, NARROW_INDEX)(2, &narrow_schema, engine.bpm_, true);
+  for (const char *c : {"abcde", "abcdef", "abcdeg"}) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(c), strlen(c), false)};
+    ASSERT_EQ(DB_SUCCESS, narrow_index->InsertEntry(Row(fields), RowId(0, strlen(c)), nullptr));
+  }
+  auto narrow_count = [&](bool lower_inclusive, bool upper_inclusive) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>("abcdef"), 6, false)};
+    GenericKey<8> begin_key, end_key;
+    begin_key.SerializeFromKeyPrefix(Row(fields), &narrow_schema, !lower_inclusive);
+    end_key.SerializeFromKeyPrefix(Row(fields), &narrow_schema, upper_inclusive);
+    int n = 0;
+    for (auto iter = narrow_index->GetRangeIterator(begin_key, lower_inclusive, end_key, upper_inclusive);
+         iter != narrow_index->GetEndIterator(); ++iter) {
+      n++;
+    }
+    return n;
+  };
+  // c = 'abcdef'
+  ASSERT_EQ(1, narrow_count(true, true));
+  ASSERT_EQ(0, narrow_count(false, true));
+  ASSERT_EQ(0, narrow_count(true, false));
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBulkLoadBenchmark) {
+  using INDEX_KEY_TYPE = GenericKey<16>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<16>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name, true, 8192);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)};
+  Schema key_schema(columns);
+  const int n = 500000;
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(engine.disk_mgr_->GetMetaData());
+  // before: every row was inserted on its own, leaving pages half full after they split
+  auto *inserted = ALLOC(heap, BP_TREE_INDEX)(0, &key_schema, engine.bpm_);
+  uint32_t pages = meta_page->GetAllocatedPages();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+    ASSERT_EQ(DB_SUCCESS, inserted->InsertEntry(Row(fields), RowId(i, 0), nullptr));
+  }
+  std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+  uint32_t insert_pages = meta_page->GetAllocatedPages() - pages;
+  printf("rows: %d, insert: %.0f ms, %u pages\n", n, elapsed.count(), insert_pages);
+  index_id_t index_id = 1;
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    auto *loaded = ALLOC(heap, BP_TREE_INDEX)(index_id++, &key_schema, engine.bpm_);
+    pages = meta_page->GetAllocatedPages();
+    start = std::chrono::steady_clock::now();
+    ASSERT_EQ(DB_SUCCESS, loaded->BulkLoad(SplitSources(keys, num_threads), nullptr));
+    elapsed = std::chrono::steady_clock::now() - start;
+    uint32_t load_pages = meta_page->GetAllocatedPages() - pages;
+    printf("rows: %d, bulk load with %zu thread(s): %.0f ms, %u pages\n", n, num_threads, elapsed.count(),
+           load_pages);
+    ASSERT_LT(load_pages, insert_pages);
+    std::vector<RowId> ret;
+    for (int i = 0; i < n; i += 97) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+      ASSERT_EQ(DB_SUCCESS, loaded->ScanKey(Row(fields), ret, nullptr));
+      ASSERT_EQ(i, ret.back().GetPageId());
+    }
+    loaded->Destroy();
+  }
+}
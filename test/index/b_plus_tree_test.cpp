@@ -1,3 +1,9 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <thread>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/b_plus_tree.h"
@@ -70,4 +76,330 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+
+TEST(BPlusTreeTests, LookupBenchmark) {
+  // the whole tree stays in the buffer pool, so page search dominates
+  DBStorageEngine engine(db_name, true, 8192);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator);
+  const int n = 1000000;
+  vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.Insert(keys[i], keys[i] * 2));
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  printf("keys: %d, insert: %.0f ns/key\n", n, elapsed.count() / n);
+  ShuffleArray(keys);
+  vector<int> ans;
+  ans.reserve(n);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(keys[i], ans));
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  printf("keys: %d, lookup: %.0f ns/key\n", n, elapsed.count() / n);
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(keys[i] * 2, ans[i]);
+  }
+  ans.clear();
+  ASSERT_FALSE(tree.GetValue(n, ans));
+  ASSERT_FALSE(tree.GetValue(-1, ans));
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  DBStorageEngine engine(db_name, true, 256);
+  BasicComparator<int> comparator;
+  index_id_t index_id = 0;
+  for (double fill_factor : {0.5, 0.9, 1.0}) {
+    for (int n : {0, 1, 7, 1000, 100000}) {
+      BPlusTree<int, int, BasicComparator<int>> tree(index_id++, engine.bpm_, comparator);
+      int next = 0;
+      ASSERT_TRUE(tree.BulkLoad(
+              n,
+              [&next](int &key, int &value) {
+                // even keys only, odd ones are inserted afterwards
+                key = next * 2;
+                value = next++;
+                return true;
+              },
+              fill_factor));
+      ASSERT_EQ(n, next);
+      ASSERT_EQ(n == 0, tree.IsEmpty());
+      ASSERT_TRUE(tree.Check());
+      vector<int> ans;
+      for (int i = 0; i < n; i++) {
+        ASSERT_TRUE(tree.GetValue(i * 2, ans));
+        ASSERT_EQ(i, ans[i]);
+        ASSERT_FALSE(tree.GetValue(i * 2 + 1, ans));
+      }
+      int i = 0;
+      for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+        ASSERT_EQ(i * 2, (*iter).first);
+        i++;
+      }
+      ASSERT_EQ(n, i);
+      // the prev links of the loaded leaves are set as well
+      for (auto iter = tree.RBegin(); iter != tree.End(); --iter) {
+        i--;
+        ASSERT_EQ(i * 2, (*iter).first);
+      }
+      ASSERT_EQ(0, i);
+      // Scenario: the loaded tree splits and merges like one built by inserts.
+      for (int i = 0; i < n; i++) {
+        ASSERT_TRUE(tree.Insert(i * 2 + 1, i));
+      }
+      for (int i = 0; i < n; i += 2) {
+        tree.Remove(i * 2);
+      }
+      ASSERT_TRUE(tree.Check());
+      for (int i = 0; i < n; i++) {
+        ans.clear();
+        ASSERT_EQ(i % 2 == 1, tree.GetValue(i * 2, ans));
+        ASSERT_TRUE(tree.GetValue(i * 2 + 1, ans));
+      }
+    }
+  }
+  // Scenario: keys out of order are rejected and leave the tree empty.
+  BPlusTree<int, int, BasicComparator<int>> tree(index_id++, engine.bpm_, comparator);
+  int next = 0;
+  auto descending_at_end = [&next](int &key, int &value) {
+    key = next == 999 ? 0 : next;
+    value = next++;
+    return true;
+  };
+  ASSERT_FALSE(tree.BulkLoad(1000, descending_at_end));
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Check());
+  // Scenario: a tree which is not empty is not loaded.
+  ASSERT_TRUE(tree.Insert(1, 1));
+  next = 0;
+  ASSERT_FALSE(tree.BulkLoad(10, descending_at_end));
+  vector<int> ans;
+  ASSERT_FALSE(tree.GetValue(2, ans));
+}
+
+TEST(BPlusTreeTests, ReverseIteratorTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator);
+  ASSERT_TRUE(tree.RBegin() == tree.End());
+  const int n = 20000;
+  vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i * 2);
+  }
+  ShuffleArray(keys);
+  for (int key : keys) {
+    ASSERT_TRUE(tree.Insert(key, key));
+  }
+  // remove most keys, so that leaves are merged, keys from the start and the end included
+  ShuffleArray(keys);
+  std::set<int> remaining(keys.begin(), keys.end());
+  for (int i = 0; i < n * 3 / 4; i++) {
+    tree.Remove(keys[i]);
+    remaining.erase(keys[i]);
+  }
+  tree.Remove(0);
+  remaining.erase(0);
+  tree.Remove((n - 1) * 2);
+  remaining.erase((n - 1) * 2);
+  ASSERT_TRUE(tree.Check());
+  // Scenario: a descending scan returns the keys of an ascending one in reverse order.
+  vector<int> ascending;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ascending.push_back((*iter).first);
+  }
+  vector<int> descending;
+  for (auto iter = tree.RBegin(); iter != tree.End(); --iter) {
+    descending.push_back((*iter).first);
+  }
+  ASSERT_EQ(vector<int>(remaining.begin(), remaining.end()), ascending);
+  ASSERT_EQ(vector<int>(remaining.rbegin(), remaining.rend()), descending);
+  // Scenario: a descending scan starts at the last key not greater than its start key, present or not.
+  for (int key = -3; key < n * 2 + 3; key += 997) {
+    auto expected = std::make_reverse_iterator(remaining.upper_bound(key));
+    for (auto iter = tree.RBegin(key); iter != tree.End(); --iter, ++expected) {
+      ASSERT_TRUE(expected != remaining.rend());
+      ASSERT_EQ(*expected, (*iter).first);
+    }
+    ASSERT_TRUE(expected == remaining.rend());
+  }
+  ASSERT_TRUE(tree.Check());
+}
+
+TEST(BPlusTreeTests, ConcurrentInsertLookupTest) {
+  // a small pool makes pages get evicted while other threads traverse the tree
+  DBStorageEngine engine(db_name, true, 128);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator);
+  const int num_threads = 8;
+  const int keys_per_thread = 20000;
+  const int n = num_threads * keys_per_thread;
+  vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  // Scenario: every thread inserts its share of the keys and looks up keys inserted before by itself.
+  std::atomic<int> errors{0};
+  vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      vector<int> ans;
+      for (int i = t; i < n; i += num_threads) {
+        if (!tree.Insert(keys[i], keys[i] * 2)) {
+          errors++;
+        }
+        int probe = keys[t + (i / num_threads / 2) * num_threads];
+        ans.clear();
+        if (!tree.GetValue(probe, ans) || ans[0] != probe * 2) {
+          errors++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, errors.load());
+  ASSERT_TRUE(tree.Check());
+  vector<int> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(i, ans));
+    ASSERT_EQ(i * 2, ans[i]);
+  }
+  // Scenario: duplicate inserts race with each other, exactly one of them succeeds.
+  std::atomic<int> inserted{0};
+  threads.clear();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&]() {
+      for (int i = n; i < n + keys_per_thread; i++) {
+        if (tree.Insert(i, i * 2)) {
+          inserted++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(keys_per_thread, inserted.load());
+  // Scenario: half of the keys are removed while the other half is looked up.
+  threads.clear();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      vector<int> ans;
+      for (int i = t; i < n; i += num_threads) {
+        if (keys[i] % 2 == 0) {
+          tree.Remove(keys[i]);
+        } else {
+          ans.clear();
+          if (!tree.GetValue(keys[i], ans) || ans[0] != keys[i] * 2) {
+            errors++;
+          }
+        }
+      }
+    });
+  }
+  // scans in both directions see every key which is kept, in order, while the leaves split and merge under them
+  for (bool forward : {true, false}) {
+    threads.emplace_back([&, forward]() {
+      int kept = 0;
+      int last = forward ? -1 : n + keys_per_thread;
+      auto check = [&](int key) {
+        if (forward ? key <= last : key >= last) {
+          errors++;
+        }
+        last = key;
+        if (key % 2 == 1 || key >= n) {
+          kept++;
+        }
+      };
+      if (forward) {
+        for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+          check((*iter).first);
+        }
+      } else {
+        for (auto iter = tree.RBegin(); iter != tree.End(); --iter) {
+          check((*iter).first);
+        }
+      }
+      if (kept != n / 2 + keys_per_thread) {
+        errors++;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, errors.load());
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i++) {
+    ans.clear();
+    ASSERT_EQ(i % 2 == 1, tree.GetValue(i, ans));
+  }
+  // Scenario: removing everything concurrently leaves an empty tree which can grow again.
+  threads.clear();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = t; i < n + keys_per_thread; i += num_threads) {
+        tree.Remove(i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_TRUE(tree.Insert(1, 2));
+  ans.clear();
+  ASSERT_TRUE(tree.GetValue(1, ans));
+  ASSERT_EQ(2, ans[0]);
+}
+
+TEST(BPlusTreeTests, ConcurrentScalabilityBenchmark) {
+  const int n = 200000;
+  vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+  for (int num_threads : {1, 2, 4, 8}) {
+    // the whole tree stays in the buffer pool, so latching and page search dominate
+    DBStorageEngine engine(db_name, true, 8192);
+    BasicComparator<int> comparator;
+    BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator);
+    std::atomic<int> errors{0};
+    auto run = [&](bool insert) {
+      vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+          vector<int> ans;
+          for (int i = t; i < n; i += num_threads) {
+            ans.clear();
+            if (insert ? !tree.Insert(keys[i], keys[i]) : !tree.GetValue(keys[i], ans)) {
+              errors++;
+            }
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      return n / elapsed.count();
+    };
+    double inserts = run(true);
+    double lookups = run(false);
+    ASSERT_EQ(0, errors.load());
+    printf("threads: %d, inserts/s: %.0f, lookups/s: %.0f\n", num_threads, inserts, lookups);
+  }
+}
@@ -0,0 +1,202 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/b_plus_tree_index.h"
+#include "index/basic_comparator.h"
+#include "index/extendible_hash_index.h"
+#include "index/generic_key.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "hash_index_test.db";
+
+TEST(ExtendibleHashTests, ExtendibleHashTableTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  // tiny buckets and directories, so that buckets and directories split and merge often
+  ExtendibleHashTable<int, int, BasicComparator<int>> table(0, engine.bpm_, comparator, 4, 8);
+  const int n = 5000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  for (int key : keys) {
+    ASSERT_TRUE(table.Insert(key, key * 2));
+  }
+  ASSERT_TRUE(table.Check());
+  ASSERT_LT(1U, table.GetDirectoryCount());
+  // duplicate keys are rejected
+  for (int i = 0; i < n; i += 97) {
+    ASSERT_FALSE(table.Insert(i, 0));
+  }
+  std::vector<int> result;
+  for (int i = 0; i < n; i++) {
+    result.clear();
+    ASSERT_TRUE(table.GetValue(i, result));
+    ASSERT_EQ(1U, result.size());
+    ASSERT_EQ(i * 2, result[0]);
+  }
+  ASSERT_FALSE(table.GetValue(n, result));
+  // remove half of the keys, the emptied buckets are merged
+  ShuffleArray(keys);
+  for (int i = 0; i < n / 2; i++) {
+    ASSERT_TRUE(table.Remove(keys[i]));
+  }
+  ASSERT_FALSE(table.Remove(keys[0]));
+  ASSERT_TRUE(table.Check());
+  for (int i = 0; i < n; i++) {
+    result.clear();
+    ASSERT_EQ(i >= n / 2, table.GetValue(keys[i], result));
+  }
+  // the table can be emptied and filled again
+  for (int i = n / 2; i < n; i++) {
+    ASSERT_TRUE(table.Remove(keys[i]));
+  }
+  ASSERT_TRUE(table.Check());
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(table.Insert(keys[i], keys[i]));
+  }
+  ASSERT_TRUE(table.Check());
+  table.Destroy();
+}
+
+TEST(ExtendibleHashTests, ExtendibleHashIndexTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using HASH_INDEX = ExtendibleHashIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)
+  };
+  std::vector<uint32_t> index_key_map{0, 1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *index = ALLOC(heap, HASH_INDEX)(0, index_schema, engine.bpm_);
+  const int n = 20000;
+  char name[16];
+  auto make_key = [&](int i) {
+    snprintf(name, sizeof(name), "user%d", i % 7);
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, name, strlen(name), true)
+    };
+    return Row(fields);
+  };
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(make_key(i), RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(make_key(42), RowId(1, 1), nullptr));
+  std::vector<RowId> ret;
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(make_key(i), ret, nullptr));
+    ASSERT_EQ(1U, ret.size());
+    ASSERT_EQ(RowId(1000 + i / 100, i % 100).Get(), ret[0].Get());
+  }
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(make_key(n), ret, nullptr));
+  ASSERT_TRUE(ret.empty());
+  for (int i = 0; i < n; i += 2) {
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(make_key(i), RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  for (int i = 0; i < n; i++) {
+    ret.clear();
+    ASSERT_EQ(i % 2 == 0 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(make_key(i), ret, nullptr));
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  index->Destroy();
+}
+
+TEST(ExtendibleHashTests, ConcurrentTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  ExtendibleHashTable<int, int, BasicComparator<int>> table(0, engine.bpm_, comparator, 3, 16);
+  const int num_threads = 4;
+  const int keys_per_thread = 5000;
+  std::atomic<int> failed{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      std::vector<int> result;
+      for (int i = t; i < num_threads * keys_per_thread; i += num_threads) {
+        if (!table.Insert(i, i)) {
+          failed++;
+        }
+        // read the keys of the other threads while they are inserted
+        result.clear();
+        int other = i - t + (t + 1) % num_threads;
+        if (table.GetValue(other, result) && result[0] != other) {
+          failed++;
+        }
+      }
+      // remove every other key of this thread
+      for (int i = t; i < num_threads * keys_per_thread; i += 2 * num_threads) {
+        if (!table.Remove(i)) {
+          failed++;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0, failed.load());
+  ASSERT_TRUE(table.Check());
+  std::vector<int> result;
+  for (int i = 0; i < num_threads * keys_per_thread; i++) {
+    result.clear();
+    bool removed = (i / num_threads) % 2 == 0;
+    ASSERT_EQ(!removed, table.GetValue(i, result));
+  }
+  table.Destroy();
+}
+
+TEST(ExtendibleHashTests, PointLookupBenchmark) {
+  using INDEX_KEY_TYPE = GenericKey<8>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<8>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  using HASH_INDEX = ExtendibleHashIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  // both indexes stay in the buffer pool
+  DBStorageEngine engine(db_name, true, 4 * DEFAULT_BUFFER_POOL_SIZE);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  Index *tree = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  Index *hash = ALLOC(heap, HASH_INDEX)(1, index_schema, engine.bpm_);
+  const int n = 100000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i);
+  }
+  ShuffleArray(keys);
+  for (auto *index : {tree, hash}) {
+    for (int key : keys) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+      ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(key / 100, key % 100), nullptr));
+    }
+  }
+  ShuffleArray(keys);
+  for (auto *index : {tree, hash}) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<RowId> ret;
+    for (int key : keys) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+      ret.clear();
+      ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(fields), ret, nullptr));
+      ASSERT_EQ(RowId(key / 100, key % 100).Get(), ret[0].Get());
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%s: %.1f ns/lookup\n", index == tree ? "b+ tree" : "hash", elapsed.count() / n);
+  }
+  tree->Destroy();
+  hash->Destroy();
+}
@@ -0,0 +1,113 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "page/page.h"
+
+static const size_t NUM_WORDS = 16;
+
+/**
+ * Writers keep all words of the page equal, a reader that sees different words must fail validation.
+ */
+TEST(PageTests, OptimisticLatchTest) {
+  Page page;
+  const int num_writes = 20000;
+  std::atomic<bool> done{false};
+  std::atomic<size_t> torn{0};
+  std::atomic<size_t> validated{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < num_writes; i++) {
+        page.WLatch();
+        auto *words = reinterpret_cast<volatile uint64_t *>(page.GetData());
+        for (size_t w = 0; w < NUM_WORDS; w++) {
+          words[w] = words[w] + 1;
+        }
+        page.WUnlatch();
+      }
+    });
+  }
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&]() {
+      while (!done) {
+        uint64_t version = page.OptimisticRLatch();
+        auto *words = reinterpret_cast<volatile uint64_t *>(page.GetData());
+        uint64_t first = words[0];
+        bool equal = true;
+        for (size_t w = 1; w < NUM_WORDS; w++) {
+          equal &= words[w] == first;
+        }
+        if (page.ValidateRLatch(version)) {
+          validated++;
+          if (!equal) {
+            torn++;
+          }
+        }
+      }
+    });
+  }
+  for (int t = 0; t < 2; t++) {
+    threads[t].join();
+  }
+  done = true;
+  for (size_t t = 2; t < threads.size(); t++) {
+    threads[t].join();
+  }
+  ASSERT_EQ(0, torn.load());
+  ASSERT_LT(0, validated.load());
+  // Scenario: a version taken before a write no longer validates, one taken after it does.
+  uint64_t version = page.OptimisticRLatch();
+  ASSERT_TRUE(page.ValidateRLatch(version));
+  page.WLatch();
+  page.WUnlatch();
+  ASSERT_FALSE(page.ValidateRLatch(version));
+  ASSERT_TRUE(page.ValidateRLatch(page.OptimisticRLatch()));
+  // Scenario: read latches do not change the version.
+  version = page.OptimisticRLatch();
+  page.RLatch();
+  page.RUnlatch();
+  ASSERT_TRUE(page.ValidateRLatch(version));
+  ASSERT_EQ(2 * num_writes, static_cast<int>(reinterpret_cast<uint64_t *>(page.GetData())[0]));
+}
+
+TEST(PageTests, ReadLatchBenchmark) {
+  Page page;
+  const size_t reads_per_thread = 500000;
+  for (bool optimistic : {false, true}) {
+    for (size_t num_threads : {1, 2, 4, 8}) {
+      std::atomic<uint64_t> sum{0};
+      std::vector<std::thread> threads;
+      auto start = std::chrono::steady_clock::now();
+      for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&]() {
+          uint64_t local = 0;
+          for (size_t i = 0; i < reads_per_thread; i++) {
+            if (optimistic) {
+              uint64_t version;
+              do {
+                version = page.OptimisticRLatch();
+                local += page.GetData()[i % PAGE_SIZE];
+              } while (!page.ValidateRLatch(version));
+            } else {
+              page.RLatch();
+              local += page.GetData()[i % PAGE_SIZE];
+              page.RUnlatch();
+            }
+          }
+          sum += local;
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      ASSERT_EQ(0, sum.load());
+      printf("%s, threads: %zu, %.1f ns/read\n", optimistic ? "optimistic" : "read latch", num_threads,
+             elapsed.count() / (num_threads * reads_per_thread));
+    }
+  }
+}
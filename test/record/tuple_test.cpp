@@ -1,3 +1,5 @@
+#include <chrono>
+#include <cstdio>
 #include <cstring>
 
 #include "common/instance.h"
@@ -117,4 +119,125 @@ TEST(TupleTest, RowTest) {
   }
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
-}
\ No newline at end of file
+}
+TEST(TupleTest, RowViewTest) {
+  SimpleMemHeap heap;
+  TablePage table_page;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+          ALLOC_COLUMN(heap)("nick", TypeId::kTypeChar, 16, 2, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 3, true, false)
+  };
+  std::vector<Field> fields = {
+          Field(TypeId::kTypeInt, 188),
+          Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+          Field(TypeId::kTypeChar),
+          Field(TypeId::kTypeFloat, 19.99f)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Row row(fields);
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  RowView view;
+  ASSERT_TRUE(table_page.GetTupleView(row.GetRowId(), schema.get(), &view));
+  // Scenario: fields are read in place, also behind a null field.
+  ASSERT_EQ(row.GetRowId(), view.GetRowId());
+  ASSERT_EQ(4, view.GetFieldCount());
+  EXPECT_EQ(188, view.GetInt(0));
+  ASSERT_FALSE(view.IsNull(1));
+  EXPECT_EQ(strlen("minisql"), view.GetCharLength(1));
+  EXPECT_EQ(0, memcmp("minisql", view.GetChars(1), strlen("minisql")));
+  EXPECT_TRUE(view.IsNull(2));
+  EXPECT_FLOAT_EQ(19.99f, view.GetFloat(3));
+  EXPECT_EQ(row.GetSerializedSize(schema.get()), view.GetSerializedSize());
+  for (uint32_t i = 0; i < fields.size(); i++) {
+    Field field = view.GetField(i);
+    EXPECT_EQ(fields[i].IsNull(), field.IsNull());
+    if (!fields[i].IsNull()) {
+      EXPECT_EQ(CmpBool::kTrue, field.CompareEquals(fields[i]));
+    }
+  }
+  EXPECT_EQ("188", view.GetFieldString(0));
+  EXPECT_EQ("minisql", view.GetFieldString(1));
+  // Scenario: deleted tuples have no view.
+  ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
+  ASSERT_FALSE(table_page.GetTupleView(row.GetRowId(), schema.get(), &view));
+}
+
+TEST(TupleTest, ArenaMemHeapTest) {
+  ArenaMemHeap heap(64);
+  // Scenario: allocations are aligned, distinct and served from few chunks.
+  std::vector<char *> bufs;
+  for (size_t i = 0; i < 100; i++) {
+    auto *buf = static_cast<char *>(heap.Allocate(i % 13));
+    ASSERT_NE(nullptr, buf);
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(buf) % alignof(std::max_align_t));
+    memset(buf, static_cast<int>(i), i % 13);
+    bufs.push_back(buf);
+  }
+  for (size_t i = 0; i < bufs.size(); i++) {
+    for (size_t j = 0; j < i % 13; j++) {
+      ASSERT_EQ(static_cast<char>(i), bufs[i][j]);
+    }
+  }
+  size_t chunks = heap.GetNumAllocations();
+  ASSERT_LT(chunks, 10);
+  // Scenario: a request larger than any chunk gets one of its own.
+  memset(heap.Allocate(ArenaMemHeap::MAX_CHUNK_SIZE * 2), 0, ArenaMemHeap::MAX_CHUNK_SIZE * 2);
+  ASSERT_EQ(chunks + 1, heap.GetNumAllocations());
+  // Scenario: after a reset the kept chunk serves what fits without asking the system.
+  heap.Reset();
+  chunks = heap.GetNumAllocations();
+  for (size_t i = 0; i < 1000; i++) {
+    heap.Allocate(1000);
+  }
+  ASSERT_EQ(chunks, heap.GetNumAllocations());
+}
+
+TEST(TupleTest, RowAllocationBenchmark) {
+  const uint32_t row_nums = 50000;
+  SimpleMemHeap schema_heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(schema_heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(schema_heap)("name", TypeId::kTypeChar, 32, 1, true, false),
+          ALLOC_COLUMN(schema_heap)("account", TypeId::kTypeFloat, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Field> fields = {
+          Field(TypeId::kTypeInt, 1),
+          Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+          Field(TypeId::kTypeFloat, 2.5f)
+  };
+  Row row(fields);
+  TablePage table_page;
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  ASSERT_TRUE(table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+  RowId rid = row.GetRowId();
+  // before: every row brought its own SimpleMemHeap, one block per field besides the heap itself
+  auto start = std::chrono::steady_clock::now();
+  size_t allocations = 0;
+  for (uint32_t i = 0; i < row_nums; i++) {
+    auto *heap = new SimpleMemHeap;
+    Row scanned(rid, heap);
+    ASSERT_TRUE(table_page.GetTuple(&scanned, schema.get(), nullptr, nullptr));
+    allocations += heap->GetNumAllocations() + 1;
+    delete heap;
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  printf("simple heap: %.2f heap allocations/row, %.0f ns/row\n", static_cast<double>(allocations) / row_nums,
+         elapsed.count() / row_nums);
+  // after: rows live in an arena which is reset once per row, as the executor does per statement
+  ArenaMemHeap arena;
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < row_nums; i++) {
+    Row scanned(rid, &arena);
+    ASSERT_TRUE(table_page.GetTuple(&scanned, schema.get(), nullptr, nullptr));
+    ASSERT_EQ(0, memcmp("minisql", scanned.GetField(1)->GetData(), strlen("minisql")));
+    arena.Reset();
+  }
+  elapsed = std::chrono::steady_clock::now() - start;
+  printf("arena heap: %.4f heap allocations/row, %.0f ns/row\n",
+         static_cast<double>(arena.GetNumAllocations()) / row_nums, elapsed.count() / row_nums);
+  ASSERT_EQ(1, arena.GetNumAllocations());
+}
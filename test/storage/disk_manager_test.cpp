@@ -1,4 +1,9 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "storage/disk_manager.h"
@@ -31,6 +36,19 @@ TEST(DiskManagerTest, BitMapPageTest) {
     ASSERT_TRUE(bitmap->AllocatePage(ofs));
   }
   ASSERT_FALSE(bitmap->AllocatePage(ofs));
+  ASSERT_EQ(num_pages, bitmap->CountAllocatedPages());
+  // Scenario: freed pages are handed out again lowest first.
+  ASSERT_TRUE(bitmap->DeAllocatePage(300));
+  ASSERT_TRUE(bitmap->DeAllocatePage(70));
+  ASSERT_TRUE(bitmap->DeAllocatePage(num_pages - 1));
+  ASSERT_EQ(num_pages - 3, bitmap->CountAllocatedPages());
+  ASSERT_TRUE(bitmap->AllocatePage(ofs));
+  ASSERT_EQ(70, ofs);
+  ASSERT_TRUE(bitmap->AllocatePage(ofs));
+  ASSERT_EQ(300, ofs);
+  ASSERT_TRUE(bitmap->AllocatePage(ofs));
+  ASSERT_EQ(num_pages - 1, ofs);
+  ASSERT_FALSE(bitmap->AllocatePage(ofs));
 }
 
 TEST(DiskManagerTest, FreePageAllocationTest) {
@@ -55,4 +73,85 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
-}
\ No newline at end of file
+}
+TEST(DiskManagerTest, AllocationBenchmark) {
+  std::string db_name = "disk_alloc_test.db";
+  remove(db_name.c_str());
+  const uint32_t extent_nums = 8;
+  {
+    DiskManager disk_mgr(db_name);
+    for (uint32_t extent = 0; extent < extent_nums; extent++) {
+      auto start = std::chrono::steady_clock::now();
+      for (uint32_t i = 0; i < DiskManager::BITMAP_SIZE; i++) {
+        ASSERT_EQ(extent * DiskManager::BITMAP_SIZE + i, disk_mgr.AllocatePage());
+      }
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      printf("extent: %u, allocation: %.1f ns/page\n", extent, elapsed.count() / DiskManager::BITMAP_SIZE);
+    }
+    // free a page of the first and of the last extent, the first one is reused first
+    disk_mgr.DeAllocatePage((extent_nums - 1) * DiskManager::BITMAP_SIZE + 5);
+    disk_mgr.DeAllocatePage(DiskManager::BITMAP_SIZE / 2);
+  }
+  // Scenario: the free extent summary is rebuilt after a restart.
+  DiskManager disk_mgr(db_name);
+  EXPECT_EQ(DiskManager::BITMAP_SIZE / 2, disk_mgr.AllocatePage());
+  EXPECT_EQ((extent_nums - 1) * DiskManager::BITMAP_SIZE + 5, disk_mgr.AllocatePage());
+  EXPECT_EQ(extent_nums * DiskManager::BITMAP_SIZE, disk_mgr.AllocatePage());
+  disk_mgr.Close();
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, PersistenceTest) {
+  std::string db_name = "disk_persist_test.db";
+  remove(db_name.c_str());
+  const int page_nums = 100;
+  char buf[PAGE_SIZE];
+  {
+    DiskManager disk_mgr(db_name);
+    for (int i = 0; i < page_nums; i++) {
+      page_id_t page_id = disk_mgr.AllocatePage();
+      ASSERT_EQ(i, page_id);
+      memset(buf, i, PAGE_SIZE);
+      disk_mgr.WritePage(page_id, buf);
+    }
+    disk_mgr.DeAllocatePage(7);
+    disk_mgr.Sync();
+  }
+  // Scenario: pages and allocation state survive a restart.
+  DiskManager disk_mgr(db_name);
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr.GetMetaData());
+  EXPECT_EQ(page_nums - 1, meta_page->GetAllocatedPages());
+  EXPECT_EQ(1, meta_page->GetExtentNums());
+  EXPECT_TRUE(disk_mgr.IsPageFree(7));
+  EXPECT_EQ(7, disk_mgr.AllocatePage());
+  EXPECT_EQ(page_nums, disk_mgr.AllocatePage());
+  // Scenario: concurrent readers of different pages see their own page.
+  std::vector<std::thread> threads;
+  std::atomic<int> errors{0};
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      char page[PAGE_SIZE];
+      for (int i = t; i < page_nums; i += 4) {
+        if (i == 7) continue;
+        disk_mgr.ReadPage(i, page);
+        for (int j = 0; j < PAGE_SIZE; j++) {
+          if (page[j] != static_cast<char>(i)) {
+            errors++;
+            break;
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, errors.load());
+  // Scenario: reading a page which was never written returns zeros.
+  disk_mgr.ReadPage(page_nums + 10, buf);
+  for (int j = 0; j < PAGE_SIZE; j++) {
+    ASSERT_EQ(0, buf[j]);
+  }
+  disk_mgr.Close();
+  remove(db_name.c_str());
+}
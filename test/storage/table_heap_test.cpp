@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 
@@ -50,7 +54,7 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   ASSERT_EQ(row_nums, row_values.size());
   for (auto row_kv : row_values) {
     Row row(RowId(row_kv.first));
-    table_heap->GetTuple(&row, nullptr);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
     ASSERT_EQ(schema.get()->GetColumnCount(), row.GetFields().size());
     for (size_t j = 0; j < schema.get()->GetColumnCount(); j++) {
       ASSERT_EQ(CmpBool::kTrue, row.GetField(j)->CompareEquals(row_kv.second->at(j)));
@@ -58,5 +62,345 @@ TEST(TableHeapTest, TableHeapSampleTest) {
     // free spaces
     delete row_kv.second;
   }
+  // Scenario: reading tuples leaves no page pinned, so the heap can be freed afterwards.
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  table_heap->FreeHeap();
+  ASSERT_TRUE(engine.bpm_->IsPageFree(first_page_id));
 }
 
+
+TEST(TableHeapTest, TableHeapScanRingTest) {
+  const size_t buffer_pool_size = 64;
+  const int hot_pages = 16;
+  const int row_nums = 3000;
+  for (bool use_scan_ring : {false, true}) {
+    DBStorageEngine engine(db_file_name, true, buffer_pool_size, 1);
+    // read-ahead takes frames on its own, keep it out of the picture
+    engine.bpm_->SetPrefetchDepth(0);
+    SimpleMemHeap heap;
+    std::vector<Column *> columns = {
+            ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+            ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 200, 1, false, false)
+    };
+    auto schema = std::make_shared<Schema>(columns);
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+    char characters[200];
+    memset(characters, 'a', sizeof(characters));
+    for (int i = 0; i < row_nums; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+    // pages which are used repeatedly by other sessions, e.g. index pages
+    std::vector<page_id_t> hot_page_ids;
+    for (int i = 0; i < hot_pages; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, engine.bpm_->NewPage(page_id));
+      engine.bpm_->UnpinPage(page_id, true);
+      hot_page_ids.push_back(page_id);
+    }
+    // full table scan, which is far bigger than the buffer pool
+    int count = 0;
+    for (auto it = table_heap->Begin(nullptr, use_scan_ring); it != table_heap->End(); ++it) {
+      ASSERT_EQ(CmpBool::kTrue, it->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+      count++;
+    }
+    ASSERT_EQ(row_nums, count);
+    // with the scan ring the hot pages must still be resident
+    size_t reads_before = engine.disk_mgr_->GetNumReads();
+    for (auto page_id : hot_page_ids) {
+      ASSERT_NE(nullptr, engine.bpm_->FetchPage(page_id));
+      engine.bpm_->UnpinPage(page_id, false);
+    }
+    size_t reads = engine.disk_mgr_->GetNumReads() - reads_before;
+    if (use_scan_ring) {
+      ASSERT_EQ(0, reads);
+    } else {
+      ASSERT_EQ(hot_pages, reads);
+    }
+  }
+}
+
+TEST(TableHeapTest, TableHeapReadAheadTest) {
+  const size_t buffer_pool_size = 64;
+  const int row_nums = 3000;
+  for (size_t prefetch_depth : {0, 8}) {
+    DBStorageEngine engine(db_file_name, true, buffer_pool_size, 1);
+    engine.bpm_->SetPrefetchDepth(prefetch_depth);
+    SimpleMemHeap heap;
+    std::vector<Column *> columns = {
+            ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+            ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 200, 1, false, false)
+    };
+    auto schema = std::make_shared<Schema>(columns);
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+    char characters[200];
+    memset(characters, 'b', sizeof(characters));
+    for (int i = 0; i < row_nums; i++) {
+      Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+    // the table is far bigger than the pool, so the beginning of it is cold
+    int count = 0;
+    for (auto it = table_heap->Begin(nullptr, true); it != table_heap->End(); ++it) {
+      ASSERT_EQ(CmpBool::kTrue, it->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+      count++;
+      // a scan of cached pages may finish before the read-ahead thread gets to run, let it catch up
+      engine.bpm_->WaitForPrefetches();
+    }
+    ASSERT_EQ(row_nums, count);
+    if (prefetch_depth == 0) {
+      EXPECT_EQ(0, engine.bpm_->GetNumPrefetchedPages());
+    } else {
+      EXPECT_GT(engine.bpm_->GetNumPrefetchedPages(), 0);
+      EXPECT_GE(engine.bpm_->GetNumPrefetchedPages(),
+                engine.bpm_->GetNumPrefetchHits() + engine.bpm_->GetNumWastedPrefetches());
+    }
+    printf("prefetch depth: %zu, prefetched: %zu, hits: %zu, wasted: %zu\n", prefetch_depth,
+           engine.bpm_->GetNumPrefetchedPages(), engine.bpm_->GetNumPrefetchHits(),
+           engine.bpm_->GetNumWastedPrefetches());
+  }
+}
+
+TEST(TableHeapTest, TableHeapFreeSpaceMapTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 2000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 100, 1, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  char characters[100];
+  memset(characters, 'c', sizeof(characters));
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // Scenario: space freed in an early page is reused instead of growing the tail.
+  page_id_t victim_page = rids[10].GetPageId();
+  ASSERT_NE(victim_page, rids.back().GetPageId());
+  ASSERT_EQ(victim_page, rids[11].GetPageId());
+  for (int i : {10, 11}) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+  }
+  // the tail is filled up first, the row which does not fit any more goes to the freed space
+  int extra_rows = 0;
+  while (true) {
+    Fields fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    extra_rows++;
+    if (row.GetRowId().GetPageId() != rids.back().GetPageId()) {
+      ASSERT_EQ(victim_page, row.GetRowId().GetPageId());
+      break;
+    }
+  }
+  // Scenario: a heap opened with its map, or with the map rebuilt from the chain, keeps inserting into the same chain.
+  for (page_id_t fsm_page_id : {table_heap->GetFreeSpaceMapPageId(), INVALID_PAGE_ID}) {
+    TableHeap *reopened = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), schema.get(), nullptr,
+                                            nullptr, &heap, fsm_page_id);
+    Fields fields{Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+    Row row(fields);
+    ASSERT_TRUE(reopened->InsertTuple(row, nullptr));
+    Row inserted(row.GetRowId());
+    ASSERT_TRUE(table_heap->GetTuple(&inserted, nullptr));
+    ASSERT_EQ(CmpBool::kTrue, inserted.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, row_nums)));
+  }
+  int count = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+    count++;
+  }
+  ASSERT_EQ(row_nums - 2 + extra_rows + 2, count);
+}
+
+TEST(TableHeapTest, TableHeapInsertBenchmark) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 1000000;
+  const int batch = 100000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 1, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  for (int i = 0; i < row_nums; i += batch) {
+    auto start = std::chrono::steady_clock::now();
+    for (int j = i; j < i + batch; j++) {
+      Fields fields{Field(TypeId::kTypeInt, j), Field(TypeId::kTypeFloat, 1.5f)};
+      Row row(fields);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("rows: %d, insert: %.0f ns/row\n", i + batch, elapsed.count() / batch);
+  }
+}
+
+TEST(TableHeapTest, TableHeapBatchInsertTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 200000;
+  const int batch = 1000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 32, 1, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[32];
+  memset(characters, 'd', sizeof(characters));
+  for (bool batched : {false, true}) {
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+    std::vector<RowId> rids;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < row_nums; i += batch) {
+      std::vector<Row> rows;
+      rows.reserve(batch);
+      for (int j = i; j < i + batch; j++) {
+        Fields fields{Field(TypeId::kTypeInt, j), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+        rows.emplace_back(fields);
+      }
+      if (batched) {
+        ASSERT_TRUE(table_heap->InsertTuples(rows, nullptr));
+      } else {
+        for (auto &row : rows) {
+          ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+        }
+      }
+      for (auto &row : rows) {
+        rids.push_back(row.GetRowId());
+      }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%s insert: %.0f ns/row\n", batched ? "batched" : "single-row", elapsed.count() / row_nums);
+    // every row id points at its own row, and the scan sees the rows in insertion order
+    for (int i = 0; i < row_nums; i += 997) {
+      Row row(rids[i]);
+      ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    }
+    int count = 0;
+    for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+      ASSERT_EQ(CmpBool::kTrue, it->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+      count++;
+    }
+    ASSERT_EQ(row_nums, count);
+  }
+}
+
+TEST(TableHeapTest, TableHeapRowViewScanBenchmark) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 100000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 32, 1, false, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  char characters[32];
+  memset(characters, 'e', sizeof(characters));
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false),
+                  Field(TypeId::kTypeFloat, 2.5f)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  // a predicate on one column, evaluated on deserialized rows and on views
+  for (bool use_view : {false, true}) {
+    int64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto it = table_heap->Begin(nullptr, true); it != table_heap->End(); ++it) {
+      if (use_view) {
+        sum += it.View().GetInt(0);
+      } else {
+        sum += atoi(it->GetField(0)->GetData());
+      }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(static_cast<int64_t>(row_nums) * (row_nums - 1) / 2, sum);
+    printf("%s scan: %.0f ns/row\n", use_view ? "row view" : "deserialized row", elapsed.count() / row_nums);
+  }
+  // Scenario: a tuple deleted under the iterator has no valid view, and the scan goes on past it.
+  int count = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+    ASSERT_TRUE(it.View().IsValid());
+    if (it.View().GetInt(0) % 2 == 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(it.GetRowId(), nullptr));
+      ASSERT_FALSE(it.View().IsValid());
+    }
+    count++;
+  }
+  ASSERT_EQ(row_nums, count);
+}
+
+TEST(TableHeapTest, TableHeapPartitionedScanTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 20000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 32, 1, false, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  char characters[32];
+  memset(characters, 'e', sizeof(characters));
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, sizeof(characters), false)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  for (int i = 0; i < row_nums; i += 3) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+  }
+  // the map lists the heap pages in chain order
+  std::vector<page_id_t> page_ids = table_heap->GetPageIds();
+  std::vector<page_id_t> chain;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+    if (chain.empty() || chain.back() != it.GetRowId().GetPageId()) {
+      chain.push_back(it.GetRowId().GetPageId());
+    }
+  }
+  ASSERT_LT(1, chain.size());
+  ASSERT_EQ(chain, page_ids);
+  // Scenario: threads scanning disjoint ranges of pages see every live row exactly once.
+  const size_t num_threads = 4;
+  std::vector<std::vector<int>> seen(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t]() {
+      table_heap->ScanPages(page_ids, page_ids.size() * t / num_threads, page_ids.size() * (t + 1) / num_threads,
+                            [&](const RowView &view) {
+                              ASSERT_EQ(view.GetRowId().Get(), rids[view.GetInt(0)].Get());
+                              seen[t].push_back(view.GetInt(0));
+                            });
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<int> all;
+  for (auto &ids : seen) {
+    all.insert(all.end(), ids.begin(), ids.end());
+  }
+  std::sort(all.begin(), all.end());
+  std::vector<int> expected;
+  for (int i = 0; i < row_nums; i++) {
+    if (i % 3 != 0) {
+      expected.push_back(i);
+    }
+  }
+  ASSERT_EQ(expected, all);
+}